@@ -0,0 +1,224 @@
+/*******************************************************************************
+* Game Development Project
+* ClearanceField.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Distance to the nearest wall of every world cell
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "ClearanceField.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+// rows computed together by a full build (the column pass also scans the
+// maximum distance above and below each band)
+static const int kBuildBandRows = 8 * kWorldChunkSize;
+
+/**
+* Constructor
+*/
+ClearanceField::ClearanceField(const WorldFile& worldFile, int iMaxDistance) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_iChunksX((worldFile.GetWidth() + kWorldChunkSize - 1) / kWorldChunkSize),
+    m_uWorldVersion(worldFile.GetVersion()),
+    m_iMaxDistance(iMaxDistance)
+{
+    assert(iMaxDistance > 0 && iMaxDistance <= 255 && "clearance squared must fit 16 bits");
+
+    m_vDistanceSq.assign(m_iWidth * m_iHeight, 0);
+    m_vDistance.resize(iMaxDistance * iMaxDistance + 1);
+    for(int i = 0; i <= iMaxDistance * iMaxDistance; ++i)
+        m_vDistance[i] = sqrtf((float)i);
+}
+
+/**
+* Computes the whole field (in bands of rows)
+*/
+void ClearanceField::Build()
+{
+    for(int row = 0; row < m_iHeight; row += kBuildBandRows)
+        ComputeRect(row, min(row + kBuildBandRows, m_iHeight) - 1, 0, m_iWidth - 1);
+
+    m_uWorldVersion = m_worldFile.GetVersion();
+}
+
+/**
+* Recomputes the chunks within the maximum distance of cells changed since
+* the last build or update (the whole field if the changes are no longer
+* known). Returns true if any chunk was recomputed.
+*/
+bool ClearanceField::Update()
+{
+    m_vUpdatedChunks.clear();
+    if( m_uWorldVersion == m_worldFile.GetVersion() )
+        return false;
+
+    std::vector<WorldFile::CellChange> changes;
+    if( !m_worldFile.GetCellChanges(m_uWorldVersion, &changes) )
+    {
+        Build();
+        int iChunks = m_iChunksX * ((m_iHeight + kWorldChunkSize - 1) / kWorldChunkSize);
+        for(int chunk = 0; chunk < iChunks; ++chunk)
+            m_vUpdatedChunks.push_back(chunk);
+        return true;
+    }
+
+    // chunks within the maximum distance of a changed cell
+    for(std::vector<WorldFile::CellChange>::iterator change = changes.begin(); change != changes.end(); ++change)
+    {
+        int iRowMin = max(change->row - m_iMaxDistance, 0) / kWorldChunkSize;
+        int iRowMax = min(change->row + m_iMaxDistance, m_iHeight - 1) / kWorldChunkSize;
+        int iColMin = max(change->col - m_iMaxDistance, 0) / kWorldChunkSize;
+        int iColMax = min(change->col + m_iMaxDistance, m_iWidth - 1) / kWorldChunkSize;
+
+        for(int row = iRowMin; row <= iRowMax; ++row)
+        {
+            for(int col = iColMin; col <= iColMax; ++col)
+                m_vUpdatedChunks.push_back(row * m_iChunksX + col);
+        }
+    }
+
+    std::sort(m_vUpdatedChunks.begin(), m_vUpdatedChunks.end());
+    m_vUpdatedChunks.erase( std::unique(m_vUpdatedChunks.begin(), m_vUpdatedChunks.end()), m_vUpdatedChunks.end() );
+
+    for(std::vector<int>::iterator chunk = m_vUpdatedChunks.begin(); chunk != m_vUpdatedChunks.end(); ++chunk)
+    {
+        int iRowMin = (*chunk / m_iChunksX) * kWorldChunkSize;
+        int iColMin = (*chunk % m_iChunksX) * kWorldChunkSize;
+        ComputeRect(iRowMin, min(iRowMin + kWorldChunkSize, m_iHeight) - 1, iColMin, min(iColMin + kWorldChunkSize, m_iWidth) - 1);
+    }
+
+    m_uWorldVersion = m_worldFile.GetVersion();
+    return true;
+}
+
+/**
+* Returns true for occupied cells and cells outside the world
+*/
+bool ClearanceField::IsWall(int iRow, int iCol) const
+{
+    return iRow < 0 || iRow >= m_iHeight || iCol < 0 || iCol >= m_iWidth || m_worldFile(iRow, iCol) == WorldFile::OCCUPIED_CELL;
+}
+
+/**
+* Computes the field of a cell rectangle (inclusive) from the walls within
+* the maximum distance of it.
+*
+* 1. Column pass: vertical distance to the nearest wall of every window
+*    column (rectangle columns plus the maximum distance on each side),
+*    scanning the rows down then up. Distances past the maximum are capped; any
+*    result using a capped column is beyond the maximum anyway.
+* 2. Row pass: the squared distance of a cell is the lowest of
+*    (column offset)^2 + (vertical distance)^2 over the window columns,
+*    found by building the lower envelope of these parabolas.
+*/
+void ClearanceField::ComputeRect(int iRowMin, int iRowMax, int iColMin, int iColMax)
+{
+    const int kCap = m_iMaxDistance + 1;
+    const int kMaxDistanceSq = m_iMaxDistance * m_iMaxDistance;
+
+    // window columns (the columns just outside the world are walls)
+    int iWindowMin = max(iColMin - m_iMaxDistance, -1);
+    int iWindowMax = min(iColMax + m_iMaxDistance, m_iWidth);
+    int iWindowCols = iWindowMax - iWindowMin + 1;
+    int iRows = iRowMax - iRowMin + 1;
+
+    // column pass
+    m_vColumnDistance.resize(iRows * iWindowCols);
+    int iScanMin = max(iRowMin - m_iMaxDistance, -1);
+    int iScanMax = min(iRowMax + m_iMaxDistance, m_iHeight);
+
+    // walls of the scanned rows
+    m_vWalls.resize((iScanMax - iScanMin + 1) * iWindowCols);
+    for(int row = iScanMin; row <= iScanMax; ++row)
+    {
+        unsigned char* pWalls = &m_vWalls[(row - iScanMin) * iWindowCols];
+        for(int q = 0; q < iWindowCols; ++q)
+            pWalls[q] = IsWall(row, iWindowMin + q);
+    }
+
+    // scan down (nearest wall above), a row at a time
+    m_vScan.assign(iWindowCols, kCap);
+    int* pScan = &m_vScan[0];
+    for(int row = iScanMin; row <= iScanMax; ++row)
+    {
+        const unsigned char* pWalls = &m_vWalls[(row - iScanMin) * iWindowCols];
+        int* pRow = row >= iRowMin && row <= iRowMax ? &m_vColumnDistance[(row - iRowMin) * iWindowCols] : NULL;
+        for(int q = 0; q < iWindowCols; ++q)
+        {
+            pScan[q] = pWalls[q] ? 0 : min(pScan[q] + 1, kCap);
+            if(pRow)
+                pRow[q] = pScan[q];
+        }
+    }
+
+    // scan up (nearest wall below)
+    m_vScan.assign(iWindowCols, kCap);
+    for(int row = iScanMax; row >= iScanMin; --row)
+    {
+        const unsigned char* pWalls = &m_vWalls[(row - iScanMin) * iWindowCols];
+        int* pRow = row >= iRowMin && row <= iRowMax ? &m_vColumnDistance[(row - iRowMin) * iWindowCols] : NULL;
+        for(int q = 0; q < iWindowCols; ++q)
+        {
+            pScan[q] = pWalls[q] ? 0 : min(pScan[q] + 1, kCap);
+            if(pRow)
+                pRow[q] = min(pRow[q], pScan[q]);
+        }
+    }
+
+    // row pass
+    m_vEnvelope.resize(iWindowCols);
+    m_vEnvelopeStart.resize(iWindowCols + 1);
+
+    for(int row = iRowMin; row <= iRowMax; ++row)
+    {
+        const int* pColumn = &m_vColumnDistance[(row - iRowMin) * iWindowCols];
+
+        // lower envelope of the parabolas (q - x)^2 + f(q), for window column q
+        int k = 0;
+        m_vEnvelope[0] = 0;
+        m_vEnvelopeStart[0] = -DBL_MAX;
+        m_vEnvelopeStart[1] = DBL_MAX;
+
+        for(int q = 1; q < iWindowCols; ++q)
+        {
+            // drop the parabolas q is below from their start on
+            double fq = (double)pColumn[q] * pColumn[q] + (double)q * q;
+            double s;
+            for(;;)
+            {
+                int v = m_vEnvelope[k];
+                s = (fq - ((double)pColumn[v] * pColumn[v] + (double)v * v)) / (2.0 * (q - v));
+                if( s > m_vEnvelopeStart[k] )
+                    break;
+                --k;
+            }
+
+            ++k;
+            m_vEnvelope[k] = q;
+            m_vEnvelopeStart[k] = s;
+            m_vEnvelopeStart[k+1] = DBL_MAX;
+        }
+
+        // squared distances of the rectangle cells
+        unsigned short* pDistanceSq = &m_vDistanceSq[row * m_iWidth];
+        k = 0;
+        for(int col = iColMin; col <= iColMax; ++col)
+        {
+            int q = col - iWindowMin;
+            while( m_vEnvelopeStart[k+1] < q )
+                ++k;
+
+            int v = m_vEnvelope[k];
+            int iDistanceSq = (q - v) * (q - v) + pColumn[v] * pColumn[v];
+            pDistanceSq[col] = (unsigned short)min(iDistanceSq, kMaxDistanceSq);
+        }
+    }
+}
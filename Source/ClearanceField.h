@@ -0,0 +1,80 @@
+/*******************************************************************************
+* Game Development Project
+* ClearanceField.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Distance to the nearest wall of every world cell
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "WorldFile.h"
+#include "WorldChunks.h"
+
+/**
+* Exact Euclidean distance transform of the world grid: the distance from
+* every cell center to the nearest occupied cell center (0 on occupied
+* cells), clamped to a maximum distance. Cells outside the world count as
+* occupied. Distances are stored squared (exact integers), so a lookup is
+* one table read.
+*
+* The transform runs in two linear passes: a column pass finds the vertical
+* distance to the nearest wall, and a row pass takes the lower envelope of
+* the parabolas it defines. Only walls within the maximum distance matter,
+* so the field is computed in kWorldChunkSize tiles (one per world chunk)
+* and the tiles within the maximum distance of changed cells are recomputed
+* on update.
+*/
+class ClearanceField
+{
+    public:
+
+        // constructor (iMaxDistance: largest distance kept, at most 255 cells)
+        ClearanceField(const WorldFile& worldFile, int iMaxDistance);
+
+        // field
+        void Build();
+        bool Update();
+        const std::vector<int>& GetUpdatedChunks() const { return m_vUpdatedChunks; }
+
+        // distance in cells to the nearest wall (0 outside the world)
+        float GetClearance(int iRow, int iCol) const
+        {
+            if( iRow < 0 || iRow >= m_iHeight || iCol < 0 || iCol >= m_iWidth )
+                return 0.0f;
+            return m_vDistance[ m_vDistanceSq[iRow * m_iWidth + iCol] ];
+        }
+        int GetMaxDistance() const { return m_iMaxDistance; }
+
+    private:
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+        int m_iChunksX;                         // world chunks per row
+        unsigned int m_uWorldVersion;           // world version of the field
+
+        // field
+        int m_iMaxDistance;
+        std::vector<unsigned short> m_vDistanceSq;  // squared distance per cell (clamped)
+        std::vector<float> m_vDistance;             // distance by squared distance
+        std::vector<int> m_vUpdatedChunks;          // chunks recomputed by the last update
+
+        // transform scratch
+        std::vector<int> m_vColumnDistance;     // vertical wall distance per row and window column
+        std::vector<unsigned char> m_vWalls;    // walls per scanned row and window column
+        std::vector<int> m_vScan;               // running vertical wall distance per window column
+        std::vector<int> m_vEnvelope;           // lower envelope parabola columns
+        std::vector<double> m_vEnvelopeStart;   // first column of each envelope parabola
+
+        bool IsWall(int iRow, int iCol) const;
+        void ComputeRect(int iRowMin, int iRowMax, int iColMin, int iColMax);
+
+        // prevent copy and assignment
+        ClearanceField(const ClearanceField&);
+        ClearanceField& operator=(const ClearanceField&);
+};
@@ -275,11 +275,14 @@ CollSphere* AppendMobyCollSphere(CollSphere& sphere)
 /* Game Object Collision                                                */
 /************************************************************************/
 
+// distance added around collision bounds when gathering quads
+static const float kCollQuadMargin = 0.01f;
+
 /**
 * Constructor
 */
-ObjectCollision::ObjectCollision(const VecCollQuad& quads) :
-    m_vQuadList(quads)
+ObjectCollision::ObjectCollision(const CollQuadSource& quadSource) :
+    m_quadSource(quadSource)
 {}
  
 /**
@@ -296,17 +299,26 @@ void ObjectCollision::RunWorldCollision(GameObject* obj)
     CollSphere sphere;
     sphere.Set(&vObjPos, 0.25f);
 
-    // run sphere vs quad checks on entire list
-    for(size_t i = 0; i < m_vQuadList.size(); i++)
+    // gather quads near the sphere
+    float fReach = sphere.radius + kCollQuadMargin;
+    m_vQuadLists.clear();
+    m_quadSource.GetQuadLists(vObjPos.x - fReach, vObjPos.z - fReach, vObjPos.x + fReach, vObjPos.z + fReach, &m_vQuadLists);
+
+    // run sphere vs quad checks on nearby lists
+    for(size_t list = 0; list < m_vQuadLists.size(); list++)
     {
-        // check for collision
-        if(sphere.VsQuad(m_vQuadList[i]))
+        const VecCollQuad& quads = *m_vQuadLists[list];
+        for(size_t i = 0; i < quads.size(); i++)
         {
-            // if collision, send player collision event
-            obj->SetPosition( obj->GetPosition() + gCollOutput.push );
-            gCollOutput.Reset();
+            // check for collision
+            if(sphere.VsQuad(quads[i]))
+            {
+                // if collision, send player collision event
+                obj->SetPosition( obj->GetPosition() + gCollOutput.push );
+                gCollOutput.Reset();
+            }
         }
-    }  
+    }
 }
 
 /**
@@ -350,26 +362,37 @@ bool ObjectCollision::RunLineCollision(const D3DXVECTOR3& p1, const D3DXVECTOR3&
     bool coll = false;
     (*output).length = 0.0f;
 
-    // run sphere vs quad checks on entire list
-    for(size_t i = 0; i < m_vQuadList.size(); i++)
-    {
-        // generate collision line
-        CollLine line;
-        line.Set(&p1, &p2);
+    // generate collision line
+    CollLine line;
+    line.Set(&p1, &p2);
+
+    // gather quads near the line
+    m_vQuadLists.clear();
+    m_quadSource.GetQuadLists(
+        min(p1.x, p2.x) - kCollQuadMargin, min(p1.z, p2.z) - kCollQuadMargin,
+        max(p1.x, p2.x) + kCollQuadMargin, max(p1.z, p2.z) + kCollQuadMargin,
+        &m_vQuadLists);
 
-        // check for collision
-        if(line.VsQuad(m_vQuadList[i]))
+    // run line vs quad checks on nearby lists
+    for(size_t list = 0; list < m_vQuadLists.size(); list++)
+    {
+        const VecCollQuad& quads = *m_vQuadLists[list];
+        for(size_t i = 0; i < quads.size(); i++)
         {
-            // update collision data if closer to line start
-            if(gCollOutput.length > (*output).length)
+            // check for collision
+            if(line.VsQuad(quads[i]))
             {
-                // if collision, modify line end point
-                *output = gCollOutput;
-                coll = true;
+                // update collision data if closer to line start
+                if(gCollOutput.length > (*output).length)
+                {
+                    // if collision, modify line end point
+                    *output = gCollOutput;
+                    coll = true;
+                }
+
+                // reset collision data
+                gCollOutput.Reset();
             }
-
-            // reset collision data
-            gCollOutput.Reset();
         }
     }
 
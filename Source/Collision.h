@@ -161,16 +161,28 @@ class CollQuad
 */
 typedef std::vector<CollQuad> VecCollQuad;
 
+/**
+* Source of environment quads. Returns the quad lists that may hold quads
+* within an x-z rectangle (e.g. the lists of the world chunks it overlaps).
+*/
+class CollQuadSource
+{
+    public:
+        virtual ~CollQuadSource() {}
+        virtual void GetQuadLists(float fMinX, float fMinZ, float fMaxX, float fMaxZ, std::vector<const VecCollQuad*>* quadLists) const = 0;
+};
+
 /**
 * Checks for collisions between a list of quads (environment) and objects.
-* When collisions are detected, the object is notified to move.
+* When collisions are detected, the object is notified to move. Only the
+* quads near the object or line are checked.
 */
 class ObjectCollision : public Singleton<ObjectCollision>
 {
     public:
 
         // constructor
-        ObjectCollision(const VecCollQuad& quads);
+        ObjectCollision(const CollQuadSource& quadSource);
 
         // run collision check between object and environment
         void RunWorldCollision(GameObject* obj);
@@ -183,7 +195,8 @@ class ObjectCollision : public Singleton<ObjectCollision>
 
     private:
 
-        VecCollQuad m_vQuadList;
+        const CollQuadSource& m_quadSource;
+        std::vector<const VecCollQuad*> m_vQuadLists;   // quad lists of the current check
 };
 
 /************************************************************************/
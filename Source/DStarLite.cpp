@@ -0,0 +1,562 @@
+/*******************************************************************************
+* Game Development Project
+* DStarLite.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Incremental (D* Lite) path planner for a moving agent and goal
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "DStarLite.h"
+#include <float.h>
+#include <stdlib.h>
+
+// movement costs between neighboring cell centers
+static const float kCardinalCost = 1.0f;
+static const float kDiagonalCost = 1.41421356f;
+
+// distance of cells that cannot reach the goal
+static const float kInfiniteCost = FLT_MAX;
+
+// queue keys closer than this are equal (accumulated rounding)
+static const float kKeyTolerance = 0.001f;
+
+// initial cell data table size (power of 2)
+static const int kInitialTableSize = 1024;
+
+/**
+* Constructor
+*/
+DStarLite::DStarLite(const WorldFile& worldFile) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_uWorldVersion(worldFile.GetVersion()),
+    m_iTableCount(0),
+    m_uGeneration(1),
+    m_iStart(-1),
+    m_iGoal(-1),
+    m_iLast(-1),
+    m_fKeyModifier(0.0f),
+    m_iExpanded(0),
+    m_bComplete(false)
+{
+    CellData data;
+    data.iCell = -1;
+    data.uGeneration = 0;
+    m_vTable.assign(kInitialTableSize, data);
+}
+
+/**
+* Deconstructor
+*/
+DStarLite::~DStarLite()
+{}
+
+/**
+* Moves the agent and goal, applies world changes and repairs the search,
+* expanding at most the given number of cells. The first update (or an update
+* after unknown world changes) plans from scratch.
+*/
+void DStarLite::Update(const PathNodeKey& nkStart, const PathNodeKey& nkGoal, int iMaxExpansions)
+{
+    m_iExpanded = 0;
+
+    // cells outside the grid cannot be planned
+    if( nkStart.iRow < 0 || nkStart.iRow >= m_iHeight || nkStart.iCol < 0 || nkStart.iCol >= m_iWidth ||
+        nkGoal.iRow < 0 || nkGoal.iRow >= m_iHeight || nkGoal.iCol < 0 || nkGoal.iCol >= m_iWidth )
+    {
+        m_iStart = -1;
+        m_bComplete = false;
+        return;
+    }
+
+    int iStart = GetIndex(nkStart.iRow, nkStart.iCol);
+    int iGoal = GetIndex(nkGoal.iRow, nkGoal.iCol);
+
+    // world changes since the last update
+    std::vector<WorldFile::CellChange> changes;
+    bool bChangesKnown = m_worldFile.GetCellChanges(m_uWorldVersion, &changes);
+    m_uWorldVersion = m_worldFile.GetVersion();
+
+    // plan from scratch
+    if( m_iStart == -1 || !bChangesKnown )
+    {
+        Reset(iStart, iGoal);
+    }
+
+    else
+    {
+        // agent moved: keep old keys valid as lower bounds
+        m_iStart = iStart;
+        if( m_iStart != m_iLast )
+        {
+            m_fKeyModifier += ComputeHeuristicCost(m_iLast, m_iStart);
+            m_iLast = m_iStart;
+        }
+
+        // goal moved: the virtual goal edge moves from the old to the new cell
+        if( iGoal != m_iGoal )
+        {
+            int iOldGoal = m_iGoal;
+            m_iGoal = iGoal;
+            UpdateCell(iOldGoal);
+            UpdateCell(m_iGoal);
+        }
+
+        // changed cells alter their own edges and diagonal edges around them
+        for(std::vector<WorldFile::CellChange>::iterator change = changes.begin(); change != changes.end(); ++change)
+        {
+            UpdateCellsAround(change->row, change->col);
+        }
+    }
+
+    m_bComplete = ComputeShortestPath(iMaxExpansions);
+}
+
+/**
+* Drops all planner state (the memory is kept for reuse). The next update
+* plans from scratch.
+*/
+void DStarLite::Clear()
+{
+    // a new generation empties every table entry
+    if( ++m_uGeneration == 0 )
+    {
+        for(std::vector<CellData>::iterator entry = m_vTable.begin(); entry != m_vTable.end(); ++entry)
+            entry->uGeneration = 0;
+        m_uGeneration = 1;
+    }
+    m_iTableCount = 0;
+    m_vQueue.clear();
+
+    m_iStart = -1;
+    m_iGoal = -1;
+    m_iLast = -1;
+    m_bComplete = false;
+}
+
+/**
+* Finds the next cell towards the goal: the neighbor minimizing the step cost
+* plus its distance. The goal cell returns itself. Returns false if the search
+* is not complete or the goal cannot be reached.
+*/
+bool DStarLite::GetNextCell(PathNodeKey* nkNext) const
+{
+    if( m_iStart == -1 || !m_bComplete || GetDistance(m_iStart) == kInfiniteCost )
+        return false;
+
+    int iRow = m_iStart / m_iWidth;
+    int iCol = m_iStart % m_iWidth;
+    nkNext->iRow = iRow;
+    nkNext->iCol = iCol;
+
+    if( m_iStart == m_iGoal )
+        return true;
+
+    float fBestCost = kInfiniteCost;
+    for(int dRow = -1; dRow <= 1; ++dRow)
+    {
+        for(int dCol = -1; dCol <= 1; ++dCol)
+        {
+            float fStepCost = GetStepCost(iRow, iCol, dRow, dCol);
+            if( fStepCost <= 0.0f )
+                continue;
+
+            float fDistance = GetDistance(GetIndex(iRow + dRow, iCol + dCol));
+            if( fDistance != kInfiniteCost && fDistance + fStepCost < fBestCost )
+            {
+                fBestCost = fDistance + fStepCost;
+                nkNext->iRow = iRow + dRow;
+                nkNext->iCol = iCol + dCol;
+            }
+        }
+    }
+
+    return (fBestCost != kInfiniteCost);
+}
+
+/**
+* Clears all planner state and seeds the search at the goal.
+*/
+void DStarLite::Reset(int iStart, int iGoal)
+{
+    Clear();
+
+    m_iStart = iStart;
+    m_iLast = iStart;
+    m_iGoal = iGoal;
+    m_fKeyModifier = 0.0f;
+
+    UpdateCell(m_iGoal);
+}
+
+/**
+* Recomputes the lookahead distance of a cell and queues it if it is
+* inconsistent. The goal cell is joined to the virtual goal at no cost.
+*/
+void DStarLite::UpdateCell(int iCell)
+{
+    CellData& cell = GetCell(iCell);
+    int iRow = iCell / m_iWidth;
+    int iCol = iCell % m_iWidth;
+
+    // lookahead distance
+    if( iCell == m_iGoal )
+    {
+        cell.fLookahead = 0.0f;
+    }
+    else
+    {
+        cell.fLookahead = kInfiniteCost;
+        for(int dRow = -1; dRow <= 1; ++dRow)
+        {
+            for(int dCol = -1; dCol <= 1; ++dCol)
+            {
+                float fStepCost = GetStepCost(iRow, iCol, dRow, dCol);
+                if( fStepCost <= 0.0f )
+                    continue;
+
+                float fDistance = GetDistance(GetIndex(iRow + dRow, iCol + dCol));
+                if( fDistance != kInfiniteCost && fDistance + fStepCost < cell.fLookahead )
+                    cell.fLookahead = fDistance + fStepCost;
+            }
+        }
+    }
+
+    // requeue if inconsistent
+    if( cell.iHeapIndex != -1 )
+        Remove(iCell);
+
+    if( cell.fDistance != cell.fLookahead )
+    {
+        cell.key = CalculateKey(iCell);
+        Push(iCell);
+    }
+}
+
+/**
+* Updates a changed cell and its neighbors
+*/
+void DStarLite::UpdateCellsAround(int iRow, int iCol)
+{
+    for(int r = iRow - 1; r <= iRow + 1; ++r)
+    {
+        for(int c = iCol - 1; c <= iCol + 1; ++c)
+        {
+            if( r >= 0 && r < m_iHeight && c >= 0 && c < m_iWidth )
+                UpdateCell(GetIndex(r, c));
+        }
+    }
+}
+
+/**
+* Expands inconsistent cells until the agent cell is consistent and no
+* queued cell could lower its distance, or until the expansion limit.
+* Returns true if the search finished.
+*/
+bool DStarLite::ComputeShortestPath(int iMaxExpansions)
+{
+    while( !m_vQueue.empty() &&
+           (GetCell(m_vQueue[0]).key < CalculateKey(m_iStart) || GetCell(m_iStart).fLookahead != GetCell(m_iStart).fDistance) )
+    {
+        // continue next update
+        if( m_iExpanded >= iMaxExpansions )
+            return false;
+
+        int iCell = m_vQueue[0];
+        CellData& cell = GetCell(iCell);
+
+        Key oldKey = cell.key;
+        Key newKey = CalculateKey(iCell);
+
+        // key out of date (agent moved), requeue
+        if( oldKey < newKey )
+        {
+            Remove(iCell);
+            cell.key = newKey;
+            Push(iCell);
+            continue;
+        }
+
+        Remove(iCell);
+        ++m_iExpanded;
+
+        int iRow = iCell / m_iWidth;
+        int iCol = iCell % m_iWidth;
+
+        // overconsistent: distance lowered
+        if( cell.fDistance > cell.fLookahead )
+        {
+            cell.fDistance = cell.fLookahead;
+        }
+
+        // underconsistent: distance raised, cell itself must be updated too
+        else
+        {
+            cell.fDistance = kInfiniteCost;
+            UpdateCell(iCell);
+        }
+
+        // update neighbors (moves are symmetric; may grow the table, so the
+        // cell reference is not used past here)
+        for(int dRow = -1; dRow <= 1; ++dRow)
+        {
+            for(int dCol = -1; dCol <= 1; ++dCol)
+            {
+                if( GetStepCost(iRow, iCol, dRow, dCol) > 0.0f )
+                    UpdateCell(GetIndex(iRow + dRow, iCol + dCol));
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+* Compares queue keys
+*/
+bool DStarLite::Key::operator<(const Key& rhs) const
+{
+    if( fFirst < rhs.fFirst - kKeyTolerance )
+        return true;
+
+    if( fFirst > rhs.fFirst + kKeyTolerance )
+        return false;
+
+    return fSecond < rhs.fSecond - kKeyTolerance;
+}
+
+/**
+* Computes the queue key of a cell
+*/
+DStarLite::Key DStarLite::CalculateKey(int iCell) const
+{
+    const CellData* cell = FindCell(iCell);
+    float fMin = kInfiniteCost;
+    if( cell )
+        fMin = (cell->fDistance < cell->fLookahead) ? cell->fDistance : cell->fLookahead;
+
+    Key key;
+    key.fSecond = fMin;
+    key.fFirst = (fMin == kInfiniteCost) ? kInfiniteCost : fMin + ComputeHeuristicCost(m_iStart, iCell) + m_fKeyModifier;
+    return key;
+}
+
+/**
+* Compute cardinal/intercardinal distance between two cells
+*/
+float DStarLite::ComputeHeuristicCost(int iCellA, int iCellB) const
+{
+    float xDiff = (float)abs(iCellA % m_iWidth - iCellB % m_iWidth);
+    float yDiff = (float)abs(iCellA / m_iWidth - iCellB / m_iWidth);
+
+    float fMin = (xDiff < yDiff) ? xDiff : yDiff;
+    float fMax = (xDiff < yDiff) ? yDiff : xDiff;
+    return fMin * kDiagonalCost + fMax - fMin;
+}
+
+/**
+* Returns the cost of moving from the cell in the specified direction, or 0
+* if the move is not allowed. Diagonal moves may not cut wall corners.
+*/
+float DStarLite::GetStepCost(int iRow, int iCol, int dRow, int dCol) const
+{
+    if( (!dRow && !dCol) || !IsOpenCell(iRow, iCol) || !IsOpenCell(iRow + dRow, iCol + dCol) )
+        return 0.0f;
+
+    if( !dRow || !dCol )
+        return kCardinalCost;
+
+    if( !IsOpenCell(iRow + dRow, iCol) || !IsOpenCell(iRow, iCol + dCol) )
+        return 0.0f;
+
+    return kDiagonalCost;
+}
+
+/**
+* Checks if the cell can be entered
+*/
+bool DStarLite::IsOpenCell(int iRow, int iCol) const
+{
+    if( iCol >= m_iWidth || iCol < 0 || iRow >= m_iHeight || iRow < 0 )
+        return false;
+
+    return m_worldFile(iRow, iCol) != WorldFile::OCCUPIED_CELL;
+}
+
+//////////////////
+// CELL DATA //
+//////////////////
+
+/**
+* Finds the data of a touched cell (null if untouched this generation)
+*/
+const DStarLite::CellData* DStarLite::FindCell(int iCell) const
+{
+    unsigned int uMask = (unsigned int)m_vTable.size() - 1;
+    unsigned int uSlot = ((unsigned int)iCell * 2654435761u) & uMask;
+    while( m_vTable[uSlot].uGeneration == m_uGeneration )
+    {
+        if( m_vTable[uSlot].iCell == iCell )
+            return &m_vTable[uSlot];
+        uSlot = (uSlot + 1) & uMask;
+    }
+
+    return NULL;
+}
+
+/**
+* Returns the data of a cell, adding it (not reachable, not queued) if it was
+* untouched. Adding may grow the table, moving the other entries.
+*/
+DStarLite::CellData& DStarLite::GetCell(int iCell)
+{
+    const CellData* found = FindCell(iCell);
+    if( found )
+        return const_cast<CellData&>(*found);
+
+    // keep the table at most half full
+    if( (m_iTableCount + 1) * 2 > (int)m_vTable.size() )
+        GrowTable();
+
+    unsigned int uMask = (unsigned int)m_vTable.size() - 1;
+    unsigned int uSlot = ((unsigned int)iCell * 2654435761u) & uMask;
+    while( m_vTable[uSlot].uGeneration == m_uGeneration )
+        uSlot = (uSlot + 1) & uMask;
+
+    CellData& cell = m_vTable[uSlot];
+    cell.iCell = iCell;
+    cell.uGeneration = m_uGeneration;
+    cell.fDistance = kInfiniteCost;
+    cell.fLookahead = kInfiniteCost;
+    cell.key.fFirst = kInfiniteCost;
+    cell.key.fSecond = kInfiniteCost;
+    cell.iHeapIndex = -1;
+    ++m_iTableCount;
+    return cell;
+}
+
+/**
+* Returns the distance of a cell (infinite if untouched)
+*/
+float DStarLite::GetDistance(int iCell) const
+{
+    const CellData* cell = FindCell(iCell);
+    return cell ? cell->fDistance : kInfiniteCost;
+}
+
+/**
+* Doubles the table, moving the entries of the current generation
+*/
+void DStarLite::GrowTable()
+{
+    std::vector<CellData> vOld;
+    vOld.swap(m_vTable);
+
+    CellData empty;
+    empty.iCell = -1;
+    empty.uGeneration = 0;
+    m_vTable.assign(vOld.size() * 2, empty);
+
+    unsigned int uMask = (unsigned int)m_vTable.size() - 1;
+    for(std::vector<CellData>::iterator entry = vOld.begin(); entry != vOld.end(); ++entry)
+    {
+        if( entry->uGeneration != m_uGeneration )
+            continue;
+
+        unsigned int uSlot = ((unsigned int)entry->iCell * 2654435761u) & uMask;
+        while( m_vTable[uSlot].uGeneration == m_uGeneration )
+            uSlot = (uSlot + 1) & uMask;
+        m_vTable[uSlot] = *entry;
+    }
+}
+
+/////////////////////
+// PRIORITY QUEUE //
+/////////////////////
+
+/**
+* Adds a cell to the queue
+*/
+void DStarLite::Push(int iCell)
+{
+    GetCell(iCell).iHeapIndex = (int)m_vQueue.size();
+    m_vQueue.push_back(iCell);
+    SiftUp((int)m_vQueue.size() - 1);
+}
+
+/**
+* Removes a cell from the queue
+*/
+void DStarLite::Remove(int iCell)
+{
+    int iHeapIndex = GetCell(iCell).iHeapIndex;
+    int iLast = m_vQueue.back();
+
+    m_vQueue.pop_back();
+    GetCell(iCell).iHeapIndex = -1;
+
+    // move last cell into the hole
+    if( iLast != iCell )
+    {
+        m_vQueue[iHeapIndex] = iLast;
+        GetCell(iLast).iHeapIndex = iHeapIndex;
+        SiftUp(iHeapIndex);
+        SiftDown(GetCell(iLast).iHeapIndex);
+    }
+}
+
+/**
+* Moves a queued cell towards the root while its key is lower than its parent
+*/
+void DStarLite::SiftUp(int iHeapIndex)
+{
+    int iCell = m_vQueue[iHeapIndex];
+    while( iHeapIndex > 0 )
+    {
+        int iParentIndex = (iHeapIndex - 1) / 2;
+        int iParent = m_vQueue[iParentIndex];
+        if( !(GetCell(iCell).key < GetCell(iParent).key) )
+            break;
+
+        m_vQueue[iHeapIndex] = iParent;
+        GetCell(iParent).iHeapIndex = iHeapIndex;
+        iHeapIndex = iParentIndex;
+    }
+
+    m_vQueue[iHeapIndex] = iCell;
+    GetCell(iCell).iHeapIndex = iHeapIndex;
+}
+
+/**
+* Moves a queued cell towards the leaves while a child has a lower key
+*/
+void DStarLite::SiftDown(int iHeapIndex)
+{
+    int iCell = m_vQueue[iHeapIndex];
+    int iSize = (int)m_vQueue.size();
+    while( true )
+    {
+        int iChildIndex = iHeapIndex * 2 + 1;
+        if( iChildIndex >= iSize )
+            break;
+
+        if( iChildIndex + 1 < iSize && GetCell(m_vQueue[iChildIndex + 1]).key < GetCell(m_vQueue[iChildIndex]).key )
+            ++iChildIndex;
+
+        int iChild = m_vQueue[iChildIndex];
+        if( !(GetCell(iChild).key < GetCell(iCell).key) )
+            break;
+
+        m_vQueue[iHeapIndex] = iChild;
+        GetCell(iChild).iHeapIndex = iHeapIndex;
+        iHeapIndex = iChildIndex;
+    }
+
+    m_vQueue[iHeapIndex] = iCell;
+    GetCell(iCell).iHeapIndex = iHeapIndex;
+}
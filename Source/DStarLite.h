@@ -0,0 +1,124 @@
+/*******************************************************************************
+* Game Development Project
+* DStarLite.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Incremental (D* Lite) path planner for a moving agent and goal
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "PathSearch.h"
+
+/**
+* D* Lite planner. The search runs backwards from the goal, so the distance
+* from every expanded cell to the goal is kept between updates and the agent
+* may move freely (the key modifier accounts for the moved heuristic origin).
+*
+* The goal is modeled as a virtual node joined to the goal cell by a zero cost
+* edge; moving the goal only changes that edge, so the old and new goal cells
+* are updated like any other edge cost change. Changed world cells update the
+* cells around them. In both cases only the affected part of the search is
+* repaired.
+*
+* Only cells the search has touched have planner data, kept in a hash table
+* stamped with a generation so that clearing the planner is constant time.
+* A cleared planner keeps its table and queue memory for the next pursuit.
+* Each update expands a bounded number of cells; the search may take several
+* updates to finish, and no next cell is given until it has.
+*/
+class DStarLite
+{
+    public:
+
+        // constructor
+        DStarLite(const WorldFile& worldFile);
+        ~DStarLite();
+
+        // planning
+        void Update(const PathNodeKey& nkStart, const PathNodeKey& nkGoal, int iMaxExpansions);
+        void Clear();
+        bool IsComplete() const { return m_bComplete; }
+        bool GetNextCell(PathNodeKey* nkNext) const;
+
+        // planner info
+        int GetExpandedCount() const { return m_iExpanded; }
+        int GetTableSize() const { return (int)m_vTable.size(); }
+
+    private:
+
+        /**
+        * Priority key (compared lexicographically). Path costs are sums of
+        * cardinal and diagonal steps, so equal keys reached along different
+        * paths may differ by rounding; first values within a small tolerance
+        * are treated as equal.
+        */
+        struct Key
+        {
+            float fFirst;
+            float fSecond;
+
+            bool operator<(const Key& rhs) const;
+        };
+
+        /**
+        * Per-cell planner data (hash table entry)
+        */
+        struct CellData
+        {
+            int iCell;                  // cell index
+            unsigned int uGeneration;   // entry is empty unless this is the current generation
+            float fDistance;            // g: distance to goal
+            float fLookahead;           // rhs: one step lookahead distance
+            Key key;                    // queue key
+            int iHeapIndex;             // queue position (-1 if not queued)
+        };
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+        unsigned int m_uWorldVersion;   // world version planned on
+
+        // planner state
+        std::vector<CellData> m_vTable;     // touched cell data (open addressing, power of 2 size)
+        int m_iTableCount;                  // entries of the current generation
+        unsigned int m_uGeneration;         // current table generation
+        std::vector<int> m_vQueue;          // priority queue heap (cell indices)
+        int m_iStart;                       // agent cell (-1 before first update)
+        int m_iGoal;                        // goal cell
+        int m_iLast;                        // agent cell when the key modifier was last updated
+        float m_fKeyModifier;               // km: accumulated heuristic change
+        int m_iExpanded;                    // cells expanded by the last update
+        bool m_bComplete;                   // search finished for the current agent cell
+
+        // planner methods
+        void Reset(int iStart, int iGoal);
+        void UpdateCell(int iCell);
+        void UpdateCellsAround(int iRow, int iCol);
+        bool ComputeShortestPath(int iMaxExpansions);
+        Key CalculateKey(int iCell) const;
+        float ComputeHeuristicCost(int iCellA, int iCellB) const;
+        float GetStepCost(int iRow, int iCol, int dRow, int dCol) const;
+        bool IsOpenCell(int iRow, int iCol) const;
+        int GetIndex(int iRow, int iCol) const { return iRow * m_iWidth + iCol; }
+
+        // cell data methods
+        const CellData* FindCell(int iCell) const;
+        CellData& GetCell(int iCell);
+        float GetDistance(int iCell) const;
+        void GrowTable();
+
+        // queue methods
+        void Push(int iCell);
+        void Remove(int iCell);
+        void SiftUp(int iHeapIndex);
+        void SiftDown(int iHeapIndex);
+
+        // prevent copy and assignment
+        DStarLite(const DStarLite&);
+        DStarLite& operator=(const DStarLite&);
+};
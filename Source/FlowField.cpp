@@ -0,0 +1,250 @@
+/*******************************************************************************
+* Game Development Project
+* FlowField.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Flow field (Dijkstra map) towards a goal cell
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "FlowField.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <functional>
+
+// movement costs between neighboring cell centers
+static const float kCardinalCost = 1.0f;
+static const float kDiagonalCost = 1.41421356f;
+
+// distance of cells that cannot reach the goal
+static const float kUnreachableCost = FLT_MAX;
+
+// largest cost offset before the field is recomputed (keeps float precision)
+static const float kMaxCostOffset = 4096.0f;
+
+/**
+* Constructor
+*/
+FlowField::FlowField(const WorldFile& worldFile) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_fCostOffset(0.0f),
+    m_bValid(false),
+    m_uLastUsedFrame(0),
+    m_uStepFrame(0),
+    m_iUpdated(0)
+{
+    m_vCost.assign(m_iWidth * m_iHeight, kUnreachableCost);
+    m_vOpen.reserve(m_iWidth + m_iHeight);
+
+    m_nkGoal.iRow = -1;
+    m_nkGoal.iCol = -1;
+}
+
+/**
+* Deconstructor
+*/
+FlowField::~FlowField()
+{}
+
+/**
+* Sets the goal cell and computes the whole field
+*/
+void FlowField::SetGoal(const PathNodeKey& nkGoal)
+{
+    BeginGoal(nkGoal);
+    Step(INT_MAX);
+}
+
+/**
+* Sets the goal cell; the field is computed by the following steps. A goal
+* one step from the current goal keeps the current distances, raised by the
+* step through the cost offset, and any steps still pending.
+*/
+void FlowField::BeginGoal(const PathNodeKey& nkGoal)
+{
+    if( HasGoal(nkGoal) )
+        return;
+
+    m_iUpdated = 0;
+
+    // neighboring goal: every path may continue through the old goal
+    if( IsNeighborGoal(nkGoal) && fabs(m_fCostOffset) < kMaxCostOffset )
+    {
+        m_fCostOffset += GetStepCost(m_nkGoal.iRow, m_nkGoal.iCol, nkGoal.iRow - m_nkGoal.iRow, nkGoal.iCol - m_nkGoal.iCol);
+    }
+
+    // recompute from scratch
+    else
+    {
+        m_vOpen.clear();
+        std::fill(m_vCost.begin(), m_vCost.end(), kUnreachableCost);
+        m_fCostOffset = 0.0f;
+    }
+
+    m_nkGoal = nkGoal;
+    m_bValid = true;
+
+    // goal outside the grid, nothing reachable
+    if( nkGoal.iRow < 0 || nkGoal.iRow >= m_iHeight || nkGoal.iCol < 0 || nkGoal.iCol >= m_iWidth )
+        return;
+
+    // lower the field from the new goal
+    int iGoal = GetIndex(nkGoal.iRow, nkGoal.iCol);
+    m_vCost[iGoal] = -m_fCostOffset;
+    m_vOpen.push_back(OpenEntry(m_vCost[iGoal], iGoal));
+    std::push_heap(m_vOpen.begin(), m_vOpen.end(), std::greater<OpenEntry>());
+}
+
+/**
+* Checks if the goal is one open step (no corner cutting) from the current
+* goal, so paths to the current goal can finish with that step.
+*/
+bool FlowField::IsNeighborGoal(const PathNodeKey& nkGoal) const
+{
+    if( !m_bValid || !IsOpenCell(m_nkGoal.iRow, m_nkGoal.iCol) || !IsOpenCell(nkGoal.iRow, nkGoal.iCol) )
+        return false;
+
+    int dRow = nkGoal.iRow - m_nkGoal.iRow;
+    int dCol = nkGoal.iCol - m_nkGoal.iCol;
+    if( abs(dRow) > 1 || abs(dCol) > 1 || (!dRow && !dCol) )
+        return false;
+
+    return GetStepCost(m_nkGoal.iRow, m_nkGoal.iCol, dRow, dCol) > 0.0f;
+}
+
+/**
+* Finds the next cell towards the goal: the neighbor through which the cell's
+* distance was reached. The goal cell returns itself. Returns false if the
+* goal cannot be reached.
+*/
+bool FlowField::GetNextCell(const PathNodeKey& key, PathNodeKey* nkNext) const
+{
+    if( GetCost(key) == kUnreachableCost )
+        return false;
+
+    float fCost = m_vCost[GetIndex(key.iRow, key.iCol)];
+    *nkNext = key;
+
+    float fBestCost = kUnreachableCost;
+    for(int dRow = -1; dRow <= 1; ++dRow)
+    {
+        for(int dCol = -1; dCol <= 1; ++dCol)
+        {
+            float fStepCost = GetStepCost(key.iRow, key.iCol, dRow, dCol);
+            if( fStepCost <= 0.0f )
+                continue;
+
+            float fNeighborCost = m_vCost[GetIndex(key.iRow + dRow, key.iCol + dCol)];
+
+            // keep the closer neighbor with the lowest distance through it
+            if( fNeighborCost < fCost && fNeighborCost + fStepCost < fBestCost )
+            {
+                fBestCost = fNeighborCost + fStepCost;
+                nkNext->iRow = key.iRow + dRow;
+                nkNext->iCol = key.iCol + dCol;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+* Returns the distance from the cell to the goal (FLT_MAX if unreachable)
+*/
+float FlowField::GetCost(const PathNodeKey& key) const
+{
+    if( !m_bValid || key.iRow < 0 || key.iRow >= m_iHeight || key.iCol < 0 || key.iCol >= m_iWidth )
+        return kUnreachableCost;
+
+    float fCost = m_vCost[GetIndex(key.iRow, key.iCol)];
+    if( fCost == kUnreachableCost )
+        return kUnreachableCost;
+
+    return fCost + m_fCostOffset;
+}
+
+/**
+* Checks if the cell can be entered
+*/
+bool FlowField::IsOpenCell(int iRow, int iCol) const
+{
+    if( iCol >= m_iWidth || iCol < 0 || iRow >= m_iHeight || iRow < 0 )
+        return false;
+
+    return m_worldFile(iRow, iCol) != WorldFile::OCCUPIED_CELL;
+}
+
+/**
+* Returns the cost of moving from the cell in the specified direction, or 0
+* if the move is not allowed. Diagonal moves may not cut wall corners.
+*/
+float FlowField::GetStepCost(int iRow, int iCol, int dRow, int dCol) const
+{
+    if( (!dRow && !dCol) || !IsOpenCell(iRow + dRow, iCol + dCol) )
+        return 0.0f;
+
+    if( !dRow || !dCol )
+        return kCardinalCost;
+
+    if( !IsOpenCell(iRow + dRow, iCol) || !IsOpenCell(iRow, iCol + dCol) )
+        return 0.0f;
+
+    return kDiagonalCost;
+}
+
+/**
+* Runs Dijkstra from the open cells for up to the given number of expansions,
+* lowering every cell that can be reached with a smaller distance. Returns
+* true once the field is complete.
+*/
+bool FlowField::Step(int iMaxExpansions)
+{
+    std::greater<OpenEntry> compare;
+
+    int iExpanded = 0;
+    while( !m_vOpen.empty() && iExpanded < iMaxExpansions )
+    {
+        std::pop_heap(m_vOpen.begin(), m_vOpen.end(), compare);
+        OpenEntry entry = m_vOpen.back();
+        m_vOpen.pop_back();
+
+        // stale entry
+        if( entry.first > m_vCost[entry.second] )
+            continue;
+
+        ++iExpanded;
+        ++m_iUpdated;
+
+        int iRow = entry.second / m_iWidth;
+        int iCol = entry.second % m_iWidth;
+        for(int dRow = -1; dRow <= 1; ++dRow)
+        {
+            for(int dCol = -1; dCol <= 1; ++dCol)
+            {
+                float fStepCost = GetStepCost(iRow, iCol, dRow, dCol);
+                if( fStepCost <= 0.0f )
+                    continue;
+
+                int iNeighbor = GetIndex(iRow + dRow, iCol + dCol);
+                float fCost = entry.first + fStepCost;
+                if( fCost < m_vCost[iNeighbor] )
+                {
+                    m_vCost[iNeighbor] = fCost;
+                    m_vOpen.push_back(OpenEntry(fCost, iNeighbor));
+                    std::push_heap(m_vOpen.begin(), m_vOpen.end(), compare);
+                }
+            }
+        }
+    }
+
+    return m_vOpen.empty();
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Game Development Project
+* FlowField.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Flow field (Dijkstra map) towards a goal cell
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "PathSearch.h"
+
+/**
+* Integration field holding the shortest distance from every cell to a goal
+* cell, using the same movement rules as PathSearch. Any number of agents may
+* query their next cell in constant time.
+*
+* A field is computed in bounded steps. Moving the goal to a neighboring cell
+* keeps the old distances: plus the goal step they are lengths of real paths
+* (through the old goal), so a shared cost offset adds the step in constant
+* time and the steps only lower cells that get closer. Between steps every
+* reached cell still descends to the goal, on a path that may not yet be the
+* shortest.
+*/
+class FlowField
+{
+    public:
+
+        // constructor
+        FlowField(const WorldFile& worldFile);
+        ~FlowField();
+
+        // goal
+        void SetGoal(const PathNodeKey& nkGoal);
+        void BeginGoal(const PathNodeKey& nkGoal);
+        bool Step(int iMaxExpansions);
+        bool IsComplete() const { return m_vOpen.empty(); }
+        bool HasGoal(const PathNodeKey& nkGoal) const { return m_bValid && nkGoal.iRow == m_nkGoal.iRow && nkGoal.iCol == m_nkGoal.iCol; }
+        bool IsNeighborGoal(const PathNodeKey& nkGoal) const;
+        void Invalidate() { m_bValid = false; }
+
+        // queries
+        bool GetNextCell(const PathNodeKey& key, PathNodeKey* nkNext) const;
+        float GetCost(const PathNodeKey& key) const;
+
+        // field info
+        unsigned int GetLastUsedFrame() const { return m_uLastUsedFrame; }
+        void SetLastUsedFrame(unsigned int uFrame) { m_uLastUsedFrame = uFrame; }
+        unsigned int GetStepFrame() const { return m_uStepFrame; }
+        void SetStepFrame(unsigned int uFrame) { m_uStepFrame = uFrame; }
+        int GetUpdatedCount() const { return m_iUpdated; }
+
+    private:
+
+        typedef std::pair<float, int> OpenEntry;
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+
+        // field data
+        std::vector<float> m_vCost;         // distance to goal per cell, less the offset (row-major)
+        float m_fCostOffset;                // goal steps added to every distance
+        std::vector<OpenEntry> m_vOpen;     // open heap (lazy deletion)
+        PathNodeKey m_nkGoal;               // goal cell
+        bool m_bValid;                      // field set for the goal
+        unsigned int m_uLastUsedFrame;      // frame of last use (eviction)
+        unsigned int m_uStepFrame;          // frame of the last step
+        int m_iUpdated;                     // cells expanded since the last goal change
+
+        // field methods
+        int GetIndex(int iRow, int iCol) const { return iRow * m_iWidth + iCol; }
+        bool IsOpenCell(int iRow, int iCol) const;
+        float GetStepCost(int iRow, int iCol, int dRow, int dCol) const;
+
+        // prevent copy and assignment
+        FlowField(const FlowField&);
+        FlowField& operator=(const FlowField&);
+};
@@ -34,6 +34,8 @@
 #include "WorldNode.h"
 #include "WorldFile.h"
 #include "WorldData.h"
+#include "WorldChunks.h"
+#include "InfluenceMap.h"
 #include "MiniMapNode.h"
 #include "ProjectileParticles.h"
 
@@ -54,6 +56,8 @@ ObjectCollision*            g_objColl = NULL;           // collision object
 WorldData*                  g_WorldData = NULL;         // world pathfinding
 RenderData*                 g_pRenderData = NULL;       // render data
 WorldFile*                  g_pWorldFile = NULL;        // world data
+WorldChunks*                g_pWorldChunks = NULL;      // world chunk streaming
+InfluenceMap*               g_pInfluenceMap = NULL;     // AI influence map
 GameController*             g_pGameController = NULL;   // game control
 
 //--------------------------------------------------------------------------------------
@@ -68,12 +72,28 @@ GameController*             g_pGameController = NULL;   // game control
 #define IDC_RESETTIME           12
 #define IDC_DEBUGPATHING        13
 #define IDC_DEBUGTERRAIN        14
+#define IDC_ANYANGLE            15
+#define IDC_INCREMENTALPURSUIT  16
+
+//--------------------------------------------------------------------------------------
+// World chunk streaming (chunks loaded around each agent, and resident chunk cap)
+//--------------------------------------------------------------------------------------
+const int kChunkLoadRadius = 2;
+const int kMaxResidentChunks = 256;
+
+//--------------------------------------------------------------------------------------
+// Influence map (largest map width or height in cells, and player sight range in cells)
+//--------------------------------------------------------------------------------------
+const int kInfluenceMapSize = 256;
+const float kPlayerSightRange = 24.0f;
 
 //--------------------------------------------------------------------------------------
 // Forward declarations
 //--------------------------------------------------------------------------------------
 
 void CALLBACK OnGUIEvent( UINT nEvent, int nControlID, CDXUTControl* pControl, void* pUserContext );
+void UpdateWorldChunks( bool bWait );
+void UpdateInfluenceMap();
 
 //--------------------------------------------------------------------------------------
 // Initialize Application
@@ -94,6 +114,8 @@ bool InitApp()
     g_HUD.AddButton( IDC_RESETTIME,         L"Reset Time",          35, iY += 48, 125, 22 );
     g_HUD.AddButton( IDC_DEBUGPATHING,      L"Debug Pathing",       35, iY += 24, 125, 22 );
     g_HUD.AddButton( IDC_DEBUGTERRAIN,      L"Terrain Analysis",    35, iY += 24, 125, 22 );
+    g_HUD.AddButton( IDC_ANYANGLE,          L"Any-Angle Paths",     35, iY += 24, 125, 22 );
+    g_HUD.AddButton( IDC_INCREMENTALPURSUIT,L"Incremental Pursuit", 35, iY += 24, 125, 22 );
     
     // Add mixed vp to the available vp choices in device settings dialog.
     DXUTGetD3D9Enumeration()->SetPossibleVertexProcessingList( true, false, false, true );
@@ -239,12 +261,16 @@ HRESULT CALLBACK OnResetDevice( IDirect3DDevice9* pd3dDevice,
     if( !g_pWorldFile->Load(L"level.grd") )
         return E_FAIL;
 
+    // stream world chunks (chunk clients register as they are created)
+    g_pWorldChunks = new WorldChunks(*g_pWorldFile, kChunkLoadRadius, kMaxResidentChunks);
+
     // initialize singleton objects
 	g_pTime = new Time();
 	g_pDatabase = new Database();
 	g_pMsgRoute = new MsgRoute();
 	g_pDebugLog = new DebugLog();
     g_WorldData = new WorldData(*g_pWorldFile);
+    g_pInfluenceMap = new InfluenceMap(*g_pWorldFile, kInfluenceMapSize);
 
     // add world object
     WorldNode* p_WorldNode = new WorldNode(*g_pWorldFile, L"asphalt-damaged.jpg", L"painted_metal.jpg");
@@ -304,8 +330,11 @@ HRESULT CALLBACK OnResetDevice( IDirect3DDevice9* pd3dDevice,
         return E_FAIL;
     }
 
+    // load the chunks around the player and NPCs
+    UpdateWorldChunks(true);
+
     // create collision object
-    g_objColl = new ObjectCollision( p_WorldNode->GetCollQuadList() );
+    g_objColl = new ObjectCollision( *p_WorldNode );
 
     // setup NPC state machines
     pNPC1->GetStateMachineManager()->PushStateMachine( *new SMRandomPath(pNPC1, pMainPlayerNode->GetID()), STATE_MACHINE_QUEUE_0, TRUE );
@@ -332,7 +361,7 @@ HRESULT CALLBACK OnResetDevice( IDirect3DDevice9* pd3dDevice,
 
     // adjust the dialog parameters
     g_HUD.SetLocation( pBackBufferSurfaceDesc->Width-170, 0 );
-    g_HUD.SetSize( 170, 170 );
+    g_HUD.SetSize( 170, 230 );
     g_SampleUI.SetLocation( pBackBufferSurfaceDesc->Width-170, pBackBufferSurfaceDesc->Height-270 );
     g_SampleUI.SetSize( 170, 220 );
 
@@ -353,6 +382,12 @@ void CALLBACK OnFrameMove( double fTime, float fElapsedTime, void* pUserContext
     // update database objects
 	g_database.UpdateObjects();
 
+    // stream world chunks around the player and NPCs
+    UpdateWorldChunks(false);
+
+    // update threat, occupancy and visibility influence
+    UpdateInfluenceMap();
+
     // generate list of players and NPCs
     dbCompositionList pList;
     g_database.ComposeList( pList, OBJECT_NPC | OBJECT_Player );
@@ -364,6 +399,51 @@ void CALLBACK OnFrameMove( double fTime, float fElapsedTime, void* pUserContext
     }
 }
 
+//--------------------------------------------------------------------------------------
+// Streams the world chunks around the player and NPCs. When waiting, returns once the
+// chunks around every agent are resident.
+//--------------------------------------------------------------------------------------
+void UpdateWorldChunks( bool bWait )
+{
+    dbCompositionList pList;
+    g_database.ComposeList( pList, OBJECT_NPC | OBJECT_Player );
+
+    vector<D3DXVECTOR2> focusPoints;
+    focusPoints.reserve( pList.size() );
+    for(dbCompositionList::iterator it = pList.begin(); it != pList.end(); ++it)
+    {
+        focusPoints.push_back( (*it)->GetGridPosition() );
+    }
+
+    g_chunks.Update( focusPoints, bWait );
+}
+
+//--------------------------------------------------------------------------------------
+// Gives the influence map its sources: the player is a threat and sees the cells around
+// it, and each NPC adds to the occupancy.
+//--------------------------------------------------------------------------------------
+void UpdateInfluenceMap()
+{
+    dbCompositionList pList;
+    g_database.ComposeList( pList, OBJECT_NPC | OBJECT_Player );
+
+    vector<InfluenceSource> sources;
+    for(dbCompositionList::iterator it = pList.begin(); it != pList.end(); ++it)
+    {
+        InfluenceSource source = { kInfluenceOccupancy, (*it)->GetGridPosition(), 1.0f, 0.0f };
+        if( (*it)->GetType() & OBJECT_Player )
+        {
+            source.iLayer = kInfluenceThreat;
+            sources.push_back( source );
+            source.iLayer = kInfluenceVisibility;
+            source.fRadius = kPlayerSightRange;
+        }
+        sources.push_back( source );
+    }
+
+    g_influence.Update( sources, g_time.GetElapsedTime() );
+}
+
 //--------------------------------------------------------------------------------------
 // This callback function will be called at the end of every frame to perform all the
 // rendering calls for the scene, and it will also be called if the window needs to be
@@ -495,6 +575,14 @@ void CALLBACK OnGUIEvent( UINT nEvent, int nControlID, CDXUTControl* pControl, v
         case IDC_DEBUGTERRAIN:
             g_world.ToggleTerrainAnalysisType();
             break;
+
+        case IDC_ANYANGLE:
+            g_world.ToggleAnyAngle();
+            break;
+
+        case IDC_INCREMENTALPURSUIT:
+            g_world.ToggleIncrementalPursuit();
+            break;
     }
 }
 
@@ -510,6 +598,12 @@ void CALLBACK OnLostDevice( void* pUserContext )
     g_DialogResourceManager.OnD3D9LostDevice();
     g_SettingsDlg.OnD3D9LostDevice();
 
+    // stop chunk streaming before its clients are deleted
+    delete g_pWorldChunks;
+
+    // stop the influence map worker
+    delete g_pInfluenceMap;
+
     // cleanup game singletons and objects
 	delete g_pTime;
 	delete g_pDatabase;
@@ -209,6 +209,13 @@ void GameController::RenderDebugText()
     stream << "TerrainAnalysis: " << g_world.GetTerrainAnalysisName() << std::endl;
     stream << std::endl;
 
+    // path computation
+    const PathStats& pathStats = g_world.GetPathStats();
+    stream << "Paths: " << pathStats.iCompleted << "  Expanded/Frame: " << pathStats.iFrameExpansions << " (max " << pathStats.iMaxFrameExpansions << ")" << std::endl;
+    stream << "Overruns: " << pathStats.iBudgetOverruns << "  Wait: " << pathStats.dLastWaitTime * 1000.0 << "ms (max " << pathStats.dMaxWaitTime * 1000.0 << "ms)" << std::endl;
+    stream << "Cache Hits: " << pathStats.iCacheHits << "/" << (pathStats.iCacheHits + pathStats.iCacheMisses) << std::endl;
+    stream << std::endl;
+
     // state details
 	dbCompositionList list;
 	g_database.ComposeList( list, OBJECT_Ignore_Type );
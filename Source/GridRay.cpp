@@ -0,0 +1,90 @@
+/*******************************************************************************
+* Game Development Project
+* GridRay.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Grid ray traversal
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "GridRay.h"
+#include <float.h>
+#include <math.h>
+
+/**
+* Constructor. Starts at the cell holding the start position.
+*/
+GridRay::GridRay(const D3DXVECTOR2& vStart, const D3DXVECTOR2& vDir, float fMaxDistance) :
+    m_iRow((int)floorf(vStart.y)),
+    m_iCol((int)floorf(vStart.x)),
+    m_iStepRow(0),
+    m_iStepCol(0),
+    m_fNextRow(FLT_MAX),
+    m_fNextCol(FLT_MAX),
+    m_fDeltaRow(FLT_MAX),
+    m_fDeltaCol(FLT_MAX),
+    m_fDistance(0.0f),
+    m_fMaxDistance(fMaxDistance)
+{
+    float fLength = sqrtf(vDir.x*vDir.x + vDir.y*vDir.y);
+    if(fLength == 0.0f)
+    {
+        m_fMaxDistance = 0.0f;
+        return;
+    }
+
+    float fDirX = vDir.x / fLength;
+    float fDirY = vDir.y / fLength;
+
+    // column boundaries
+    if(fDirX > 0.0f)
+    {
+        m_iStepCol = 1;
+        m_fDeltaCol = 1.0f / fDirX;
+        m_fNextCol = (m_iCol + 1 - vStart.x) * m_fDeltaCol;
+    }
+    else if(fDirX < 0.0f)
+    {
+        m_iStepCol = -1;
+        m_fDeltaCol = -1.0f / fDirX;
+        m_fNextCol = (vStart.x - m_iCol) * m_fDeltaCol;
+    }
+
+    // row boundaries
+    if(fDirY > 0.0f)
+    {
+        m_iStepRow = 1;
+        m_fDeltaRow = 1.0f / fDirY;
+        m_fNextRow = (m_iRow + 1 - vStart.y) * m_fDeltaRow;
+    }
+    else if(fDirY < 0.0f)
+    {
+        m_iStepRow = -1;
+        m_fDeltaRow = -1.0f / fDirY;
+        m_fNextRow = (vStart.y - m_iRow) * m_fDeltaRow;
+    }
+}
+
+/**
+* Crosses the nearer cell boundary
+*/
+bool GridRay::Step()
+{
+    if(m_fNextCol <= m_fNextRow)
+    {
+        m_fDistance = m_fNextCol;
+        m_fNextCol += m_fDeltaCol;
+        m_iCol += m_iStepCol;
+    }
+    else
+    {
+        m_fDistance = m_fNextRow;
+        m_fNextRow += m_fDeltaRow;
+        m_iRow += m_iStepRow;
+    }
+
+    return m_fDistance <= m_fMaxDistance;
+}
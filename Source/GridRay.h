@@ -0,0 +1,49 @@
+/*******************************************************************************
+* Game Development Project
+* GridRay.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Grid ray traversal
+*
+*******************************************************************************/
+
+#pragma once
+
+/**
+* Walks the grid cells crossed by a ray, in order, using the Amanatides-Woo
+* traversal: the distances to the next column and row boundary are kept and
+* the nearer one is crossed at each step, so every crossed cell is visited
+* exactly once and no cell is skipped. Positions are grid coordinates (x is
+* the column, y the row). A ray crossing a cell corner exactly steps along
+* the columns first.
+*/
+class GridRay
+{
+    public:
+
+        // constructor (direction need not be normalized)
+        GridRay(const D3DXVECTOR2& vStart, const D3DXVECTOR2& vDir, float fMaxDistance);
+
+        // current cell
+        int GetRow() const { return m_iRow; }
+        int GetCol() const { return m_iCol; }
+        float GetDistance() const { return m_fDistance; }
+
+        // moves to the next crossed cell; false once past the maximum distance
+        bool Step();
+
+    private:
+
+        int m_iRow;                 // current cell
+        int m_iCol;
+        int m_iStepRow;             // row step (-1, 0 or 1)
+        int m_iStepCol;             // column step (-1, 0 or 1)
+        float m_fNextRow;           // ray distance to the next row boundary
+        float m_fNextCol;           // ray distance to the next column boundary
+        float m_fDeltaRow;          // ray distance between row boundaries
+        float m_fDeltaCol;          // ray distance between column boundaries
+        float m_fDistance;          // ray distance where the current cell was entered
+        float m_fMaxDistance;       // traversal length
+};
@@ -0,0 +1,514 @@
+/*******************************************************************************
+* Game Development Project
+* InfluenceMap.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Multi-layer influence map updated on a worker thread
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "InfluenceMap.h"
+#include "GridRay.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// most rays cast per sight source
+static const int kMaxSightRays = 512;
+
+// default layers: threat spreads from the player and lingers, occupancy is a
+// blurred NPC density, and visibility is the player's current sight
+static const InfluenceLayerDesc kDefaultLayers[kInfluenceLayerCount] =
+{
+    { "Threat",     kInfluenceSeedPoint, kInfluenceKernelFalloff, 0.85f, 0, 4.0f },
+    { "Occupancy",  kInfluenceSeedPoint, kInfluenceKernelBlur,    0.2f,  2, 0.0f },
+    { "Visibility", kInfluenceSeedSight, kInfluenceKernelNone,    0.0f,  0, 1.0f }
+};
+
+/**
+* Constructor. Starts the worker thread (maps are built on the main thread
+* if it cannot be started).
+*/
+InfluenceMap::InfluenceMap(const WorldFile& worldFile, int iMaxSize) :
+    m_worldFile(worldFile),
+    m_iCellSize(max(1, (max(worldFile.GetWidth(), worldFile.GetHeight()) + iMaxSize - 1) / iMaxSize)),
+    m_uWorldVersion(worldFile.GetVersion()),
+    m_iFront(0),
+    m_uUpdates(0),
+    m_fPendingTime(0.0f),
+    m_hThread(NULL),
+    m_bRunning(false),
+    m_bShutdown(false),
+    m_bQueued(false)
+{
+    m_iWidth = (worldFile.GetWidth() + m_iCellSize - 1) / m_iCellSize;
+    m_iHeight = (worldFile.GetHeight() + m_iCellSize - 1) / m_iCellSize;
+
+    for(int layer = 0; layer < kInfluenceLayerCount; ++layer)
+        m_layers[layer] = kDefaultLayers[layer];
+
+    int iCells = m_iWidth * m_iHeight;
+    m_buffers[0].assign(iCells * (kInfluenceLayerCount + 1), 0.0f);
+    m_buffers[1].assign(iCells * (kInfluenceLayerCount + 1), 0.0f);
+    m_vOpen.assign(iCells, 0.0f);
+    m_vSeed.assign(iCells, 0.0f);
+    m_vScratch.assign(iCells, 0.0f);
+
+    // the first job computes every open fraction
+    m_job.bRebuildOpen = true;
+
+    InitializeCriticalSection(&m_lock);
+    m_hStartEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    m_hThread = CreateThread(NULL, 0, ThreadProc, this, 0, NULL);
+}
+
+/**
+* Deconstructor. Stops the worker.
+*/
+InfluenceMap::~InfluenceMap()
+{
+    EnterCriticalSection(&m_lock);
+    m_bShutdown = true;
+    LeaveCriticalSection(&m_lock);
+
+    if(m_hThread)
+    {
+        SetEvent(m_hStartEvent);
+        WaitForSingleObject(m_hThread, INFINITE);
+        CloseHandle(m_hThread);
+    }
+
+    CloseHandle(m_hStartEvent);
+    DeleteCriticalSection(&m_lock);
+}
+
+/**
+* Returns the layer with a name (-1 if none)
+*/
+int InfluenceMap::FindLayer(const char* szName) const
+{
+    for(int layer = 0; layer < kInfluenceLayerCount; ++layer)
+    {
+        if( strcmp(m_layers[layer].szName, szName) == 0 )
+            return layer;
+    }
+    return -1;
+}
+
+/**
+* Swaps in the map finished by the worker and starts the next one from the
+* sources. While the worker is busy the sources are dropped and the elapsed
+* time is kept for the next job.
+*/
+void InfluenceMap::Update(const std::vector<InfluenceSource>& sources, float fElapsedTime)
+{
+    m_fPendingTime += fElapsedTime;
+
+    if(m_bQueued)
+    {
+        EnterCriticalSection(&m_lock);
+        bool bRunning = m_bRunning;
+        LeaveCriticalSection(&m_lock);
+
+        if(bRunning)
+            return;
+
+        // swap in the finished map
+        m_iFront = 1 - m_iFront;
+        m_bQueued = false;
+        ++m_uUpdates;
+    }
+
+    QueueJob(sources);
+
+    // no worker: build the map now
+    if(!m_hThread)
+    {
+        RunJob();
+        m_iFront = 1 - m_iFront;
+        m_bQueued = false;
+        ++m_uUpdates;
+    }
+}
+
+/**
+* Fills the job and wakes the worker (worker idle)
+*/
+void InfluenceMap::QueueJob(const std::vector<InfluenceSource>& sources)
+{
+    m_job.sources = sources;
+    for(int layer = 0; layer < kInfluenceLayerCount; ++layer)
+        m_job.layers[layer] = m_layers[layer];
+    m_job.fElapsedTime = m_fPendingTime;
+    m_fPendingTime = 0.0f;
+
+    // map cells whose open fraction changed with the world
+    if( m_uWorldVersion != m_worldFile.GetVersion() )
+    {
+        std::vector<WorldFile::CellChange> changes;
+        if( m_worldFile.GetCellChanges(m_uWorldVersion, &changes) )
+        {
+            for(std::vector<WorldFile::CellChange>::iterator change = changes.begin(); change != changes.end(); ++change)
+                m_job.changedCells.push_back( (change->row / m_iCellSize) * m_iWidth + change->col / m_iCellSize );
+        }
+        else
+        {
+            m_job.bRebuildOpen = true;
+        }
+        m_uWorldVersion = m_worldFile.GetVersion();
+    }
+
+    m_bQueued = true;
+    if(m_hThread)
+    {
+        EnterCriticalSection(&m_lock);
+        m_bRunning = true;
+        LeaveCriticalSection(&m_lock);
+        SetEvent(m_hStartEvent);
+    }
+}
+
+/**
+* Returns a layer's influence at a grid position (0 outside the world)
+*/
+float InfluenceMap::GetInfluence(int iLayer, const D3DXVECTOR2& vPos) const
+{
+    int iRow = (int)floorf(vPos.y) / m_iCellSize;
+    int iCol = (int)floorf(vPos.x) / m_iCellSize;
+    if( vPos.x < 0.0f || vPos.y < 0.0f || iRow >= m_iHeight || iCol >= m_iWidth )
+        return 0.0f;
+
+    return GetFront(iLayer)[iRow * m_iWidth + iCol];
+}
+
+/**
+* Finds the highest scoring open map cell within the query radius, where
+* the score is the weighted sum of its layers plus a random jitter. Returns
+* the center of an empty world cell of that map cell (false, leaving the
+* destination unchanged, if there is none).
+*/
+bool InfluenceMap::FindDestination(const InfluenceQuery& query, D3DXVECTOR2* vDest) const
+{
+    float fRadius = query.fRadius / m_iCellSize;
+    float fRow = query.vPos.y / m_iCellSize;
+    float fCol = query.vPos.x / m_iCellSize;
+    int iRowMin = max(0, (int)floorf(fRow - fRadius));
+    int iRowMax = min(m_iHeight - 1, (int)floorf(fRow + fRadius));
+    int iColMin = max(0, (int)floorf(fCol - fRadius));
+    int iColMax = min(m_iWidth - 1, (int)floorf(fCol + fRadius));
+
+    const float* fOpen = GetFront(kInfluenceLayerCount);
+    int iBest = -1;
+    float fBestScore = -FLT_MAX;
+
+    for(int row = iRowMin; row <= iRowMax; ++row)
+    {
+        for(int col = iColMin; col <= iColMax; ++col)
+        {
+            // cells within the radius (by cell center) with empty world cells
+            float fDeltaRow = row + 0.5f - fRow;
+            float fDeltaCol = col + 0.5f - fCol;
+            int iCell = row * m_iWidth + col;
+            if( fDeltaRow*fDeltaRow + fDeltaCol*fDeltaCol > fRadius*fRadius || fOpen[iCell] == 0.0f )
+                continue;
+
+            float fScore = query.fJitter * rand() / RAND_MAX;
+            for(int layer = 0; layer < kInfluenceLayerCount; ++layer)
+            {
+                if( query.weights[layer] != 0.0f )
+                    fScore += query.weights[layer] * GetFront(layer)[iCell];
+            }
+
+            if( fScore > fBestScore )
+            {
+                fBestScore = fScore;
+                iBest = iCell;
+            }
+        }
+    }
+
+    return iBest != -1 && FindOpenCell(iBest / m_iWidth, iBest % m_iWidth, vDest);
+}
+
+/**
+* Returns the center of the empty world cell of a map cell nearest to its
+* center (false if the map cell has none).
+*/
+bool InfluenceMap::FindOpenCell(int iRow, int iCol, D3DXVECTOR2* vPos) const
+{
+    int iRowMin = iRow * m_iCellSize;
+    int iColMin = iCol * m_iCellSize;
+    int iRowMax = min(iRowMin + m_iCellSize, m_worldFile.GetHeight()) - 1;
+    int iColMax = min(iColMin + m_iCellSize, m_worldFile.GetWidth()) - 1;
+    float fCenterRow = 0.5f * (iRowMin + iRowMax + 1);
+    float fCenterCol = 0.5f * (iColMin + iColMax + 1);
+    float fBestDist = FLT_MAX;
+
+    for(int row = iRowMin; row <= iRowMax; ++row)
+    {
+        for(int col = iColMin; col <= iColMax; ++col)
+        {
+            if( m_worldFile(row, col) != WorldFile::EMPTY_CELL )
+                continue;
+
+            float fDeltaRow = row + 0.5f - fCenterRow;
+            float fDeltaCol = col + 0.5f - fCenterCol;
+            float fDist = fDeltaRow*fDeltaRow + fDeltaCol*fDeltaCol;
+            if( fDist < fBestDist )
+            {
+                fBestDist = fDist;
+                *vPos = D3DXVECTOR2(col + 0.5f, row + 0.5f);
+            }
+        }
+    }
+
+    return fBestDist != FLT_MAX;
+}
+
+/**
+* Worker thread entry point
+*/
+DWORD WINAPI InfluenceMap::ThreadProc(LPVOID lpParameter)
+{
+    InfluenceMap* map = static_cast<InfluenceMap*>(lpParameter);
+
+    for(;;)
+    {
+        WaitForSingleObject(map->m_hStartEvent, INFINITE);
+
+        EnterCriticalSection(&map->m_lock);
+        bool bShutdown = map->m_bShutdown;
+        LeaveCriticalSection(&map->m_lock);
+        if(bShutdown)
+            break;
+
+        map->RunJob();
+
+        EnterCriticalSection(&map->m_lock);
+        map->m_bRunning = false;
+        LeaveCriticalSection(&map->m_lock);
+    }
+
+    return 0;
+}
+
+/**
+* Builds the back buffer from the front buffer and the job (worker thread,
+* or the main thread without a worker):
+*
+* 1. Update the open fractions of changed map cells
+* 2. Seed each layer from its sources
+* 3. Spread the seeded influence with the layer kernel
+* 4. Keep the decayed earlier influence where it is stronger
+*/
+void InfluenceMap::RunJob()
+{
+    int iCells = m_iWidth * m_iHeight;
+    const std::vector<float>& front = m_buffers[m_iFront];
+    std::vector<float>& back = m_buffers[1 - m_iFront];
+
+    // open fractions
+    if(m_job.bRebuildOpen)
+    {
+        for(int cell = 0; cell < iCells; ++cell)
+            UpdateOpenCell(cell);
+    }
+    else
+    {
+        std::sort(m_job.changedCells.begin(), m_job.changedCells.end());
+        m_job.changedCells.erase( std::unique(m_job.changedCells.begin(), m_job.changedCells.end()), m_job.changedCells.end() );
+        for(std::vector<int>::iterator cell = m_job.changedCells.begin(); cell != m_job.changedCells.end(); ++cell)
+            UpdateOpenCell(*cell);
+    }
+    m_job.bRebuildOpen = false;
+    m_job.changedCells.clear();
+    std::copy(m_vOpen.begin(), m_vOpen.end(), back.begin() + kInfluenceLayerCount * iCells);
+
+    for(int layer = 0; layer < kInfluenceLayerCount; ++layer)
+    {
+        const InfluenceLayerDesc& desc = m_job.layers[layer];
+
+        // seed
+        std::fill(m_vSeed.begin(), m_vSeed.end(), 0.0f);
+        for(std::vector<InfluenceSource>::const_iterator source = m_job.sources.begin(); source != m_job.sources.end(); ++source)
+        {
+            if( source->iLayer != layer )
+                continue;
+
+            if( desc.seed == kInfluenceSeedSight )
+            {
+                SeedSight(*source);
+            }
+            else if( source->vPos.x >= 0.0f && source->vPos.y >= 0.0f )
+            {
+                int iRow = (int)source->vPos.y / m_iCellSize;
+                int iCol = (int)source->vPos.x / m_iCellSize;
+                if( iRow < m_iHeight && iCol < m_iWidth )
+                    m_vSeed[iRow * m_iWidth + iCol] += source->fValue;
+            }
+        }
+
+        // spread
+        if( desc.kernel == kInfluenceKernelFalloff )
+            SpreadFalloff(desc.fSpread);
+        else if( desc.kernel == kInfluenceKernelBlur )
+            SpreadBlur(desc.fSpread, desc.iPasses);
+
+        // decay
+        float fKeep = desc.fHalfLife > 0.0f ? powf(0.5f, m_job.fElapsedTime / desc.fHalfLife) : 0.0f;
+        const float* fFront = &front[layer * iCells];
+        float* fBack = &back[layer * iCells];
+        for(int cell = 0; cell < iCells; ++cell)
+            fBack[cell] = max(m_vSeed[cell], fFront[cell] * fKeep);
+    }
+}
+
+/**
+* Recomputes the fraction of empty world cells in a map cell
+*/
+void InfluenceMap::UpdateOpenCell(int iCell)
+{
+    int iRowMin = (iCell / m_iWidth) * m_iCellSize;
+    int iColMin = (iCell % m_iWidth) * m_iCellSize;
+    int iRowMax = min(iRowMin + m_iCellSize, m_worldFile.GetHeight()) - 1;
+    int iColMax = min(iColMin + m_iCellSize, m_worldFile.GetWidth()) - 1;
+    int iEmpty = 0;
+
+    for(int row = iRowMin; row <= iRowMax; ++row)
+    {
+        for(int col = iColMin; col <= iColMax; ++col)
+        {
+            if( m_worldFile(row, col) == WorldFile::EMPTY_CELL )
+                ++iEmpty;
+        }
+    }
+
+    m_vOpen[iCell] = (float)iEmpty / ((iRowMax - iRowMin + 1) * (iColMax - iColMin + 1));
+}
+
+/**
+* Seeds the map cells of the empty world cells in sight of a source, up to
+* its radius. Rays are cast around the source at most a world cell apart at
+* full range; each stops at the first non-empty world cell.
+*/
+void InfluenceMap::SeedSight(const InfluenceSource& source)
+{
+    int iRays = min(kMaxSightRays, max(8, (int)ceilf(2.0f * D3DX_PI * source.fRadius)));
+
+    for(int ray = 0; ray < iRays; ++ray)
+    {
+        float fAngle = 2.0f * D3DX_PI * ray / iRays;
+        GridRay sight(source.vPos, D3DXVECTOR2(cosf(fAngle), sinf(fAngle)), source.fRadius);
+
+        do
+        {
+            if( m_worldFile(sight.GetRow(), sight.GetCol()) != WorldFile::EMPTY_CELL )
+                break;
+
+            float& fCell = m_vSeed[(sight.GetRow() / m_iCellSize) * m_iWidth + sight.GetCol() / m_iCellSize];
+            fCell = max(fCell, source.fValue);
+        }
+        while( sight.Step() );
+    }
+}
+
+/**
+* Spreads the seed layer: each cell takes the strongest neighbor times the
+* falloff per cell (diagonals count as 1.41 cells), scaled by the cell's
+* open fraction so walls block it. Two sweeps (forward then backward) cover
+* every direction in open areas; influence reaching around walls is
+* underestimated, never overestimated.
+*/
+void InfluenceMap::SpreadFalloff(float fSpread)
+{
+    float fDiagonal = powf(fSpread, 1.41421356f);
+    float* fCell = &m_vSeed[0];
+    const float* fOpen = &m_vOpen[0];
+
+    // forward sweep (left and upper neighbors)
+    for(int row = 0; row < m_iHeight; ++row)
+    {
+        for(int col = 0; col < m_iWidth; ++col)
+        {
+            int i = row * m_iWidth + col;
+            float fBest = 0.0f;
+            if( col > 0 )
+                fBest = max(fBest, fCell[i-1] * fSpread);
+            if( row > 0 )
+            {
+                fBest = max(fBest, fCell[i-m_iWidth] * fSpread);
+                if( col > 0 )
+                    fBest = max(fBest, fCell[i-m_iWidth-1] * fDiagonal);
+                if( col < m_iWidth-1 )
+                    fBest = max(fBest, fCell[i-m_iWidth+1] * fDiagonal);
+            }
+            fCell[i] = max(fCell[i], fBest * fOpen[i]);
+        }
+    }
+
+    // backward sweep (right and lower neighbors)
+    for(int row = m_iHeight-1; row >= 0; --row)
+    {
+        for(int col = m_iWidth-1; col >= 0; --col)
+        {
+            int i = row * m_iWidth + col;
+            float fBest = 0.0f;
+            if( col < m_iWidth-1 )
+                fBest = max(fBest, fCell[i+1] * fSpread);
+            if( row < m_iHeight-1 )
+            {
+                fBest = max(fBest, fCell[i+m_iWidth] * fSpread);
+                if( col < m_iWidth-1 )
+                    fBest = max(fBest, fCell[i+m_iWidth+1] * fDiagonal);
+                if( col > 0 )
+                    fBest = max(fBest, fCell[i+m_iWidth-1] * fDiagonal);
+            }
+            fCell[i] = max(fCell[i], fBest * fOpen[i]);
+        }
+    }
+}
+
+/**
+* Blurs the seed layer: each pass gives every neighbor (horizontally, then
+* vertically) the spread weight of a cell. Cells are scaled by their open
+* fraction after each pass, so influence does not pass walls.
+*/
+void InfluenceMap::SpreadBlur(float fSpread, int iPasses)
+{
+    float fCenter = 1.0f - 2.0f * fSpread;
+    float* fCell = &m_vSeed[0];
+    float* fTemp = &m_vScratch[0];
+    const float* fOpen = &m_vOpen[0];
+
+    for(int pass = 0; pass < iPasses; ++pass)
+    {
+        // horizontal
+        for(int row = 0; row < m_iHeight; ++row)
+        {
+            for(int col = 0; col < m_iWidth; ++col)
+            {
+                int i = row * m_iWidth + col;
+                float fLeft = col > 0 ? fCell[i-1] : 0.0f;
+                float fRight = col < m_iWidth-1 ? fCell[i+1] : 0.0f;
+                fTemp[i] = fCenter * fCell[i] + fSpread * (fLeft + fRight);
+            }
+        }
+
+        // vertical
+        for(int row = 0; row < m_iHeight; ++row)
+        {
+            for(int col = 0; col < m_iWidth; ++col)
+            {
+                int i = row * m_iWidth + col;
+                float fUp = row > 0 ? fTemp[i-m_iWidth] : 0.0f;
+                float fDown = row < m_iHeight-1 ? fTemp[i+m_iWidth] : 0.0f;
+                fCell[i] = (fCenter * fTemp[i] + fSpread * (fUp + fDown)) * fOpen[i];
+            }
+        }
+    }
+}
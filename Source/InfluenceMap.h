@@ -0,0 +1,169 @@
+/*******************************************************************************
+* Game Development Project
+* InfluenceMap.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Multi-layer influence map updated on a worker thread
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "singleton.h"
+#include "WorldFile.h"
+
+/* influence layer */
+enum InfluenceLayer
+{
+    kInfluenceThreat,               // enemies (the player), lingering where last seen
+    kInfluenceOccupancy,            // NPC density
+    kInfluenceVisibility,           // cells in the player's sight
+    kInfluenceLayerCount
+};
+
+/* how sources are written into a layer */
+enum InfluenceSeed
+{
+    kInfluenceSeedPoint,            // value added at the source cell
+    kInfluenceSeedSight             // value on the cells in sight within the source radius
+};
+
+/* how a layer spreads from its seeded cells */
+enum InfluenceKernel
+{
+    kInfluenceKernelNone,           // seeded cells only
+    kInfluenceKernelFalloff,        // strongest neighbor times the spread per cell (non-negative values)
+    kInfluenceKernelBlur            // blur passes (spread is the weight of each neighbor)
+};
+
+/* layer configuration */
+struct InfluenceLayerDesc
+{
+    const char* szName;
+    InfluenceSeed seed;
+    InfluenceKernel kernel;
+    float fSpread;                  // falloff per cell, or blur neighbor weight (below 0.5)
+    int iPasses;                    // blur passes
+    float fHalfLife;                // seconds for earlier influence to halve (0 keeps none)
+};
+
+/* influence source (main thread) */
+struct InfluenceSource
+{
+    int iLayer;
+    D3DXVECTOR2 vPos;               // grid position
+    float fValue;
+    float fRadius;                  // sight range in cells (sight layers)
+};
+
+/* destination query: cells near a position scored by weighted layers */
+struct InfluenceQuery
+{
+    D3DXVECTOR2 vPos;               // search center (grid position)
+    float fRadius;                  // search radius (cells)
+    float weights[kInfluenceLayerCount];
+    float fJitter;                  // largest random score added per cell (breaks ties)
+};
+
+/**
+* Influence map with one float layer per InfluenceLayer, at a coarser
+* resolution than the world on large worlds (each map cell covers a square
+* of world cells). Every update seeds the layers from the sources, spreads
+* them with the layer's kernel (walls block the spread in proportion to the
+* world cells they fill), and keeps the earlier influence where it is
+* stronger, halved every half life.
+*
+* Updates run on a worker thread and are double-buffered: queries read the
+* last finished map while the worker builds the next one from it, and the
+* two are swapped by Update once the worker is done. Sources given while the
+* worker is busy are dropped; the elapsed time is carried to the next update.
+* The map is built on the main thread if the worker cannot be started.
+*/
+class InfluenceMap : public Singleton<InfluenceMap>
+{
+    public:
+
+        // constructor (iMaxSize: largest map width or height in cells)
+        InfluenceMap(const WorldFile& worldFile, int iMaxSize);
+        ~InfluenceMap();
+
+        // layers (changes apply from the next update)
+        const InfluenceLayerDesc& GetLayer(int iLayer) const { return m_layers[iLayer]; }
+        void SetLayer(int iLayer, const InfluenceLayerDesc& desc) { m_layers[iLayer] = desc; }
+        int FindLayer(const char* szName) const;
+
+        // update (main thread, once per frame)
+        void Update(const std::vector<InfluenceSource>& sources, float fElapsedTime);
+
+        // queries (main thread, last finished map)
+        float GetInfluence(int iLayer, const D3DXVECTOR2& vPos) const;
+        bool FindDestination(const InfluenceQuery& query, D3DXVECTOR2* vDest) const;
+
+        // map info
+        int GetCellSize() const { return m_iCellSize; }
+        int GetWidth() const { return m_iWidth; }
+        int GetHeight() const { return m_iHeight; }
+        unsigned int GetUpdateCount() const { return m_uUpdates; }
+
+    private:
+
+        /**
+        * Update job. Written by the main thread while the worker is idle and
+        * read by the worker only.
+        */
+        struct InfluenceJob
+        {
+            std::vector<InfluenceSource> sources;
+            InfluenceLayerDesc layers[kInfluenceLayerCount];
+            float fElapsedTime;             // seconds since the previous job
+            bool bRebuildOpen;              // recompute every open fraction
+            std::vector<int> changedCells;  // map cells with changed world cells
+        };
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iCellSize;                    // world cells per map cell side
+        int m_iWidth;                       // map cells per row
+        int m_iHeight;                      // map rows
+        unsigned int m_uWorldVersion;       // world version of the open fractions
+
+        // layers and buffers (each buffer holds the layers, then the open fractions)
+        InfluenceLayerDesc m_layers[kInfluenceLayerCount];
+        std::vector<float> m_buffers[2];
+        int m_iFront;                       // buffer read by queries
+        unsigned int m_uUpdates;            // maps finished
+        float m_fPendingTime;               // seconds not yet given to a job
+
+        // worker data
+        InfluenceJob m_job;
+        std::vector<float> m_vOpen;         // open fraction of each map cell
+        std::vector<float> m_vSeed;         // layer being built
+        std::vector<float> m_vScratch;      // blur pass
+
+        // worker thread
+        HANDLE m_hThread;                   // worker (null if updating on the main thread)
+        CRITICAL_SECTION m_lock;            // guards the running and shutdown flags
+        HANDLE m_hStartEvent;               // set when a job is ready
+        bool m_bRunning;                    // job in progress (cleared by the worker)
+        bool m_bShutdown;                   // worker exits when set
+        bool m_bQueued;                     // job queued and not yet swapped in (main thread)
+
+        // main thread methods
+        void QueueJob(const std::vector<InfluenceSource>& sources);
+        bool FindOpenCell(int iRow, int iCol, D3DXVECTOR2* vPos) const;
+        const float* GetFront(int iLayer) const { return &m_buffers[m_iFront][iLayer * m_iWidth * m_iHeight]; }
+
+        // worker methods
+        static DWORD WINAPI ThreadProc(LPVOID lpParameter);
+        void RunJob();
+        void UpdateOpenCell(int iCell);
+        void SeedSight(const InfluenceSource& source);
+        void SpreadFalloff(float fSpread);
+        void SpreadBlur(float fSpread, int iPasses);
+
+        // prevent copy and assignment
+        InfluenceMap(const InfluenceMap&);
+        InfluenceMap& operator=(const InfluenceMap&);
+};
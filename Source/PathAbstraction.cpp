@@ -0,0 +1,482 @@
+/*******************************************************************************
+* Game Development Project
+* PathAbstraction.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Hierarchical (HPA*) path abstraction of the world grid
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathAbstraction.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <utility>
+
+// border runs at least this wide get an entrance at each end
+static const int kMaxEntranceWidth = 6;
+
+// movement costs between neighboring cell centers
+static const float kCardinalCost = 1.0f;
+static const float kDiagonalCost = 1.41421356f;
+
+/**
+* Constructor
+*/
+PathAbstraction::PathAbstraction(const WorldFile& worldFile, int iClusterSize, bool bAllPaths) :
+    m_worldFile(worldFile),
+    m_iClusterSize(iClusterSize),
+    m_iClusterRows((worldFile.GetHeight() + iClusterSize - 1) / iClusterSize),
+    m_iClusterCols((worldFile.GetWidth() + iClusterSize - 1) / iClusterSize),
+    m_bAllPaths(bAllPaths)
+{}
+
+/**
+* Deconstructor
+*/
+PathAbstraction::~PathAbstraction()
+{}
+
+/**
+* Builds the abstract graph: finds the entrances along every cluster border,
+* then connects the entrances within each cluster. The search is used for
+* the in-cluster distances.
+*/
+void PathAbstraction::Build(PathSearch* search)
+{
+    m_vNodes.clear();
+    m_vClusterNodes.assign(m_iClusterRows * m_iClusterCols, std::vector<int>());
+
+    for(int cRow = 0; cRow < m_iClusterRows; ++cRow)
+    {
+        for(int cCol = 0; cCol < m_iClusterCols; ++cCol)
+        {
+            int iRow = cRow * m_iClusterSize;
+            int iCol = cCol * m_iClusterSize;
+            int iHeight = __min(m_iClusterSize, m_worldFile.GetHeight() - iRow);
+            int iWidth = __min(m_iClusterSize, m_worldFile.GetWidth() - iCol);
+
+            // border with the next cluster column (walk down the last column)
+            if( cCol + 1 < m_iClusterCols )
+                AddEntrances(iRow, iCol + m_iClusterSize - 1, 1, 0, iHeight);
+
+            // border with the next cluster row (walk along the last row)
+            if( cRow + 1 < m_iClusterRows )
+                AddEntrances(iRow + m_iClusterSize - 1, iCol, 0, 1, iWidth);
+        }
+    }
+
+    // intra cluster edges
+    for(int iCluster = 0; iCluster < (int)m_vClusterNodes.size(); ++iCluster)
+    {
+        ConnectCluster(search, iCluster);
+    }
+}
+
+/**
+* Returns true if the cells are far enough apart (not in the same or
+* neighboring clusters) to be searched on the abstract graph, or if every
+* path is.
+*/
+bool PathAbstraction::IsLongPath(const PathNodeKey& nkStart, const PathNodeKey& nkDest) const
+{
+    if( GetCluster(nkStart) == -1 || GetCluster(nkDest) == -1 )
+        return false;
+
+    if( m_bAllPaths )
+        return true;
+
+    int iRowDiff = abs(nkStart.iRow / m_iClusterSize - nkDest.iRow / m_iClusterSize);
+    int iColDiff = abs(nkStart.iCol / m_iClusterSize - nkDest.iCol / m_iClusterSize);
+    return (iRowDiff >= 2 || iColDiff >= 2);
+}
+
+/**
+* Starts a hierarchical path: finds the abstract path and refines it through
+* the start cluster. The node list holds the start cell followed by the
+* refined cells; the rest of the path is refined with RefineNext().
+*/
+PathSearch::SearchResult PathAbstraction::BeginPath(PathSearch* search, const PathNodeKey& nkStart, const PathNodeKey& nkDest, const PathSearchOptions& options, AbstractPath* path, PathNodeList* nodeList) const
+{
+    nodeList->clear();
+
+    PathNodeList refined;
+    if( !FindAbstractPath(search, nkStart, nkDest, path) || !RefineNext(search, options, path, &refined) )
+        return PathSearch::kSearchNoPath;
+
+    nodeList->push_back(nkStart);
+    nodeList->insert(nodeList->end(), refined.begin(), refined.end());
+    return PathSearch::kSearchComplete;
+}
+
+/**
+* Finds the abstract path from the start to the destination. The start and
+* destination are temporarily connected to the entrances of their clusters.
+* Returns false if no path exists.
+*/
+bool PathAbstraction::FindAbstractPath(PathSearch* search, const PathNodeKey& nkStart, const PathNodeKey& nkDest, AbstractPath* path) const
+{
+    path->nodes.clear();
+    path->iNext = 0;
+
+    int iStartCluster = GetCluster(nkStart);
+    int iDestCluster = GetCluster(nkDest);
+    if( iStartCluster == -1 || iDestCluster == -1 )
+        return false;
+
+    // temporary start and destination nodes
+    int iStartNode = (int)m_vNodes.size();
+    int iDestNode = iStartNode + 1;
+
+    // connect start and destination to their cluster entrances
+    std::vector<float> vStartCosts;
+    std::vector<float> vDestCosts;
+    ComputeClusterCosts(search, nkStart, &vStartCosts);
+    float fDirectCost = (iStartCluster == iDestCluster) ? search->GetDistanceCost(nkDest) : -1.0f;
+    ComputeClusterCosts(search, nkDest, &vDestCosts);
+
+    std::vector<float> vToDest(iDestNode + 1, -1.0f);
+    const std::vector<int>& vDestClusterNodes = m_vClusterNodes[iDestCluster];
+    for(int i = 0; i < (int)vDestClusterNodes.size(); ++i)
+        vToDest[vDestClusterNodes[i]] = vDestCosts[i];
+    vToDest[iStartNode] = fDirectCost;
+
+    // A* over the abstract graph
+    typedef std::pair<float, int> OpenEntry;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+    std::vector<float> vCost(iDestNode + 1, -1.0f);
+    std::vector<int> vParent(iDestNode + 1, -1);
+    std::vector<char> vClosed(iDestNode + 1, 0);
+
+    vCost[iStartNode] = 0.0f;
+    open.push(OpenEntry(ComputeOctileCost(nkStart, nkDest), iStartNode));
+
+    while( !open.empty() )
+    {
+        int iNode = open.top().second;
+        open.pop();
+
+        if( vClosed[iNode] )
+            continue;
+        vClosed[iNode] = 1;
+
+        if( iNode == iDestNode )
+            break;
+
+        // gather successors
+        std::vector<AbstractEdge> vEdges;
+        if( iNode == iStartNode )
+        {
+            const std::vector<int>& vStartClusterNodes = m_vClusterNodes[iStartCluster];
+            for(int i = 0; i < (int)vStartClusterNodes.size(); ++i)
+            {
+                AbstractEdge edge = { vStartClusterNodes[i], vStartCosts[i] };
+                vEdges.push_back(edge);
+            }
+        }
+        else
+        {
+            vEdges = m_vNodes[iNode].vEdges;
+        }
+
+        if( vToDest[iNode] >= 0.0f )
+        {
+            AbstractEdge edge = { iDestNode, vToDest[iNode] };
+            vEdges.push_back(edge);
+        }
+
+        // relax successors
+        for(std::vector<AbstractEdge>::const_iterator edge = vEdges.begin(); edge != vEdges.end(); ++edge)
+        {
+            if( edge->fCost < 0.0f || vClosed[edge->iNode] )
+                continue;
+
+            float fCost = vCost[iNode] + edge->fCost;
+            if( vCost[edge->iNode] >= 0.0f && vCost[edge->iNode] <= fCost )
+                continue;
+
+            vCost[edge->iNode] = fCost;
+            vParent[edge->iNode] = iNode;
+
+            const PathNodeKey& key = (edge->iNode == iDestNode) ? nkDest : m_vNodes[edge->iNode].key;
+            open.push(OpenEntry(fCost + ComputeOctileCost(key, nkDest), edge->iNode));
+        }
+    }
+
+    // destination not reached
+    if( !vClosed[iDestNode] )
+        return false;
+
+    // collect abstract nodes from destination to start
+    for(int iNode = iDestNode; iNode != -1; iNode = vParent[iNode])
+    {
+        if( iNode == iDestNode )
+            path->nodes.push_back(nkDest);
+        else if( iNode == iStartNode )
+            path->nodes.push_back(nkStart);
+        else
+            path->nodes.push_back(m_vNodes[iNode].key);
+    }
+
+    std::reverse(path->nodes.begin(), path->nodes.end());
+    path->iNext = 1;
+    return true;
+}
+
+/**
+* Refines the abstract path through its current cluster: the in-cluster
+* segments are searched within the cluster bounds, followed by the step
+* across the border into the next cluster. The new cells (excluding the
+* already refined first cell) are returned in the node list. Returns false
+* if a segment can no longer be found.
+*/
+bool PathAbstraction::RefineNext(PathSearch* search, const PathSearchOptions& options, AbstractPath* path, PathNodeList* nodeList) const
+{
+    nodeList->clear();
+
+    if( path->IsRefined() )
+        return true;
+
+    const PathNodeList& nodes = path->nodes;
+    int i = path->iNext - 1;
+    int iCluster = GetCluster(nodes[i]);
+
+    // in-cluster segments
+    while( i + 1 < (int)nodes.size() && GetCluster(nodes[i + 1]) == iCluster )
+    {
+        SetClusterBounds(search, iCluster);
+        search->Begin(nodes[i], nodes[i + 1], options);
+        while( search->Step(m_iClusterSize * m_iClusterSize) == PathSearch::kSearchInProgress )
+        {
+        }
+        search->ClearBounds();
+
+        if( search->GetResult() != PathSearch::kSearchComplete )
+            return false;
+
+        PathNodeList segment;
+        search->GetPath(&segment);
+        nodeList->insert(nodeList->end(), segment.begin() + 1, segment.end());
+        ++i;
+    }
+
+    // step across the border
+    if( i + 1 < (int)nodes.size() )
+    {
+        nodeList->push_back(nodes[i + 1]);
+        ++i;
+    }
+
+    path->iNext = i + 1;
+    return true;
+}
+
+/**
+* Returns the cluster containing the cell, or -1 if outside the grid
+*/
+int PathAbstraction::GetCluster(const PathNodeKey& key) const
+{
+    if( key.iCol >= m_worldFile.GetWidth() || key.iCol < 0 || key.iRow >= m_worldFile.GetHeight() || key.iRow < 0 )
+        return -1;
+
+    return (key.iRow / m_iClusterSize) * m_iClusterCols + key.iCol / m_iClusterSize;
+}
+
+/**
+* Restricts the search to the cells of a cluster
+*/
+void PathAbstraction::SetClusterBounds(PathSearch* search, int iCluster) const
+{
+    PathNodeKey nkMin;
+    nkMin.iRow = (iCluster / m_iClusterCols) * m_iClusterSize;
+    nkMin.iCol = (iCluster % m_iClusterCols) * m_iClusterSize;
+
+    PathNodeKey nkMax;
+    nkMax.iRow = __min(nkMin.iRow + m_iClusterSize, m_worldFile.GetHeight()) - 1;
+    nkMax.iCol = __min(nkMin.iCol + m_iClusterSize, m_worldFile.GetWidth()) - 1;
+
+    search->SetBounds(nkMin, nkMax);
+}
+
+/**
+* Checks if the cell can be entered
+*/
+bool PathAbstraction::IsOpenCell(int iRow, int iCol) const
+{
+    if( iCol >= m_worldFile.GetWidth() || iCol < 0 || iRow >= m_worldFile.GetHeight() || iRow < 0 )
+        return false;
+
+    return m_worldFile(iRow, iCol) != WorldFile::OCCUPIED_CELL;
+}
+
+/**
+* Adds the entrances along a cluster border. The border is walked from the
+* cell in the specified direction; each cell crosses the border to the cell
+* on its right (walking down) or below it (walking across).
+*/
+void PathAbstraction::AddEntrances(int iRow, int iCol, int dRow, int dCol, int iLength)
+{
+    // border crossing direction
+    int crossRow = dCol;
+    int crossCol = dRow;
+
+    int iRunStart = -1;
+    for(int i = 0; i <= iLength; ++i)
+    {
+        int r = iRow + i * dRow;
+        int c = iCol + i * dCol;
+        bool bOpen = (i < iLength) && IsOpenCell(r, c) && IsOpenCell(r + crossRow, c + crossCol);
+
+        // start of an open run
+        if( bOpen && iRunStart == -1 )
+        {
+            iRunStart = i;
+        }
+
+        // end of an open run, add transitions
+        else if( !bOpen && iRunStart != -1 )
+        {
+            int iRunEnd = i - 1;
+
+            if( iRunEnd - iRunStart + 1 < kMaxEntranceWidth )
+            {
+                int iMid = (iRunStart + iRunEnd) / 2;
+                AddTransition(iRow + iMid * dRow, iCol + iMid * dCol, crossRow, crossCol);
+            }
+            else
+            {
+                AddTransition(iRow + iRunStart * dRow, iCol + iRunStart * dCol, crossRow, crossCol);
+                AddTransition(iRow + iRunEnd * dRow, iCol + iRunEnd * dCol, crossRow, crossCol);
+            }
+
+            iRunStart = -1;
+        }
+    }
+}
+
+/**
+* Adds the entrance nodes on both sides of a border crossing
+*/
+void PathAbstraction::AddTransition(int iRow, int iCol, int dRow, int dCol)
+{
+    int iNodeA = AddNode(iRow, iCol);
+    int iNodeB = AddNode(iRow + dRow, iCol + dCol);
+    AddEdge(iNodeA, iNodeB, kCardinalCost);
+}
+
+/**
+* Returns the entrance node for the cell, creating it if needed
+*/
+int PathAbstraction::AddNode(int iRow, int iCol)
+{
+    PathNodeKey key;
+    key.iRow = iRow;
+    key.iCol = iCol;
+
+    // existing entrance
+    std::vector<int>& vClusterNodes = m_vClusterNodes[GetCluster(key)];
+    for(std::vector<int>::iterator node = vClusterNodes.begin(); node != vClusterNodes.end(); ++node)
+    {
+        if( m_vNodes[*node].key.iRow == iRow && m_vNodes[*node].key.iCol == iCol )
+            return *node;
+    }
+
+    // new entrance
+    AbstractNode node;
+    node.key = key;
+    node.iCluster = GetCluster(key);
+    m_vNodes.push_back(node);
+
+    vClusterNodes.push_back((int)m_vNodes.size() - 1);
+    return (int)m_vNodes.size() - 1;
+}
+
+/**
+* Adds an undirected edge
+*/
+void PathAbstraction::AddEdge(int iNodeA, int iNodeB, float fCost)
+{
+    AbstractEdge edge;
+    edge.fCost = fCost;
+
+    edge.iNode = iNodeB;
+    m_vNodes[iNodeA].vEdges.push_back(edge);
+
+    edge.iNode = iNodeA;
+    m_vNodes[iNodeB].vEdges.push_back(edge);
+}
+
+/**
+* Connects every pair of entrances in a cluster that can reach each other
+* without leaving the cluster.
+*/
+void PathAbstraction::ConnectCluster(PathSearch* search, int iCluster)
+{
+    const std::vector<int>& vClusterNodes = m_vClusterNodes[iCluster];
+
+    for(int i = 0; i < (int)vClusterNodes.size(); ++i)
+    {
+        std::vector<float> vCosts;
+        ComputeClusterCosts(search, m_vNodes[vClusterNodes[i]].key, &vCosts);
+
+        for(int j = i + 1; j < (int)vClusterNodes.size(); ++j)
+        {
+            if( vCosts[j] >= 0.0f )
+                AddEdge(vClusterNodes[i], vClusterNodes[j], vCosts[j]);
+        }
+    }
+}
+
+/**
+* Computes the in-cluster distance from the cell to each entrance of its
+* cluster (-1 if unreachable). The search is left holding the distances to
+* every cell of the cluster.
+*/
+void PathAbstraction::ComputeClusterCosts(PathSearch* search, const PathNodeKey& key, std::vector<float>* vCosts) const
+{
+    int iCluster = GetCluster(key);
+    const std::vector<int>& vClusterNodes = m_vClusterNodes[iCluster];
+
+    // search the whole cluster (no destination)
+    PathSearchOptions options;
+    options.bHeuristicCalc = true;
+    options.fHeuristicWeight = 1.0f;
+    options.bJumpPoint = false;
+    options.bRubberband = false;
+    options.bAnyAngle = false;
+    options.pLandmarks = NULL;
+
+    PathNodeKey nkNone;
+    nkNone.iRow = -1;
+    nkNone.iCol = -1;
+
+    SetClusterBounds(search, iCluster);
+    search->Begin(key, nkNone, options);
+    while( search->Step(m_iClusterSize * m_iClusterSize) == PathSearch::kSearchInProgress )
+    {
+    }
+    search->ClearBounds();
+
+    vCosts->resize(vClusterNodes.size());
+    for(int i = 0; i < (int)vClusterNodes.size(); ++i)
+    {
+        (*vCosts)[i] = search->GetDistanceCost(m_vNodes[vClusterNodes[i]].key);
+    }
+}
+
+/**
+* Compute cardinal/intercardinal distance between two cells
+*/
+float PathAbstraction::ComputeOctileCost(const PathNodeKey& nkA, const PathNodeKey& nkB) const
+{
+    float xDiff = (float)abs(nkA.iCol - nkB.iCol);
+    float yDiff = (float)abs(nkA.iRow - nkB.iRow);
+
+    float fMin = (xDiff < yDiff) ? xDiff : yDiff;
+    float fMax = (xDiff < yDiff) ? yDiff : xDiff;
+    return fMin * kDiagonalCost + fMax - fMin;
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Game Development Project
+* PathAbstraction.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Hierarchical (HPA*) path abstraction of the world grid
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "PathSearch.h"
+
+/**
+* Abstract path through the cluster graph. Nodes are grid cells from the start
+* to the destination; consecutive nodes are either in the same cluster or are
+* adjacent cells across a cluster border.
+*/
+struct AbstractPath
+{
+    PathNodeList nodes;     // abstract nodes (start, entrances, destination)
+    int iNext;              // next abstract node to refine towards
+
+    bool IsRefined() const { return iNext >= (int)nodes.size(); }
+};
+
+/**
+* Cluster/entrance abstraction of a WorldFile grid. The grid is divided into
+* square clusters; each open run of cells along a cluster border creates one
+* or two entrances, and entrances within a cluster are connected by their
+* shortest in-cluster distance. Long paths are found on this graph and then
+* refined into grid cells one cluster at a time.
+*
+* The graph is read-only after Build(), so queries may run concurrently as
+* long as each caller supplies its own PathSearch.
+*
+* Every search it runs is bounded to one cluster, so a PathSearch with a
+* cluster sized window is enough. Grids too large to search directly may
+* route all paths through the graph.
+*/
+class PathAbstraction
+{
+    public:
+
+        // constructor
+        PathAbstraction(const WorldFile& worldFile, int iClusterSize, bool bAllPaths = false);
+        ~PathAbstraction();
+
+        // abstraction
+        void Build(PathSearch* search);
+        bool IsLongPath(const PathNodeKey& nkStart, const PathNodeKey& nkDest) const;
+
+        // paths
+        PathSearch::SearchResult BeginPath(PathSearch* search, const PathNodeKey& nkStart, const PathNodeKey& nkDest, const PathSearchOptions& options, AbstractPath* path, PathNodeList* nodeList) const;
+        bool FindAbstractPath(PathSearch* search, const PathNodeKey& nkStart, const PathNodeKey& nkDest, AbstractPath* path) const;
+        bool RefineNext(PathSearch* search, const PathSearchOptions& options, AbstractPath* path, PathNodeList* nodeList) const;
+
+        // abstraction info
+        int GetClusterSize() const { return m_iClusterSize; }
+        int GetNodeCount() const { return (int)m_vNodes.size(); }
+
+    private:
+
+        /**
+        * Abstract graph edge
+        */
+        struct AbstractEdge
+        {
+            int iNode;              // target abstract node
+            float fCost;            // grid distance
+        };
+
+        /**
+        * Abstract graph node (entrance cell)
+        */
+        struct AbstractNode
+        {
+            PathNodeKey key;                    // entrance cell
+            int iCluster;                       // owning cluster
+            std::vector<AbstractEdge> vEdges;   // inter and intra cluster edges
+        };
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iClusterSize;
+        int m_iClusterRows;
+        int m_iClusterCols;
+        bool m_bAllPaths;       // every path is searched on the graph
+
+        // abstract graph
+        std::vector<AbstractNode> m_vNodes;                 // entrance nodes
+        std::vector<std::vector<int> > m_vClusterNodes;     // entrance nodes in each cluster
+
+        // cluster methods
+        int GetCluster(const PathNodeKey& key) const;
+        void SetClusterBounds(PathSearch* search, int iCluster) const;
+        bool IsOpenCell(int iRow, int iCol) const;
+
+        // build methods
+        void AddEntrances(int iRow, int iCol, int dRow, int dCol, int iLength);
+        void AddTransition(int iRow, int iCol, int dRow, int dCol);
+        int AddNode(int iRow, int iCol);
+        void AddEdge(int iNodeA, int iNodeB, float fCost);
+        void ConnectCluster(PathSearch* search, int iCluster);
+
+        // search methods
+        void ComputeClusterCosts(PathSearch* search, const PathNodeKey& key, std::vector<float>* vCosts) const;
+        float ComputeOctileCost(const PathNodeKey& nkA, const PathNodeKey& nkB) const;
+
+        // prevent copy and assignment
+        PathAbstraction(const PathAbstraction&);
+        PathAbstraction& operator=(const PathAbstraction&);
+};
@@ -0,0 +1,165 @@
+/*******************************************************************************
+* Game Development Project
+* PathLandmarks.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Landmark (ALT) heuristic tables
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathLandmarks.h"
+#include "FlowField.h"
+#include <float.h>
+#include <malloc.h>
+#include <math.h>
+
+#ifdef PATH_LANDMARKS_SSE
+#include <xmmintrin.h>
+#endif
+
+/**
+* Constructor
+*/
+PathLandmarks::PathLandmarks(const WorldFile& worldFile, int iLandmarkCount) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_iLandmarkCount(iLandmarkCount),
+    m_iStride((iLandmarkCount + 3) & ~3),
+    m_pDistances(NULL)
+{}
+
+/**
+* Deconstructor
+*/
+PathLandmarks::~PathLandmarks()
+{
+    _aligned_free(m_pDistances);
+}
+
+/**
+* Picks the landmarks and fills the distance tables. Each landmark is the
+* reachable cell farthest from all landmarks picked so far (the first is the
+* cell farthest from the first open cell), which spreads landmarks to the
+* ends of corridors where they give the best estimates.
+*/
+void PathLandmarks::Build()
+{
+    int iCellCount = m_iWidth * m_iHeight;
+
+    _aligned_free(m_pDistances);
+    m_pDistances = (float*)_aligned_malloc(sizeof(float) * m_iStride * iCellCount, 16);
+    m_vLandmarks.clear();
+
+    // padding (and missing landmarks) contribute no estimate
+    for(int i = 0; i < m_iStride * iCellCount; ++i)
+        m_pDistances[i] = 0.0f;
+
+    // seed cell
+    PathNodeKey nkSeed;
+    nkSeed.iRow = -1;
+    nkSeed.iCol = -1;
+    for(int iCell = 0; iCell < iCellCount && nkSeed.iRow == -1; ++iCell)
+    {
+        if( m_worldFile(iCell / m_iWidth, iCell % m_iWidth) != WorldFile::OCCUPIED_CELL )
+        {
+            nkSeed.iRow = iCell / m_iWidth;
+            nkSeed.iCol = iCell % m_iWidth;
+        }
+    }
+
+    if( nkSeed.iRow == -1 )
+        return;
+
+    // distance from the nearest landmark (multi-source distance)
+    FlowField field(m_worldFile);
+    field.SetGoal(nkSeed);
+
+    std::vector<float> vNearest(iCellCount);
+    for(int iCell = 0; iCell < iCellCount; ++iCell)
+    {
+        PathNodeKey key;
+        key.iRow = iCell / m_iWidth;
+        key.iCol = iCell % m_iWidth;
+        vNearest[iCell] = field.GetCost(key);
+    }
+
+    for(int k = 0; k < m_iLandmarkCount; ++k)
+    {
+        // farthest reachable cell
+        int iFarthest = -1;
+        for(int iCell = 0; iCell < iCellCount; ++iCell)
+        {
+            if( vNearest[iCell] != FLT_MAX && vNearest[iCell] > 0.0f && (iFarthest == -1 || vNearest[iCell] > vNearest[iFarthest]) )
+                iFarthest = iCell;
+        }
+
+        if( iFarthest == -1 )
+            break;
+
+        PathNodeKey nkLandmark;
+        nkLandmark.iRow = iFarthest / m_iWidth;
+        nkLandmark.iCol = iFarthest % m_iWidth;
+        m_vLandmarks.push_back(nkLandmark);
+
+        // landmark distance table
+        field.SetGoal(nkLandmark);
+        for(int iCell = 0; iCell < iCellCount; ++iCell)
+        {
+            PathNodeKey key;
+            key.iRow = iCell / m_iWidth;
+            key.iCol = iCell % m_iWidth;
+
+            float fCost = field.GetCost(key);
+            m_pDistances[iCell * m_iStride + k] = fCost;
+
+            if( k == 0 || fCost < vNearest[iCell] )
+                vNearest[iCell] = fCost;
+        }
+    }
+}
+
+/**
+* Computes the landmark lower bound of the distance between two cells. Cells
+* that cannot reach a landmark have no estimate from it, and a cell that can
+* reach a landmark the destination cannot, cannot reach the destination.
+*/
+float PathLandmarks::ComputeHeuristicCost(int iCell, int iDest) const
+{
+    if( !m_pDistances )
+        return 0.0f;
+
+    const float* pCell = m_pDistances + iCell * m_iStride;
+    const float* pDest = m_pDistances + iDest * m_iStride;
+
+#ifdef PATH_LANDMARKS_SSE
+    const __m128 vSignMask = _mm_set1_ps(-0.0f);
+    __m128 vMax = _mm_setzero_ps();
+
+    for(int i = 0; i < m_iStride; i += 4)
+    {
+        __m128 vDiff = _mm_sub_ps(_mm_load_ps(pCell + i), _mm_load_ps(pDest + i));
+        vMax = _mm_max_ps(vMax, _mm_andnot_ps(vSignMask, vDiff));
+    }
+
+    // horizontal max
+    vMax = _mm_max_ps(vMax, _mm_movehl_ps(vMax, vMax));
+    vMax = _mm_max_ss(vMax, _mm_shuffle_ps(vMax, vMax, 1));
+
+    float fMax;
+    _mm_store_ss(&fMax, vMax);
+    return fMax;
+#else
+    float fMax = 0.0f;
+    for(int i = 0; i < m_iStride; ++i)
+    {
+        float fDiff = fabs(pCell[i] - pDest[i]);
+        if( fDiff > fMax )
+            fMax = fDiff;
+    }
+    return fMax;
+#endif
+}
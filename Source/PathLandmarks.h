@@ -0,0 +1,64 @@
+/*******************************************************************************
+* Game Development Project
+* PathLandmarks.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Landmark (ALT) heuristic tables
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "PathSearch.h"
+
+// SSE table lookups where available
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define PATH_LANDMARKS_SSE
+#endif
+
+/**
+* Landmark distance tables for the ALT heuristic. Landmarks are picked
+* farthest-first at load time and the grid distance from every landmark to
+* every cell is stored. By the triangle inequality |d(L,a) - d(L,b)| never
+* overestimates d(a,b), so the largest difference over all landmarks is an
+* admissible heuristic that follows walls, unlike octile distance.
+*
+* Tables are cell-major: the distances of a cell to every landmark are
+* contiguous, padded to a multiple of four and 16 byte aligned, so a lookup
+* is a few aligned SSE loads per cell.
+*/
+class PathLandmarks
+{
+    public:
+
+        // constructor
+        PathLandmarks(const WorldFile& worldFile, int iLandmarkCount);
+        ~PathLandmarks();
+
+        // tables
+        void Build();
+        float ComputeHeuristicCost(int iCell, int iDest) const;
+
+        // landmark info
+        int GetLandmarkCount() const { return (int)m_vLandmarks.size(); }
+        const PathNodeKey& GetLandmark(int i) const { return m_vLandmarks[i]; }
+
+    private:
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+
+        // tables
+        int m_iLandmarkCount;                   // landmarks requested
+        int m_iStride;                          // floats per cell (multiple of 4)
+        float* m_pDistances;                    // landmark distances per cell (aligned)
+        std::vector<PathNodeKey> m_vLandmarks;  // landmark cells
+
+        // prevent copy and assignment
+        PathLandmarks(const PathLandmarks&);
+        PathLandmarks& operator=(const PathLandmarks&);
+};
@@ -0,0 +1,147 @@
+/*******************************************************************************
+* Game Development Project
+* PathOccupancy.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Occupancy bitset and grid line of sight
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathOccupancy.h"
+#include <stdlib.h>
+#include <algorithm>
+
+/**
+* Constructor
+*/
+PathOccupancy::PathOccupancy(const WorldFile& worldFile, int iWindowSize) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_uVersion(worldFile.GetVersion() - 1),
+    m_iOriginRow(0),
+    m_iOriginCol(0),
+    m_iRows(worldFile.GetHeight()),
+    m_iCols(worldFile.GetWidth())
+{
+    // window smaller than the grid
+    if( iWindowSize > 0 )
+    {
+        m_iRows = std::min(iWindowSize, m_iHeight);
+        m_iCols = std::min(iWindowSize, m_iWidth);
+    }
+
+    m_iStride = (m_iCols + 31) / 32;
+    Update();
+}
+
+/**
+* Deconstructor
+*/
+PathOccupancy::~PathOccupancy()
+{}
+
+/**
+* Rebuilds the bits if the world changed or the window origin moved since
+* they were built. The origin is ignored without a window.
+*/
+void PathOccupancy::Update(int iOriginRow, int iOriginCol)
+{
+    // keep the window inside the grid
+    iOriginRow = std::max(0, std::min(iOriginRow, m_iHeight - m_iRows));
+    iOriginCol = std::max(0, std::min(iOriginCol, m_iWidth - m_iCols));
+
+    if( m_uVersion == m_worldFile.GetVersion() && m_iOriginRow == iOriginRow && m_iOriginCol == iOriginCol )
+        return;
+
+    m_uVersion = m_worldFile.GetVersion();
+    m_iOriginRow = iOriginRow;
+    m_iOriginCol = iOriginCol;
+    m_vBits.assign(m_iStride * m_iRows, 0);
+
+    for(int iRow = 0; iRow < m_iRows; ++iRow)
+    {
+        unsigned int* pRow = &m_vBits[iRow * m_iStride];
+        for(int iCol = 0; iCol < m_iCols; ++iCol)
+        {
+            if( m_worldFile(m_iOriginRow + iRow, m_iOriginCol + iCol) == WorldFile::OCCUPIED_CELL )
+                pRow[iCol >> 5] |= 1u << (iCol & 31);
+        }
+    }
+}
+
+/**
+* Checks if the cell is a wall or outside the grid (or window)
+*/
+bool PathOccupancy::IsBlocked(int iRow, int iCol) const
+{
+    iRow -= m_iOriginRow;
+    iCol -= m_iOriginCol;
+    if( iCol >= m_iCols || iCol < 0 || iRow >= m_iRows || iRow < 0 )
+        return true;
+
+    return (m_vBits[iRow * m_iStride + (iCol >> 5)] >> (iCol & 31)) & 1;
+}
+
+/**
+* Checks if the segment between two cell centers only touches open cells.
+* The segment is walked one cell boundary at a time; comparing the distance
+* to the next column and row boundary is done in integers, so corner
+* crossings are detected exactly.
+*/
+bool PathOccupancy::HasLineOfSight(int iRow0, int iCol0, int iRow1, int iCol1) const
+{
+    int iColDiff = abs(iCol1 - iCol0);
+    int iRowDiff = abs(iRow1 - iRow0);
+    int dCol = (iCol1 > iCol0) ? 1 : -1;
+    int dRow = (iRow1 > iRow0) ? 1 : -1;
+
+    int iRow = iRow0;
+    int iCol = iCol0;
+    if( IsBlocked(iRow, iCol) )
+        return false;
+
+    // boundaries crossed so far along each axis
+    int iColSteps = 0;
+    int iRowSteps = 0;
+    while( iColSteps < iColDiff || iRowSteps < iRowDiff )
+    {
+        // next column boundary at (0.5 + iColSteps) / iColDiff of the segment, next row boundary
+        // at (0.5 + iRowSteps) / iRowDiff; compare cross multiplied
+        int iDecision = (1 + 2 * iColSteps) * iRowDiff - (1 + 2 * iRowSteps) * iColDiff;
+
+        // through a corner: both cells beside it must be open
+        if( iDecision == 0 )
+        {
+            if( IsBlocked(iRow, iCol + dCol) || IsBlocked(iRow + dRow, iCol) )
+                return false;
+
+            iCol += dCol;
+            iRow += dRow;
+            ++iColSteps;
+            ++iRowSteps;
+        }
+
+        // column boundary first
+        else if( iDecision < 0 )
+        {
+            iCol += dCol;
+            ++iColSteps;
+        }
+
+        // row boundary first
+        else
+        {
+            iRow += dRow;
+            ++iRowSteps;
+        }
+
+        if( IsBlocked(iRow, iCol) )
+            return false;
+    }
+
+    return true;
+}
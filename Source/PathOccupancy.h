@@ -0,0 +1,62 @@
+/*******************************************************************************
+* Game Development Project
+* PathOccupancy.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Occupancy bitset and grid line of sight
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "WorldFile.h"
+
+/**
+* One bit per cell copy of the world walls (rows padded to 32 bit words),
+* rebuilt only when the world version changes. Cells outside the grid are
+* blocked.
+*
+* A window size limits the bits to a square of cells placed by Update, so
+* the memory does not grow with the world; cells outside the window are
+* blocked, and moving the window rebuilds the bits.
+*
+* Line of sight walks every cell touched by the segment between two cell
+* centers (supercover DDA), so the cost is the segment length in cells. A
+* segment passing exactly through a cell corner needs both cells beside the
+* corner open, matching the rule that diagonal moves may not cut corners.
+*/
+class PathOccupancy
+{
+    public:
+
+        // constructor
+        PathOccupancy(const WorldFile& worldFile, int iWindowSize = 0);
+        ~PathOccupancy();
+
+        // occupancy
+        void Update(int iOriginRow = 0, int iOriginCol = 0);
+        bool IsBlocked(int iRow, int iCol) const;
+        bool HasLineOfSight(int iRow0, int iCol0, int iRow1, int iCol1) const;
+
+    private:
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+        unsigned int m_uVersion;            // world version of the bits
+
+        // bits
+        int m_iOriginRow;                   // first row of the bits
+        int m_iOriginCol;                   // first column of the bits
+        int m_iRows;                        // rows of the bits (window or grid)
+        int m_iCols;                        // columns of the bits (window or grid)
+        int m_iStride;                      // words per row
+        std::vector<unsigned int> m_vBits;  // blocked bits (row-major)
+
+        // prevent copy and assignment
+        PathOccupancy(const PathOccupancy&);
+        PathOccupancy& operator=(const PathOccupancy&);
+};
@@ -0,0 +1,873 @@
+/*******************************************************************************
+* Game Development Project
+* PathSearch.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* A* path search over the world grid
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathSearch.h"
+#include "PathLandmarks.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// movement costs between neighboring cell centers
+static const float kCardinalCost = 1.0f;
+static const float kDiagonalCost = 1.41421356f;
+
+/**
+* Constructor
+*/
+PathSearch::PathSearch(const WorldFile& worldFile, int iWindowSize) :
+    m_worldFile(worldFile),
+    m_iWidth(worldFile.GetWidth()),
+    m_iHeight(worldFile.GetHeight()),
+    m_iNodeRows(worldFile.GetHeight()),
+    m_iNodeCols(worldFile.GetWidth()),
+    m_occupancy(worldFile, iWindowSize),
+    m_uGeneration(0),
+    m_iStart(-1),
+    m_iDest(-1),
+    m_result(kSearchNoPath),
+    m_iExpanded(0)
+{
+    // default options
+    m_options.bHeuristicCalc = true;
+    m_options.fHeuristicWeight = 1.01f;
+    m_options.bJumpPoint = false;
+    m_options.bRubberband = true;
+    m_options.bAnyAngle = false;
+    m_options.pLandmarks = NULL;
+    ClearBounds();
+
+    // node window smaller than the grid
+    if( iWindowSize > 0 )
+    {
+        m_iNodeRows = std::min(iWindowSize, m_iHeight);
+        m_iNodeCols = std::min(iWindowSize, m_iWidth);
+    }
+
+    m_nkOrigin.iRow = 0;
+    m_nkOrigin.iCol = 0;
+    m_nkLimitMin = m_nkBoundsMin;
+    m_nkLimitMax = m_nkBoundsMax;
+
+    // allocate node grid (generation 0 is never used by a search)
+    NodeData data;
+    data.uGeneration = 0;
+    data.iParent = -1;
+    data.iHeapIndex = -1;
+    data.fDistanceCost = 0.0f;
+    data.fTotalCost = 0.0f;
+    data.bClosed = false;
+    data.bTarget = false;
+
+    m_vNodes.assign(m_iNodeRows * m_iNodeCols, data);
+    m_vOpenHeap.reserve(m_iNodeRows + m_iNodeCols);
+}
+
+/**
+* Deconstructor
+*/
+PathSearch::~PathSearch()
+{}
+
+/**
+* Starts a new search. All previous node data is invalidated by advancing the
+* search generation instead of clearing the node grid.
+*/
+void PathSearch::Begin(const PathNodeKey& nkStart, const PathNodeKey& nkDest, const PathSearchOptions& options)
+{
+    m_options = options;
+    PlaceWindow(nkStart, nkDest);
+    m_occupancy.Update(m_nkOrigin.iRow, m_nkOrigin.iCol);
+
+    // advance generation (reset stamps on wrap)
+    if(++m_uGeneration == 0)
+    {
+        for(std::vector<NodeData>::iterator it = m_vNodes.begin(); it != m_vNodes.end(); ++it)
+            it->uGeneration = 0;
+
+        m_uGeneration = 1;
+    }
+
+    // reset search state
+    m_vOpenHeap.clear();
+    m_iExpanded = 0;
+    m_vTargets.clear();
+    m_iStart = -1;
+    m_iDest = -1;
+    m_result = kSearchInProgress;
+
+    // destination may be outside the grid or window (search will exhaust)
+    if( IsInWindow(nkDest.iRow, nkDest.iCol) )
+        m_iDest = GetIndex(nkDest.iRow, nkDest.iCol);
+
+    // no start node if outside grid or window
+    if( !IsInWindow(nkStart.iRow, nkStart.iCol) )
+    {
+        m_result = kSearchNoPath;
+        return;
+    }
+
+    // create starting node
+    m_iStart = GetIndex(nkStart.iRow, nkStart.iCol);
+    UpdateNode(nkStart.iRow, nkStart.iCol, -1, 0.0f);
+}
+
+/**
+* Starts a reverse search from the goal that completes once every start is
+* reached (or the reachable area is exhausted). Paths are then read per start
+* with GetPathFrom. Jump points are not used, since the cells between jump
+* points are never closed.
+*/
+void PathSearch::BeginReverse(const PathNodeKey& nkGoal, const PathNodeList& starts, const PathSearchOptions& options)
+{
+    PathSearchOptions reverseOptions = options;
+    reverseOptions.bJumpPoint = false;
+
+    // search from the goal without a destination
+    PathNodeKey nkNone;
+    nkNone.iRow = -1;
+    nkNone.iCol = -1;
+    Begin(nkGoal, nkNone, reverseOptions);
+
+    if( m_result != kSearchInProgress )
+        return;
+
+    // mark starts
+    for(PathNodeList::const_iterator start = starts.begin(); start != starts.end(); ++start)
+    {
+        // walls and cells outside the searched area are never reached (the
+        // search would exhaust it)
+        if( !IsOpenCell(start->iRow, start->iCol) )
+            continue;
+
+        NodeData& node = m_vNodes[GetIndex(start->iRow, start->iCol)];
+        if( node.uGeneration != m_uGeneration )
+        {
+            node.uGeneration = m_uGeneration;
+            node.iParent = -1;
+            node.iHeapIndex = -1;
+            node.fDistanceCost = FLT_MAX;
+            node.fTotalCost = FLT_MAX;
+            node.bClosed = false;
+        }
+        else if( node.bTarget )
+        {
+            continue;
+        }
+
+        node.bTarget = true;
+        m_vTargets.push_back(GetIndex(start->iRow, start->iCol));
+    }
+
+    if( m_vTargets.empty() )
+        m_result = kSearchComplete;
+
+    // guide the goal node towards the starts
+    RecomputeOpenCosts();
+}
+
+/**
+* Runs up to the specified number of node expansions.
+*
+* 1. Pop best node off the open heap (call it B)
+*     a. If B is the goal node, then path found
+*     b. If the open heap is empty, then no path possible
+*     c. Relax all neighboring nodes of B (decrease-key if already open)
+*     d. Close B
+*/
+PathSearch::SearchResult PathSearch::Step(int iMaxExpansions)
+{
+    while( m_result == kSearchInProgress && iMaxExpansions-- > 0 )
+    {
+        // if no nodes open, done (a reverse search has found every reachable start)
+        if( m_vOpenHeap.empty() )
+        {
+            m_result = m_vTargets.empty() ? kSearchNoPath : kSearchComplete;
+            break;
+        }
+
+        // pop lowest cost
+        int iLowest = PopOpen();
+
+        // reverse search start reached, done once all are
+        if( m_vNodes[iLowest].bTarget )
+        {
+            m_vNodes[iLowest].bTarget = false;
+            m_vTargets.erase(std::find(m_vTargets.begin(), m_vTargets.end(), iLowest));
+
+            if( m_vTargets.empty() )
+            {
+                m_vNodes[iLowest].bClosed = true;
+                m_result = kSearchComplete;
+                break;
+            }
+
+            // head for the next nearest start
+            RecomputeOpenCosts();
+        }
+
+        // if lowest cost is destination, done
+        if( iLowest == m_iDest )
+        {
+            m_result = kSearchComplete;
+            break;
+        }
+
+        // otherwise, add all neighboring nodes (or jump points) and close node
+        if(m_options.bJumpPoint && !m_options.bAnyAngle)
+            AddJumpPointNodes(iLowest);
+        else
+            AddNeighborNodes(iLowest);
+
+        m_vNodes[iLowest].bClosed = true;
+        ++m_iExpanded;
+    }
+
+    return m_result;
+}
+
+/**
+* Builds the node list from the start to the destination of a completed
+* search.
+*/
+void PathSearch::GetPath(PathNodeList* nodeList) const
+{
+    nodeList->clear();
+
+    if( m_result != kSearchComplete || m_iDest == -1 )
+        return;
+
+    // order from start to destination
+    BuildPath(m_iDest, nodeList);
+    std::reverse(nodeList->begin(), nodeList->end());
+}
+
+/**
+* Builds the node list from a start of a completed reverse search to the
+* goal. The list is empty if the start was not reached.
+*/
+void PathSearch::GetPathFrom(const PathNodeKey& nkStart, PathNodeList* nodeList) const
+{
+    nodeList->clear();
+
+    if( GetDistanceCost(nkStart) < 0.0f )
+        return;
+
+    BuildPath(GetIndex(nkStart.iRow, nkStart.iCol), nodeList);
+}
+
+/**
+* Builds the node list from a closed node back to the search start. Nodes are
+* optionally removed when the node before and after them on the path have
+* line of sight (rubberbanding). Any-angle paths are returned as their corner
+* nodes.
+*/
+void PathSearch::BuildPath(int iNode, PathNodeList* nodeList) const
+{
+    // collect path from node to start
+    PathNodeList chain;
+    for(; iNode != -1; iNode = m_vNodes[iNode].iParent)
+    {
+        PathNodeKey key;
+        key.iRow = GetRow(iNode);
+        key.iCol = GetCol(iNode);
+        chain.push_back(key);
+
+        // fill in straight or diagonal cells skipped between jump points
+        int iParent = m_vNodes[iNode].iParent;
+        if( iParent != -1 && !m_options.bAnyAngle )
+        {
+            int dRow = (GetRow(iParent) > key.iRow) - (GetRow(iParent) < key.iRow);
+            int dCol = (GetCol(iParent) > key.iCol) - (GetCol(iParent) < key.iCol);
+
+            for(key.iRow += dRow, key.iCol += dCol; GetIndex(key.iRow, key.iCol) != iParent; key.iRow += dRow, key.iCol += dCol)
+                chain.push_back(key);
+        }
+    }
+
+    // keep destination and start, remove unnecessary nodes in between
+    int iPrev = -1;
+    for(int i = 0; i < (int)chain.size(); ++i)
+    {
+        int iNext = i + 1;
+
+        // node not required, keep previous node for next check
+        if( m_options.bRubberband && !m_options.bAnyAngle && iPrev != -1 && iNext < (int)chain.size() &&
+            CheckNodeRubberband(chain[iPrev], chain[i], chain[iNext]) )
+        {
+            continue;
+        }
+
+        nodeList->push_back(chain[i]);
+        iPrev = i;
+    }
+}
+
+/**
+* Places the node window for a new search: over the bounds if they fit,
+* otherwise centered between the start and destination. The search is
+* limited to the part of the bounds inside the window.
+*/
+void PathSearch::PlaceWindow(const PathNodeKey& nkStart, const PathNodeKey& nkDest)
+{
+    m_nkLimitMin = m_nkBoundsMin;
+    m_nkLimitMax = m_nkBoundsMax;
+
+    // node grid covers the whole grid
+    if( m_iNodeRows == m_iHeight && m_iNodeCols == m_iWidth )
+        return;
+
+    if( m_nkBoundsMax.iRow - m_nkBoundsMin.iRow < m_iNodeRows && m_nkBoundsMax.iCol - m_nkBoundsMin.iCol < m_iNodeCols )
+    {
+        m_nkOrigin = m_nkBoundsMin;
+    }
+    else
+    {
+        PathNodeKey nkCenter = nkStart;
+        if( nkDest.iRow >= 0 && nkDest.iRow < m_iHeight && nkDest.iCol >= 0 && nkDest.iCol < m_iWidth )
+        {
+            nkCenter.iRow = (nkStart.iRow + nkDest.iRow) / 2;
+            nkCenter.iCol = (nkStart.iCol + nkDest.iCol) / 2;
+        }
+
+        m_nkOrigin.iRow = nkCenter.iRow - m_iNodeRows / 2;
+        m_nkOrigin.iCol = nkCenter.iCol - m_iNodeCols / 2;
+    }
+
+    // keep the window inside the grid
+    m_nkOrigin.iRow = std::max(0, std::min(m_nkOrigin.iRow, m_iHeight - m_iNodeRows));
+    m_nkOrigin.iCol = std::max(0, std::min(m_nkOrigin.iCol, m_iWidth - m_iNodeCols));
+
+    m_nkLimitMin.iRow = std::max(m_nkBoundsMin.iRow, m_nkOrigin.iRow);
+    m_nkLimitMin.iCol = std::max(m_nkBoundsMin.iCol, m_nkOrigin.iCol);
+    m_nkLimitMax.iRow = std::min(m_nkBoundsMax.iRow, m_nkOrigin.iRow + m_iNodeRows - 1);
+    m_nkLimitMax.iCol = std::min(m_nkBoundsMax.iCol, m_nkOrigin.iCol + m_iNodeCols - 1);
+}
+
+/**
+* Removes the search bounds (the whole grid is searched)
+*/
+void PathSearch::ClearBounds()
+{
+    m_nkBoundsMin.iRow = 0;
+    m_nkBoundsMin.iCol = 0;
+    m_nkBoundsMax.iRow = m_iHeight - 1;
+    m_nkBoundsMax.iCol = m_iWidth - 1;
+}
+
+/**
+* Returns the distance cost from the start to an expanded cell, or -1 if the
+* cell was not expanded by the last search. After a search without a
+* destination this is the shortest distance to every reachable cell.
+*/
+float PathSearch::GetDistanceCost(const PathNodeKey& key) const
+{
+    if( !IsInWindow(key.iRow, key.iCol) )
+        return -1.0f;
+
+    const NodeData& node = m_vNodes[GetIndex(key.iRow, key.iCol)];
+    if( node.uGeneration != m_uGeneration || !node.bClosed )
+        return -1.0f;
+
+    return node.fDistanceCost;
+}
+
+/**
+* Checks if the cell can be entered
+*/
+bool PathSearch::IsOpenCell(int iRow, int iCol) const
+{
+    // check if within bounds (and window)
+    if( iCol > m_nkLimitMax.iCol || iCol < m_nkLimitMin.iCol || iRow > m_nkLimitMax.iRow || iRow < m_nkLimitMin.iRow )
+        return false;
+
+    return !IsBlocked(iRow, iCol);
+}
+
+/**
+* Add all neighboring nodes. Diagonal moves may not cut wall corners.
+*/
+void PathSearch::AddNeighborNodes(int iNode)
+{
+    int iRow = GetRow(iNode);
+    int iCol = GetCol(iNode);
+
+    ////////////////////
+    // ADJACENT NODES //
+    ////////////////////
+
+    bool bUpWall = IsBlocked(iRow + 1, iCol);
+    bool bRightWall = IsBlocked(iRow, iCol + 1);
+    bool bDownWall = IsBlocked(iRow - 1, iCol);
+    bool bLeftWall = IsBlocked(iRow, iCol - 1);
+
+    if( !bUpWall && IsOpenCell(iRow + 1, iCol) )
+        UpdateNode(iRow + 1, iCol, iNode, kCardinalCost);
+
+    if( !bRightWall && IsOpenCell(iRow, iCol + 1) )
+        UpdateNode(iRow, iCol + 1, iNode, kCardinalCost);
+
+    if( !bDownWall && IsOpenCell(iRow - 1, iCol) )
+        UpdateNode(iRow - 1, iCol, iNode, kCardinalCost);
+
+    if( !bLeftWall && IsOpenCell(iRow, iCol - 1) )
+        UpdateNode(iRow, iCol - 1, iNode, kCardinalCost);
+
+    ////////////////////
+    // DIAGONAL NODES //
+    ////////////////////
+
+    // upper right
+    if( !bUpWall && !bRightWall && IsOpenCell(iRow + 1, iCol + 1) )
+        UpdateNode(iRow + 1, iCol + 1, iNode, kDiagonalCost);
+
+    // lower right
+    if( !bDownWall && !bRightWall && IsOpenCell(iRow - 1, iCol + 1) )
+        UpdateNode(iRow - 1, iCol + 1, iNode, kDiagonalCost);
+
+    // lower left
+    if( !bDownWall && !bLeftWall && IsOpenCell(iRow - 1, iCol - 1) )
+        UpdateNode(iRow - 1, iCol - 1, iNode, kDiagonalCost);
+
+    // upper left
+    if( !bUpWall && !bLeftWall && IsOpenCell(iRow + 1, iCol - 1) )
+        UpdateNode(iRow + 1, iCol - 1, iNode, kDiagonalCost);
+}
+
+/**
+* Creates or updates a node. A node reached with a lower total cost than its
+* current cost is (re)opened with the new parent. Any-angle searches link the
+* node straight to the grandparent when it is in line of sight.
+*/
+void PathSearch::UpdateNode(int iRow, int iCol, int iParent, float fStepCost)
+{
+    int iNode = GetIndex(iRow, iCol);
+    NodeData& node = m_vNodes[iNode];
+
+    // any-angle shortcut to grandparent
+    if( m_options.bAnyAngle && iParent != -1 && m_vNodes[iParent].iParent != -1 )
+    {
+        int iGrandparent = m_vNodes[iParent].iParent;
+        int iGrandRow = GetRow(iGrandparent);
+        int iGrandCol = GetCol(iGrandparent);
+
+        if( m_occupancy.HasLineOfSight(iGrandRow, iGrandCol, iRow, iCol) )
+        {
+            iParent = iGrandparent;
+            fStepCost = sqrt((float)((iRow - iGrandRow)*(iRow - iGrandRow) + (iCol - iGrandCol)*(iCol - iGrandCol)));
+        }
+    }
+
+    // compute distance and total cost
+    float fDistanceCost = (iParent != -1) ? m_vNodes[iParent].fDistanceCost + fStepCost : 0.0f;
+    float fTotalCost = fDistanceCost + m_options.fHeuristicWeight * ComputeHeuristicCost(iRow, iCol);
+
+    // node does not exist in this search
+    if( node.uGeneration != m_uGeneration )
+    {
+        node.uGeneration = m_uGeneration;
+        node.iHeapIndex = -1;
+        node.bTarget = false;
+    }
+
+    // node exists with lower cost, ignore
+    else if( node.fTotalCost <= fTotalCost )
+    {
+        return;
+    }
+
+    // set node data
+    node.iParent = iParent;
+    node.fDistanceCost = fDistanceCost;
+    node.fTotalCost = fTotalCost;
+    node.bClosed = false;
+
+    // open node or decrease key
+    if( node.iHeapIndex == -1 )
+        PushOpen(iNode);
+    else
+        SiftUp(node.iHeapIndex);
+}
+
+/**
+* Compute cardinal/intercardinal distance for the specified axis differences
+*/
+float PathSearch::ComputeOctileCost(int iRowDiff, int iColDiff) const
+{
+    float xDiff = (float)abs(iColDiff);
+    float yDiff = (float)abs(iRowDiff);
+
+    float fMin = (xDiff < yDiff) ? xDiff : yDiff;
+    float fMax = (xDiff < yDiff) ? yDiff : xDiff;
+    return fMin * kDiagonalCost + fMax - fMin;
+}
+
+/**
+* Compute heuristic cost to the destination, or to the nearest start not yet
+* reached by a reverse search.
+*/
+float PathSearch::ComputeHeuristicCost(int iRow, int iCol) const
+{
+    // reverse search
+    if( !m_vTargets.empty() )
+    {
+        float fCost = FLT_MAX;
+        for(std::vector<int>::const_iterator target = m_vTargets.begin(); target != m_vTargets.end(); ++target)
+        {
+            float fTargetCost = ComputeHeuristicCost(iRow, iCol, *target);
+            if( fTargetCost < fCost )
+                fCost = fTargetCost;
+        }
+        return fCost;
+    }
+
+    // no destination in grid
+    if( m_iDest == -1 )
+        return 0.0f;
+
+    return ComputeHeuristicCost(iRow, iCol, m_iDest);
+}
+
+/**
+* Compute heuristic cost to the specified cell. The landmark lower bound is
+* used when it is higher than the distance estimate.
+*/
+float PathSearch::ComputeHeuristicCost(int iRow, int iCol, int iDest) const
+{
+    // compute axis differences
+    int iRowDiff = iRow - GetRow(iDest);
+    int iColDiff = iCol - GetCol(iDest);
+
+    float fCost = 0.0f;
+
+    // cardinal/intercardinal (overestimates any-angle paths)
+    if(m_options.bHeuristicCalc && !m_options.bAnyAngle)
+    {
+        fCost = ComputeOctileCost(iRowDiff, iColDiff);
+    }
+
+    // eucladian
+    else
+    {
+        fCost = sqrt((float)(iRowDiff*iRowDiff + iColDiff*iColDiff));
+    }
+
+    // landmarks (grid distances, indexed by grid cell)
+    if(m_options.pLandmarks && !m_options.bAnyAngle)
+    {
+        float fLandmarkCost = m_options.pLandmarks->ComputeHeuristicCost(iRow * m_iWidth + iCol, GetRow(iDest) * m_iWidth + GetCol(iDest));
+        if( fLandmarkCost > fCost )
+            fCost = fLandmarkCost;
+    }
+
+    return fCost;
+}
+
+///////////////////////
+// JUMP POINT SEARCH //
+///////////////////////
+
+/**
+* Add successor jump points of a node. Neighbors are pruned based on the
+* direction of travel from the parent; only natural neighbors and neighbors
+* forced by an adjacent wall are searched. Diagonal moves never cut wall
+* corners, so diagonal travel has no forced neighbors.
+*/
+void PathSearch::AddJumpPointNodes(int iNode)
+{
+    int iRow = GetRow(iNode);
+    int iCol = GetCol(iNode);
+    int iParent = m_vNodes[iNode].iParent;
+
+    // start node, search all directions
+    if( iParent == -1 )
+    {
+        for(int dRow = -1; dRow <= 1; ++dRow)
+        {
+            for(int dCol = -1; dCol <= 1; ++dCol)
+            {
+                if( dRow || dCol )
+                    AddJumpPoint(iNode, dRow, dCol);
+            }
+        }
+        return;
+    }
+
+    // direction of travel
+    int dRow = (iRow > GetRow(iParent)) - (iRow < GetRow(iParent));
+    int dCol = (iCol > GetCol(iParent)) - (iCol < GetCol(iParent));
+
+    // diagonal: both cardinal components and the diagonal
+    if( dRow && dCol )
+    {
+        AddJumpPoint(iNode, 0, dCol);
+        AddJumpPoint(iNode, dRow, 0);
+        AddJumpPoint(iNode, dRow, dCol);
+    }
+
+    // horizontal: forward plus forced sides (wall behind the side cell)
+    else if( dCol )
+    {
+        AddJumpPoint(iNode, 0, dCol);
+
+        for(int dSide = -1; dSide <= 1; dSide += 2)
+        {
+            if( IsOpenCell(iRow + dSide, iCol) && !IsOpenCell(iRow + dSide, iCol - dCol) )
+            {
+                AddJumpPoint(iNode, dSide, 0);
+                AddJumpPoint(iNode, dSide, dCol);
+            }
+        }
+    }
+
+    // vertical: forward plus forced sides (wall behind the side cell)
+    else
+    {
+        AddJumpPoint(iNode, dRow, 0);
+
+        for(int dSide = -1; dSide <= 1; dSide += 2)
+        {
+            if( IsOpenCell(iRow, iCol + dSide) && !IsOpenCell(iRow - dRow, iCol + dSide) )
+            {
+                AddJumpPoint(iNode, 0, dSide);
+                AddJumpPoint(iNode, dRow, dSide);
+            }
+        }
+    }
+}
+
+/**
+* Jump from a node in the specified direction and add the jump point found
+*/
+void PathSearch::AddJumpPoint(int iNode, int dRow, int dCol)
+{
+    int iRow = GetRow(iNode);
+    int iCol = GetCol(iNode);
+
+    // diagonal moves may not cut wall corners
+    if( dRow && dCol && (!IsOpenCell(iRow + dRow, iCol) || !IsOpenCell(iRow, iCol + dCol)) )
+        return;
+
+    int iJump = Jump(iRow + dRow, iCol + dCol, dRow, dCol);
+    if( iJump == -1 )
+        return;
+
+    // distance along the straight or diagonal jump
+    int iJumpRow = GetRow(iJump);
+    int iJumpCol = GetCol(iJump);
+    UpdateNode(iJumpRow, iJumpCol, iNode, ComputeOctileCost(iJumpRow - iRow, iJumpCol - iCol));
+}
+
+/**
+* Travels diagonally from the cell until a jump point is found. Returns the
+* jump point node index or -1 if a wall is reached.
+*/
+int PathSearch::Jump(int iRow, int iCol, int dRow, int dCol) const
+{
+    // straight travel
+    if( !dRow || !dCol )
+        return JumpStraight(iRow, iCol, dRow, dCol);
+
+    while( IsOpenCell(iRow, iCol) )
+    {
+        int iNode = GetIndex(iRow, iCol);
+
+        // destination reached
+        if( iNode == m_iDest )
+            return iNode;
+
+        // jump point if either cardinal component reaches a jump point
+        if( JumpStraight(iRow, iCol + dCol, 0, dCol) != -1 || JumpStraight(iRow + dRow, iCol, dRow, 0) != -1 )
+            return iNode;
+
+        // continue diagonally if no corner is cut
+        if( !IsOpenCell(iRow, iCol + dCol) || !IsOpenCell(iRow + dRow, iCol) )
+            return -1;
+
+        iRow += dRow;
+        iCol += dCol;
+    }
+
+    return -1;
+}
+
+/**
+* Travels horizontally or vertically from the cell until a jump point is
+* found. Returns the jump point node index or -1 if a wall is reached.
+*/
+int PathSearch::JumpStraight(int iRow, int iCol, int dRow, int dCol) const
+{
+    while( IsOpenCell(iRow, iCol) )
+    {
+        int iNode = GetIndex(iRow, iCol);
+
+        // destination reached
+        if( iNode == m_iDest )
+            return iNode;
+
+        // forced neighbor (open side cell with a wall behind it)
+        if( dCol )
+        {
+            if( (IsOpenCell(iRow + 1, iCol) && !IsOpenCell(iRow + 1, iCol - dCol)) ||
+                (IsOpenCell(iRow - 1, iCol) && !IsOpenCell(iRow - 1, iCol - dCol)) )
+                return iNode;
+        }
+        else
+        {
+            if( (IsOpenCell(iRow, iCol + 1) && !IsOpenCell(iRow - dRow, iCol + 1)) ||
+                (IsOpenCell(iRow, iCol - 1) && !IsOpenCell(iRow - dRow, iCol - 1)) )
+                return iNode;
+        }
+
+        iRow += dRow;
+        iCol += dCol;
+    }
+
+    return -1;
+}
+
+/**
+* Check if node is unnecessary and should be removed from path. The node can
+* be removed if the previous and next node have line of sight. Return true if
+* remove, else false
+*/
+bool PathSearch::CheckNodeRubberband(const PathNodeKey& nkPrev, const PathNodeKey& nkPos, const PathNodeKey& nkNext) const
+{
+    return m_occupancy.HasLineOfSight(nkPrev.iRow, nkPrev.iCol, nkNext.iRow, nkNext.iCol);
+}
+
+///////////////
+// OPEN HEAP //
+///////////////
+
+/**
+* Heap ordering. Lower total cost first; ties prefer the node further from
+* the start (closer to the destination).
+*/
+bool PathSearch::IsLowerCost(int iNodeA, int iNodeB) const
+{
+    const NodeData& a = m_vNodes[iNodeA];
+    const NodeData& b = m_vNodes[iNodeB];
+
+    if( a.fTotalCost != b.fTotalCost )
+        return a.fTotalCost < b.fTotalCost;
+
+    return a.fDistanceCost > b.fDistanceCost;
+}
+
+/**
+* Push node onto open heap
+*/
+void PathSearch::PushOpen(int iNode)
+{
+    m_vNodes[iNode].iHeapIndex = (int)m_vOpenHeap.size();
+    m_vOpenHeap.push_back(iNode);
+    SiftUp(m_vNodes[iNode].iHeapIndex);
+}
+
+/**
+* Pop lowest cost node off the open heap
+*/
+int PathSearch::PopOpen()
+{
+    int iTop = m_vOpenHeap.front();
+    m_vNodes[iTop].iHeapIndex = -1;
+
+    // move last node to top
+    int iLast = m_vOpenHeap.back();
+    m_vOpenHeap.pop_back();
+
+    if( !m_vOpenHeap.empty() )
+    {
+        m_vOpenHeap[0] = iLast;
+        m_vNodes[iLast].iHeapIndex = 0;
+        SiftDown(0);
+    }
+
+    return iTop;
+}
+
+/**
+* Move heap entry up until ordered
+*/
+void PathSearch::SiftUp(int iHeapIndex)
+{
+    int iNode = m_vOpenHeap[iHeapIndex];
+
+    while( iHeapIndex > 0 )
+    {
+        int iParentIndex = (iHeapIndex - 1) / 2;
+        int iParentNode = m_vOpenHeap[iParentIndex];
+
+        if( !IsLowerCost(iNode, iParentNode) )
+            break;
+
+        // move parent down
+        m_vOpenHeap[iHeapIndex] = iParentNode;
+        m_vNodes[iParentNode].iHeapIndex = iHeapIndex;
+        iHeapIndex = iParentIndex;
+    }
+
+    m_vOpenHeap[iHeapIndex] = iNode;
+    m_vNodes[iNode].iHeapIndex = iHeapIndex;
+}
+
+/**
+* Move heap entry down until ordered
+*/
+void PathSearch::SiftDown(int iHeapIndex)
+{
+    int iNode = m_vOpenHeap[iHeapIndex];
+    int iSize = (int)m_vOpenHeap.size();
+
+    while( true )
+    {
+        int iChildIndex = iHeapIndex * 2 + 1;
+        if( iChildIndex >= iSize )
+            break;
+
+        // pick lower cost child
+        if( iChildIndex + 1 < iSize && IsLowerCost(m_vOpenHeap[iChildIndex + 1], m_vOpenHeap[iChildIndex]) )
+            ++iChildIndex;
+
+        int iChildNode = m_vOpenHeap[iChildIndex];
+        if( !IsLowerCost(iChildNode, iNode) )
+            break;
+
+        // move child up
+        m_vOpenHeap[iHeapIndex] = iChildNode;
+        m_vNodes[iChildNode].iHeapIndex = iHeapIndex;
+        iHeapIndex = iChildIndex;
+    }
+
+    m_vOpenHeap[iHeapIndex] = iNode;
+    m_vNodes[iNode].iHeapIndex = iHeapIndex;
+}
+
+/**
+* Recomputes the total cost of every open node after the heuristic target
+* changed and restores the heap order. Closed nodes keep their cost; a
+* consistent heuristic already found their shortest distance.
+*/
+void PathSearch::RecomputeOpenCosts()
+{
+    for(std::vector<int>::iterator open = m_vOpenHeap.begin(); open != m_vOpenHeap.end(); ++open)
+    {
+        NodeData& node = m_vNodes[*open];
+        node.fTotalCost = node.fDistanceCost + m_options.fHeuristicWeight * ComputeHeuristicCost(GetRow(*open), GetCol(*open));
+    }
+
+    for(int i = (int)m_vOpenHeap.size() / 2 - 1; i >= 0; --i)
+    {
+        SiftDown(i);
+    }
+}
@@ -0,0 +1,177 @@
+/*******************************************************************************
+* Game Development Project
+* PathSearch.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* A* path search over the world grid
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "WorldFile.h"
+#include "PathOccupancy.h"
+
+class PathLandmarks;
+
+/* grid node key */
+struct PathNodeKey
+{
+    int iRow;
+    int iCol;
+};
+
+/* path node key list (start to destination) */
+typedef std::vector<PathNodeKey> PathNodeList;
+
+/* search options */
+struct PathSearchOptions
+{
+    bool bHeuristicCalc;        // true for cardinal/intercardinal; false for eucladian
+    float fHeuristicWeight;     // heuristic weight (1.01f is preferred)
+    bool bJumpPoint;            // expand jump points only
+    bool bRubberband;           // remove unnecessary path nodes
+    bool bAnyAngle;             // any-angle (Theta*) paths through line of sight
+    const PathLandmarks* pLandmarks;    // landmark (ALT) heuristic tables (may be null)
+};
+
+/**
+* A* search over a WorldFile grid. Node data is stored in a flat per-cell array
+* that is reset between searches with a generation stamp, and the open list is
+* an indexed binary heap supporting decrease-key. A search owns all of its
+* scratch memory, so separate instances may run concurrently on the same grid.
+*
+* Jump point search may be enabled to expand only jump points on the uniform
+* cost grid; the returned node list still contains every cell on the path.
+*
+* Searches may be restricted to a rectangle of the grid; cells outside the
+* bounds are treated as walls.
+*
+* A window size limits the node grid and the wall bits to a square of cells,
+* so a search takes the same memory on any world size. Each search places
+* the window over its bounds when they fit, otherwise centered between the
+* start and destination; cells outside the window are treated as walls.
+*
+* A reverse search runs from a goal until several starts are reached, so
+* every agent heading to the same goal shares one search; the path from each
+* start follows the parents towards the goal. It is guided towards the
+* nearest start not yet reached.
+*
+* Any-angle search (Theta*) links a node to its grandparent whenever the two
+* have line of sight, so the returned nodes are the corners of a taut path
+* and need no rubberbanding. Jump points and landmark distances assume grid
+* moves and are not used for any-angle searches.
+*/
+class PathSearch
+{
+    public:
+
+        /**
+        * Search result
+        */
+        enum SearchResult
+        {
+            kSearchInProgress,
+            kSearchComplete,
+            kSearchNoPath
+        };
+
+        // constructor
+        PathSearch(const WorldFile& worldFile, int iWindowSize = 0);
+        ~PathSearch();
+
+        // search
+        void Begin(const PathNodeKey& nkStart, const PathNodeKey& nkDest, const PathSearchOptions& options);
+        void BeginReverse(const PathNodeKey& nkGoal, const PathNodeList& starts, const PathSearchOptions& options);
+        SearchResult Step(int iMaxExpansions);
+        void GetPath(PathNodeList* nodeList) const;
+        void GetPathFrom(const PathNodeKey& nkStart, PathNodeList* nodeList) const;
+
+        // search bounds (inclusive; kept until changed)
+        void SetBounds(const PathNodeKey& nkMin, const PathNodeKey& nkMax) { m_nkBoundsMin = nkMin; m_nkBoundsMax = nkMax; }
+        void ClearBounds();
+
+        // search info
+        SearchResult GetResult() const { return m_result; }
+        int GetExpandedCount() const { return m_iExpanded; }
+        float GetDistanceCost(const PathNodeKey& key) const;
+
+    private:
+
+        /**
+        * Per-cell node data. Only valid when the generation matches the
+        * current search generation.
+        */
+        struct NodeData
+        {
+            unsigned int uGeneration;   // search generation stamp
+            int iParent;                // parent node index (-1 for start)
+            int iHeapIndex;             // open heap position (-1 if not open)
+            float fDistanceCost;        // cost from start
+            float fTotalCost;           // distance + heuristic cost
+            bool bClosed;               // node expanded
+            bool bTarget;               // reverse search start not yet reached
+        };
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iWidth;
+        int m_iHeight;
+        int m_iNodeRows;                    // node grid rows (window or grid)
+        int m_iNodeCols;                    // node grid columns (window or grid)
+
+        // search options
+        PathSearchOptions m_options;
+        PathNodeKey m_nkBoundsMin;          // lowest row/column searched
+        PathNodeKey m_nkBoundsMax;          // highest row/column searched
+        PathNodeKey m_nkOrigin;             // first row/column of the node grid
+        PathNodeKey m_nkLimitMin;           // lowest row/column searched within the window
+        PathNodeKey m_nkLimitMax;           // highest row/column searched within the window
+        PathOccupancy m_occupancy;          // wall bits for line of sight
+
+        // search state
+        std::vector<NodeData> m_vNodes;     // node grid (row-major from the origin)
+        std::vector<int> m_vOpenHeap;       // open list heap (node indices)
+        unsigned int m_uGeneration;         // current search generation
+        int m_iStart;                       // start node index
+        int m_iDest;                        // destination node index
+        SearchResult m_result;              // current result
+        int m_iExpanded;                    // nodes expanded this search
+        std::vector<int> m_vTargets;        // reverse search starts not yet reached
+
+        // node methods
+        void PlaceWindow(const PathNodeKey& nkStart, const PathNodeKey& nkDest);
+        void BuildPath(int iNode, PathNodeList* nodeList) const;
+        int GetIndex(int iRow, int iCol) const { return (iRow - m_nkOrigin.iRow) * m_iNodeCols + iCol - m_nkOrigin.iCol; }
+        int GetRow(int iNode) const { return m_nkOrigin.iRow + iNode / m_iNodeCols; }
+        int GetCol(int iNode) const { return m_nkOrigin.iCol + iNode % m_iNodeCols; }
+        bool IsInWindow(int iRow, int iCol) const { return iRow >= m_nkOrigin.iRow && iRow < m_nkOrigin.iRow + m_iNodeRows && iCol >= m_nkOrigin.iCol && iCol < m_nkOrigin.iCol + m_iNodeCols; }
+        bool IsOpenCell(int iRow, int iCol) const;
+        bool IsBlocked(int iRow, int iCol) const { return m_worldFile(iRow, iCol) == WorldFile::OCCUPIED_CELL; }
+        void AddNeighborNodes(int iNode);
+        void UpdateNode(int iRow, int iCol, int iParent, float fStepCost);
+        float ComputeOctileCost(int iRowDiff, int iColDiff) const;
+        float ComputeHeuristicCost(int iRow, int iCol) const;
+        float ComputeHeuristicCost(int iRow, int iCol, int iDest) const;
+        // jump point methods
+        void AddJumpPointNodes(int iNode);
+        void AddJumpPoint(int iNode, int dRow, int dCol);
+        int Jump(int iRow, int iCol, int dRow, int dCol) const;
+        int JumpStraight(int iRow, int iCol, int dRow, int dCol) const;
+
+        bool CheckNodeRubberband(const PathNodeKey& nkPrev, const PathNodeKey& nkPos, const PathNodeKey& nkNext) const;
+
+        // open heap methods
+        bool IsLowerCost(int iNodeA, int iNodeB) const;
+        void PushOpen(int iNode);
+        int PopOpen();
+        void SiftUp(int iHeapIndex);
+        void SiftDown(int iHeapIndex);
+        void RecomputeOpenCosts();
+
+        // prevent copy and assignment
+        PathSearch(const PathSearch&);
+        PathSearch& operator=(const PathSearch&);
+};
@@ -0,0 +1,210 @@
+/*******************************************************************************
+* Game Development Project
+* PathThreadPool.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Worker threads for path searches
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathThreadPool.h"
+#include <limits.h>
+
+// maximum number of path worker threads
+static const int kMaxPathThreads = 4;
+
+// node expansions per search step on a worker thread
+static const int kWorkerExpansionsPerStep = 1024;
+
+/**
+* Constructor. Starts the specified number of worker threads.
+*/
+PathThreadPool::PathThreadPool(const WorldFile& worldFile, int iThreadCount, int iSearchWindow) :
+    m_bShutdown(false)
+{
+    InitializeCriticalSection(&m_queueLock);
+    m_hJobSemaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+
+    // create workers (search scratch is allocated up front on this thread)
+    for(int i = 0; i < iThreadCount; ++i)
+    {
+        Worker* worker = new Worker;
+        worker->pPool = this;
+        worker->pSearch = new PathSearch(worldFile, iSearchWindow);
+        worker->hThread = CreateThread(NULL, 0, ThreadProc, worker, 0, NULL);
+
+        // drop the worker if the thread could not be started
+        if(worker->hThread == NULL)
+        {
+            delete worker->pSearch;
+            delete worker;
+            break;
+        }
+
+        m_vWorkers.push_back(worker);
+    }
+}
+
+/**
+* Deconstructor. Stops all worker threads; unsolved jobs are abandoned
+* and remain owned by the caller.
+*/
+PathThreadPool::~PathThreadPool()
+{
+    // signal shutdown and wake every worker
+    EnterCriticalSection(&m_queueLock);
+    m_bShutdown = true;
+    m_jobQueue.clear();
+    LeaveCriticalSection(&m_queueLock);
+
+    ReleaseSemaphore(m_hJobSemaphore, (LONG)m_vWorkers.size(), NULL);
+
+    // wait for workers to exit
+    for(std::vector<Worker*>::iterator worker = m_vWorkers.begin(); worker != m_vWorkers.end(); ++worker)
+    {
+        WaitForSingleObject((*worker)->hThread, INFINITE);
+        CloseHandle((*worker)->hThread);
+        delete (*worker)->pSearch;
+        delete (*worker);
+    }
+
+    CloseHandle(m_hJobSemaphore);
+    DeleteCriticalSection(&m_queueLock);
+}
+
+/**
+* Returns the default worker count: one less than the number of processors
+* (leaving a core for the main thread), clamped to [0, kMaxPathThreads].
+*/
+int PathThreadPool::GetDefaultThreadCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    int iThreadCount = (int)info.dwNumberOfProcessors - 1;
+    if(iThreadCount > kMaxPathThreads)
+        iThreadCount = kMaxPathThreads;
+    if(iThreadCount < 0)
+        iThreadCount = 0;
+
+    return iThreadCount;
+}
+
+/**
+* Queues a job for the workers. The job must stay alive until it is complete
+* or the pool is destroyed.
+*/
+void PathThreadPool::Submit(PathJob* job)
+{
+    job->lComplete = 0;
+
+    EnterCriticalSection(&m_queueLock);
+    m_jobQueue.push_back(job);
+    LeaveCriticalSection(&m_queueLock);
+
+    ReleaseSemaphore(m_hJobSemaphore, 1, NULL);
+}
+
+/**
+* Returns true when a worker has finished the job. The interlocked read
+* orders the job results before any subsequent reads by the caller.
+*/
+bool PathThreadPool::IsComplete(const PathJob* job)
+{
+    return InterlockedCompareExchange(const_cast<volatile LONG*>(&job->lComplete), 1, 1) == 1;
+}
+
+/**
+* Worker thread entry point
+*/
+DWORD WINAPI PathThreadPool::ThreadProc(LPVOID lpParameter)
+{
+    Worker* worker = (Worker*)lpParameter;
+
+    // solve jobs until shutdown
+    PathJob* job = NULL;
+    while( (job = worker->pPool->WaitForJob()) != NULL )
+    {
+        SolveJob(worker->pSearch, job);
+
+        // publish results
+        InterlockedExchange(&job->lComplete, 1);
+    }
+
+    return 0;
+}
+
+/**
+* Blocks until a job is available. Returns null on shutdown.
+*/
+PathJob* PathThreadPool::WaitForJob()
+{
+    WaitForSingleObject(m_hJobSemaphore, INFINITE);
+
+    PathJob* job = NULL;
+
+    EnterCriticalSection(&m_queueLock);
+    if(!m_bShutdown && !m_jobQueue.empty())
+    {
+        job = m_jobQueue.front();
+        m_jobQueue.pop_front();
+    }
+    LeaveCriticalSection(&m_queueLock);
+
+    return job;
+}
+
+/**
+* Runs a search to completion using the worker's scratch memory.
+*/
+void PathThreadPool::SolveJob(PathSearch* search, PathJob* job)
+{
+    job->abstractPath.nodes.clear();
+    job->abstractPath.iNext = 0;
+
+    // batch: one reverse search from the shared destination
+    if( !job->groupStarts.empty() )
+    {
+        search->BeginReverse(job->nkDest, job->groupStarts, job->options);
+
+        while( search->Step(kWorkerExpansionsPerStep) == PathSearch::kSearchInProgress )
+        {
+        }
+
+        job->result = search->GetResult();
+        job->iExpanded = search->GetExpandedCount();
+
+        job->groupNodeLists.resize(job->groupStarts.size());
+        for(int i = 0; i < (int)job->groupStarts.size(); ++i)
+        {
+            search->GetPathFrom(job->groupStarts[i], &job->groupNodeLists[i]);
+        }
+        return;
+    }
+
+    // long paths are found on the abstract graph and refined through the first cluster
+    if( job->pAbstraction && job->pAbstraction->IsLongPath(job->nkStart, job->nkDest) )
+    {
+        job->result = job->pAbstraction->BeginPath(search, job->nkStart, job->nkDest, job->options, &job->abstractPath, &job->nodeList);
+        job->iExpanded = search->GetExpandedCount();
+        return;
+    }
+
+    search->Begin(job->nkStart, job->nkDest, job->options);
+
+    while( search->Step(kWorkerExpansionsPerStep) == PathSearch::kSearchInProgress )
+    {
+    }
+
+    job->result = search->GetResult();
+    job->iExpanded = search->GetExpandedCount();
+
+    job->nodeList.clear();
+    if(job->result == PathSearch::kSearchComplete)
+    {
+        search->GetPath(&job->nodeList);
+    }
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Game Development Project
+* PathThreadPool.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Worker threads for path searches
+*
+*******************************************************************************/
+
+#pragma once
+#include <deque>
+#include <vector>
+#include "PathSearch.h"
+#include "PathAbstraction.h"
+
+/**
+* Path search job. Filled in by the main thread, solved by a worker thread.
+* The result fields may only be read once IsComplete() returns true.
+*
+* A batch job lists the starts of every request heading to the destination;
+* it is solved with one reverse search and gives a node list per start.
+*/
+struct PathJob
+{
+    // request
+    PathNodeKey nkStart;                // start cell
+    PathNodeKey nkDest;                 // destination cell
+    PathSearchOptions options;          // search options
+    const PathAbstraction* pAbstraction;// hierarchical search of long paths (may be null)
+    PathNodeList groupStarts;           // batch starts sharing the destination (empty for one request)
+
+    // result
+    PathSearch::SearchResult result;    // search result
+    PathNodeList nodeList;              // path nodes (start to destination or first cluster exit)
+    AbstractPath abstractPath;          // unrefined rest of a hierarchical path
+    std::vector<PathNodeList> groupNodeLists;   // batch path nodes per start (empty if unreachable)
+    int iExpanded;                      // nodes expanded
+
+    volatile LONG lComplete;            // set by the worker when solved
+};
+
+/**
+* Pool of worker threads solving path jobs against the world grid (cells may
+* change during a job; see WorldFile::SetCell).
+* Each worker owns its own PathSearch scratch memory (limited to the given
+* node window, if any). Jobs are taken in
+* submission order; completion order is not defined, so callers consume
+* results in their own order by polling IsComplete().
+*/
+class PathThreadPool
+{
+    public:
+
+        // constructor
+        PathThreadPool(const WorldFile& worldFile, int iThreadCount, int iSearchWindow = 0);
+        ~PathThreadPool();
+
+        // jobs (main thread)
+        void Submit(PathJob* job);
+        static bool IsComplete(const PathJob* job);
+
+        // pool info
+        int GetThreadCount() const { return (int)m_vWorkers.size(); }
+        static int GetDefaultThreadCount();
+
+    private:
+
+        /**
+        * Worker thread data
+        */
+        struct Worker
+        {
+            PathThreadPool* pPool;      // owning pool
+            PathSearch* pSearch;        // per-thread search scratch
+            HANDLE hThread;             // thread handle
+        };
+
+        std::vector<Worker*> m_vWorkers;    // worker threads
+
+        // job queue
+        CRITICAL_SECTION m_queueLock;       // guards queue and shutdown flag
+        HANDLE m_hJobSemaphore;             // counts queued jobs
+        std::deque<PathJob*> m_jobQueue;    // pending jobs
+        bool m_bShutdown;                   // workers exit when set
+
+        // worker methods
+        static DWORD WINAPI ThreadProc(LPVOID lpParameter);
+        PathJob* WaitForJob();
+        static void SolveJob(PathSearch* search, PathJob* job);
+
+        // prevent copy and assignment
+        PathThreadPool(const PathThreadPool&);
+        PathThreadPool& operator=(const PathThreadPool&);
+};
@@ -0,0 +1,85 @@
+/*******************************************************************************
+* Game Development Project
+* PathWaypoints.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Built path waypoints and post-processing
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "PathWaypoints.h"
+
+/**
+* Smooth the specified waypoint list using catmull-rom.
+*/
+void SmoothWaypoints(PathWaypointArray* waypointList)
+{
+    float fTotalDist = 0.0f;
+    float fAvgDist = 0.0f;
+    int iPointCount = (int)waypointList->size() - 1;
+
+    // nothing to smooth
+    if( iPointCount < 1 )
+        return;
+
+    // find average point distance
+    for(int cur = 0; cur < iPointCount; ++cur)
+    {
+        // compute distance vector between current and next point
+        D3DXVECTOR2 vDist = (*waypointList)[cur + 1] - (*waypointList)[cur];
+
+        // add distance to total
+        fTotalDist += D3DXVec2Length(&vDist);
+    }
+
+    // compute average
+    fAvgDist = fTotalDist / iPointCount;
+
+    // make points evenly spaced (for catmull-rom): halve each segment longer
+    // than the average until no piece is
+    PathWaypointArray spaced;
+    spaced.reserve(waypointList->size() * 2);
+    spaced.push_back(waypointList->front());
+
+    for(int cur = 0; cur < iPointCount; ++cur)
+    {
+        // compute distance vector between current and next point
+        D3DXVECTOR2 vDist = (*waypointList)[cur + 1] - (*waypointList)[cur];
+
+        int iPieces = 1;
+        while( D3DXVec2Length(&vDist) / iPieces > fAvgDist )
+        {
+            iPieces *= 2;
+        }
+
+        for(int piece = 1; piece < iPieces; ++piece)
+        {
+            spaced.push_back( (*waypointList)[cur] + vDist * ((float)piece / iPieces) );
+        }
+        spaced.push_back( (*waypointList)[cur + 1] );
+    }
+
+    // add catmull rom points between each point (p1) and the next (p2); p0 is
+    // the point added before p1
+    waypointList->clear();
+    waypointList->reserve(spaced.size() * 4);
+    waypointList->push_back(spaced.front());
+
+    for(int p1 = 0; p1 + 1 < (int)spaced.size(); ++p1)
+    {
+        D3DXVECTOR2 v0 = (p1 == 0) ? spaced[p1] : (*waypointList)[waypointList->size() - 2];
+        const D3DXVECTOR2& v1 = spaced[p1];
+        const D3DXVECTOR2& v2 = spaced[p1 + 1];
+        const D3DXVECTOR2& v3 = (p1 + 2 < (int)spaced.size()) ? spaced[p1 + 2] : v2;
+
+        // compute and add calmull-rom points
+        D3DXVECTOR2 result;
+        waypointList->push_back(*D3DXVec2CatmullRom(&result, &v0, &v1, &v2, &v3, 0.25f));
+        waypointList->push_back(*D3DXVec2CatmullRom(&result, &v0, &v1, &v2, &v3, 0.50f));
+        waypointList->push_back(*D3DXVec2CatmullRom(&result, &v0, &v1, &v2, &v3, 0.75f));
+        waypointList->push_back(v2);
+    }
+}
@@ -0,0 +1,19 @@
+/*******************************************************************************
+* Game Development Project
+* PathWaypoints.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Built path waypoints and post-processing
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+
+/* waypoint positions (built and cached paths) */
+typedef std::vector<D3DXVECTOR2> PathWaypointArray;
+
+/* catmull-rom smoothing of a built path (evenly spaced points) */
+void SmoothWaypoints(PathWaypointArray* waypointList);
@@ -18,7 +18,6 @@ enum StateName
 {
 	STATE_Initialize,   // note: first enum is the starting state
 	STATE_PursuePlayer,
-    STATE_FollowPlayerPath,
 	STATE_LostPlayer,
     STATE_AttackPlayer,
     STATE_Damaged,
@@ -39,7 +38,8 @@ enum SubstateName
 SMCombat::SMCombat( GameObject* object, objectID pid, bool damaged ) :
     StateMachine( *object ),
     m_idPlayer(pid),
-    m_bDamaged(damaged)
+    m_bDamaged(damaged),
+    m_vTarget(0.0f, 0.0f)
 {}
 
 /**
@@ -86,82 +86,63 @@ BeginStateMachine
 	
     DeclareState( STATE_PursuePlayer )
 
-		OnEnter
-
-            // create path to player
-            GameObject* player = g_database.Find(m_idPlayer);
-
-            // start path computation request
-            g_world.AddPathRequest(m_owner->GetGridPosition(), player->GetGridPosition(), m_owner->GetID());
-
-        OnMsg(MSG_PathComputed)
-
-            // follow path
-            ChangeStateDelayed(0.1f, STATE_FollowPlayerPath);
-
-    /*-------------------------------------------------------------------------*/
-	
-    DeclareState( STATE_FollowPlayerPath )
-
         OnEnter
 
             // set velocity and acceleration
             m_owner->SetVelocity(2.0f);
             m_owner->SetAcceleration(0.5f);
 
+            // target the player's current position
+            m_vTarget = g_database.Find(m_idPlayer)->GetGridPosition();
+
         OnUpdate
 
-            PathWaypointList* waypointList = g_world.GetWaypointList(m_owner->GetID());
+            GameObject* player = g_database.Find(m_idPlayer);
 
             // check if touched player
-            D3DXVECTOR2 vPlayerDist = m_owner->GetGridPosition() - g_database.Find(m_idPlayer)->GetGridPosition();
+            D3DXVECTOR2 vPlayerDist = m_owner->GetGridPosition() - player->GetGridPosition();
+            bool bAtTarget = (int)m_owner->GetGridPosition().x == (int)m_vTarget.x &&
+                             (int)m_owner->GetGridPosition().y == (int)m_vTarget.y;
             if( D3DXVec2Length(&vPlayerDist) < 0.5f )
             {
                 ChangeState(STATE_AttackPlayer);
             }
 
-            // if out of waypoints
-            else if(waypointList->empty())
+            // if targeted cell reached, check if player out of range
+            else if( bAtTarget && D3DXVec2Length(&vPlayerDist) > 5.0f )
             {
-                // check if player out of range
-                if( D3DXVec2Length(&vPlayerDist) > 5.0f )
-                {
-                    ChangeState(STATE_LostPlayer);
-                }
+                ChangeState(STATE_LostPlayer);
+            }
 
-                // else, pick new path
-                else
-                {
-                    ChangeState( STATE_PursuePlayer );
-                }
-            }            
-                
-            // move towards waypoint
+            // move along the pursuit plan, repaired as the target moves
             else
             {
-                // determine direction (ignore height)
-                D3DXVECTOR2 vDirection = (*waypointList->begin()) - m_owner->GetGridPosition();
-
-                // determine if the object has arrived
-	            if( D3DXVec2Length( &vDirection ) < 0.1f )
+                // else, target the player again
+                if( bAtTarget )
                 {
-                    // pop off waypoint
-                    waypointList->pop_front();
+                    m_vTarget = player->GetGridPosition();
                 }
-                else
+
+                D3DXVECTOR2 vDirection;
+                PursuitStatus status = g_world.GetPursuitDirection(m_owner->GetID(), m_owner->GetGridPosition(), m_vTarget, &vDirection);
+                if( status == kPursuitMove )
                 {
-                    // set object direction towards position
-                    D3DXVec2Normalize(&vDirection, &vDirection);
                     m_owner->SetGridDirection(vDirection);
                 }
+
+                // player cannot be reached
+                else if( status == kPursuitUnreachable )
+                {
+                    ChangeState(STATE_LostPlayer);
+                }
+
+                // else, keep heading until the plan is finished
             }
 
         OnExit
 
-            // remove any waypoints
-            g_world.ClearWaypointList(m_owner->GetID());
-
-            // reset object
+            // release pursuit plan and reset object
+            g_world.ReleasePursuit(m_owner->GetID());
             m_owner->ResetMovement();
 
 	/*-------------------------------------------------------------------------*/
@@ -23,4 +23,5 @@ class SMCombat : public StateMachine
 
         objectID m_idPlayer;    // player object id
         bool m_bDamaged;        // player damaged (initialize only)
+        D3DXVECTOR2 m_vTarget;  // player position when last targeted
 };
@@ -13,6 +13,15 @@
 #include "SMPatrol.h"
 #include "SMCombat.h"
 #include "WorldData.h"
+#include "InfluenceMap.h"
+
+// cells around the patrol position a patroller may stop at, and the weights
+// given to the influence layers: avoid spots other NPCs hold, lean towards
+// where the player was last seen
+static const float kPatrolSpread = 4.0f;
+static const float kPatrolThreatWeight = 0.25f;
+static const float kPatrolOccupancyWeight = -1.0f;
+static const float kPatrolJitter = 0.1f;
 
 // add new states
 enum StateName 
@@ -35,7 +44,8 @@ enum SubstateName
 SMPatrol::SMPatrol( GameObject* object, const D3DXVECTOR2& vPatrolPos, objectID pid ) :
     StateMachine( *object ),
     m_vPatrolPos(vPatrolPos),
-    m_idPlayer(pid)
+    m_idPlayer(pid),
+    m_hWaypoints(g_world.GetWaypointHandle(object->GetID()))
 {}
 
 /**
@@ -64,8 +74,13 @@ BeginStateMachine
 
         OnEnter
 
+            // pick a spot near the patrol position from the influence map
+            D3DXVECTOR2 vDest = m_vPatrolPos;
+            InfluenceQuery query = { m_vPatrolPos, kPatrolSpread, { kPatrolThreatWeight, kPatrolOccupancyWeight, 0.0f }, kPatrolJitter };
+            g_influence.FindDestination(query, &vDest);
+
             // start path computation request
-            g_world.AddPathRequest(m_owner->GetGridPosition(), m_vPatrolPos, m_owner->GetID());
+            g_world.AddPathRequest(m_owner->GetGridPosition(), vDest, m_owner->GetID());
 
         OnMsg(MSG_PathComputed)
             
@@ -84,7 +99,7 @@ BeginStateMachine
 
         OnUpdate
 
-            PathWaypointList* waypointList = g_world.GetWaypointList(m_owner->GetID());
+            PathWaypointList* waypointList = g_world.GetWaypointList(m_hWaypoints);
 
             // check if player nearby               
             D3DXVECTOR3 vPlayerDist = m_owner->GetPosition() - g_database.Find(m_idPlayer)->GetPosition();
@@ -104,7 +119,7 @@ BeginStateMachine
             else
             {                
                 // determine direction (ignore height)
-                D3DXVECTOR2 vDirection = (*waypointList->begin()) - m_owner->GetGridPosition();
+                D3DXVECTOR2 vDirection = waypointList->front() - m_owner->GetGridPosition();
 
                 // determine if the object has arrived
 	            if( D3DXVec2Length( &vDirection ) < 0.1f )
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "statemch.h"
+#include "WaypointStore.h"
 
 class SMPatrol : public StateMachine
 {
@@ -27,4 +28,5 @@ class SMPatrol : public StateMachine
         // data
         D3DXVECTOR2 m_vPatrolPos;       // patrol position
         objectID m_idPlayer;            // player object id
+        WaypointHandle m_hWaypoints;    // owner waypoint list
 };
@@ -34,7 +34,8 @@ enum SubstateName
 */
 SMRandomPath::SMRandomPath( GameObject* object, objectID pid ) :
     StateMachine( *object ),
-    m_idPlayer(pid)
+    m_idPlayer(pid),
+    m_hWaypoints(g_world.GetWaypointHandle(object->GetID()))
 {}
 
 /**
@@ -88,7 +89,7 @@ BeginStateMachine
 
         OnUpdate
 
-            PathWaypointList* waypointList = g_world.GetWaypointList(m_owner->GetID());
+            PathWaypointList* waypointList = g_world.GetWaypointList(m_hWaypoints);
 
             // check if player nearby               
             D3DXVECTOR3 vPlayerDist = m_owner->GetPosition() - g_database.Find(m_idPlayer)->GetPosition();
@@ -107,7 +108,7 @@ BeginStateMachine
             else
             {
                 // determine direction (ignore height)
-                D3DXVECTOR2 vDirection = (*waypointList->begin()) - m_owner->GetGridPosition();
+                D3DXVECTOR2 vDirection = waypointList->front() - m_owner->GetGridPosition();
 
                 // determine if the object has arrived
 	            if( D3DXVec2Length( &vDirection ) < 0.1f )
@@ -11,6 +11,7 @@
 
 #pragma once
 #include "statemch.h"
+#include "WaypointStore.h"
 
 class SMRandomPath : public StateMachine
 {
@@ -24,4 +25,5 @@ class SMRandomPath : public StateMachine
         virtual bool States( State_Machine_Event event, MSG_Object* msg, int state, int substate );
 
         objectID m_idPlayer;                // player object id
+        WaypointHandle m_hWaypoints;        // owner waypoint list
 };
\ No newline at end of file
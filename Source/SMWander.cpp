@@ -13,6 +13,15 @@
 #include "SMWander.h"
 #include "SMCombat.h"
 #include "collision.h"
+#include "InfluenceMap.h"
+
+// destination search radius (cells), and the weights wanderers give the
+// influence layers: spread out from other NPCs, drift towards where the
+// player was last seen
+static const float kWanderRadius = 8.0f;
+static const float kWanderThreatWeight = 0.5f;
+static const float kWanderOccupancyWeight = -1.0f;
+static const float kWanderJitter = 0.25f;
 
 // add new states
 enum StateName 
@@ -125,9 +134,19 @@ BeginStateMachine
 
         OnPeriodicTimeInState(1.0f)
         
-            // randomly adjust direction by a small amount periodically
-            float fYawRotate = D3DX_PI/3.0f * (1 - rand() % 3);
-            m_owner->SetDirection( RotateVector(m_owner->GetDirection(), fYawRotate) );
+            // periodically head for a destination picked from the influence map
+            D3DXVECTOR2 vDest;
+            if( PickDestination(&vDest) )
+            {
+                m_owner->SetGridDirection( vDest - m_owner->GetGridPosition() );
+            }
+
+            // otherwise randomly adjust direction by a small amount
+            else
+            {
+                float fYawRotate = D3DX_PI/3.0f * (1 - rand() % 3);
+                m_owner->SetDirection( RotateVector(m_owner->GetDirection(), fYawRotate) );
+            }
 
         OnExit
 
@@ -184,6 +203,22 @@ void SMWander::UpdateFeelers()
     //m_vRightFeeler = m_vRightFeeler * mxRotate;
 }
 
+/**
+* Picks the best scoring influence map cell near the object. Fails if there
+* is none or it is the object's own cell.
+*/
+bool SMWander::PickDestination(D3DXVECTOR2* vDest)
+{
+    D3DXVECTOR2 vPos = m_owner->GetGridPosition();
+    InfluenceQuery query = { vPos, kWanderRadius, { kWanderThreatWeight, kWanderOccupancyWeight, 0.0f }, kWanderJitter };
+
+    if( !g_influence.FindDestination(query, vDest) )
+        return false;
+
+    D3DXVECTOR2 vOffset = *vDest - vPos;
+    return D3DXVec2Length(&vOffset) >= 1.0f;
+}
+
 /**
 * Rotate direction
 */
@@ -25,6 +25,7 @@ class SMWander : public StateMachine
 
         // helper functions
         void UpdateFeelers();
+        bool PickDestination(D3DXVECTOR2* vDest);
         D3DXVECTOR3 RotateVector(const D3DXVECTOR3& vVec, const float& fYaw);
 
 
@@ -0,0 +1,171 @@
+/*******************************************************************************
+* Game Development Project
+* TerrainGrid.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Aligned multi-layer grid for terrain analysis
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "TerrainGrid.h"
+#include <stdlib.h>
+#include <malloc.h>
+
+#ifdef TERRAIN_GRID_SSE
+#include <emmintrin.h>
+#endif
+
+/**
+* Converts a color channel to a byte (as D3DXCOLOR to D3DCOLOR)
+*/
+static unsigned int ColorChannel(float f)
+{
+    return f >= 1.0f ? 0xff : f <= 0.0f ? 0x00 : (unsigned int)(f * 255.0f + 0.5f);
+}
+
+/**
+* Constructor
+*/
+TerrainGrid::TerrainGrid(int iWidth, int iHeight, int iLayers) :
+    m_iWidth(iWidth),
+    m_iHeight(iHeight),
+    m_iLayers(iLayers),
+    m_iStride((iWidth + 3) & ~3),
+    m_pCells(NULL)
+{
+    size_t size = (size_t)m_iStride * m_iHeight * m_iLayers * sizeof(float);
+
+#ifdef _WIN32
+    m_pCells = (float*)_aligned_malloc(size, kTerrainGridAlignment);
+#else
+    void* pCells = NULL;
+    if( posix_memalign(&pCells, kTerrainGridAlignment, size) == 0 )
+        m_pCells = (float*)pCells;
+#endif
+}
+
+/**
+* Deconstructor
+*/
+TerrainGrid::~TerrainGrid()
+{
+#ifdef _WIN32
+    _aligned_free(m_pCells);
+#else
+    free(m_pCells);
+#endif
+}
+
+/**
+* Sets every cell of a layer (padding included)
+*/
+void TerrainGrid::Clear(int iLayer, float fValue)
+{
+    float* pCell = GetRow(iLayer, 0);
+    float* pEnd = pCell + m_iStride * m_iHeight;
+
+#ifdef TERRAIN_GRID_SSE
+    __m128 value = _mm_set1_ps(fValue);
+    for(; pCell != pEnd; pCell += 4)
+        _mm_store_ps(pCell, value);
+#else
+    for(; pCell != pEnd; ++pCell)
+        *pCell = fValue;
+#endif
+}
+
+/**
+* Adds a value to the cells of a row span (inclusive, clipped to the grid)
+* and clamps them to a range.
+*/
+void TerrainGrid::AddSpan(int iLayer, int iRow, int iColMin, int iColMax, float fValue, float fMin, float fMax)
+{
+    if( iRow < 0 || iRow >= m_iHeight )
+        return;
+
+    iColMin = max(iColMin, 0);
+    iColMax = min(iColMax, m_iWidth - 1);
+
+    float* pRow = GetRow(iLayer, iRow);
+    int iCol = iColMin;
+
+#ifdef TERRAIN_GRID_SSE
+    // cells up to the next aligned group
+    for(; iCol <= iColMax && (iCol & 3); ++iCol)
+        pRow[iCol] = min(fMax, max(fMin, pRow[iCol] + fValue));
+
+    // aligned groups of four
+    __m128 value = _mm_set1_ps(fValue);
+    __m128 low = _mm_set1_ps(fMin);
+    __m128 high = _mm_set1_ps(fMax);
+    for(; iCol + 3 <= iColMax; iCol += 4)
+    {
+        __m128 cells = _mm_add_ps(_mm_load_ps(pRow + iCol), value);
+        _mm_store_ps(pRow + iCol, _mm_min_ps(high, _mm_max_ps(low, cells)));
+    }
+#endif
+
+    // remaining cells
+    for(; iCol <= iColMax; ++iCol)
+        pRow[iCol] = min(fMax, max(fMin, pRow[iCol] + fValue));
+}
+
+/**
+* Converts a row to colors, one layer per channel (-1 for a black channel).
+* Channels are clamped to [0,1]. Writes one ARGB color per cell.
+*/
+void TerrainGrid::BlendColors(int iRow, int iRedLayer, int iGreenLayer, int iBlueLayer, float fAlpha, unsigned int* colors) const
+{
+    const float* pRed = iRedLayer != -1 ? GetRow(iRedLayer, iRow) : NULL;
+    const float* pGreen = iGreenLayer != -1 ? GetRow(iGreenLayer, iRow) : NULL;
+    const float* pBlue = iBlueLayer != -1 ? GetRow(iBlueLayer, iRow) : NULL;
+    unsigned int uAlpha = ColorChannel(fAlpha) << 24;
+    int iCol = 0;
+
+#ifdef TERRAIN_GRID_SSE
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 scale = _mm_set1_ps(255.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128i alpha = _mm_set1_epi32((int)uAlpha);
+
+    for(; iCol + 3 < m_iWidth; iCol += 4)
+    {
+        __m128i color = alpha;
+
+        if(pRed)
+        {
+            __m128 r = _mm_min_ps(one, _mm_max_ps(zero, _mm_load_ps(pRed + iCol)));
+            color = _mm_or_si128(color, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half)), 16));
+        }
+        if(pGreen)
+        {
+            __m128 g = _mm_min_ps(one, _mm_max_ps(zero, _mm_load_ps(pGreen + iCol)));
+            color = _mm_or_si128(color, _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half)), 8));
+        }
+        if(pBlue)
+        {
+            __m128 b = _mm_min_ps(one, _mm_max_ps(zero, _mm_load_ps(pBlue + iCol)));
+            color = _mm_or_si128(color, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half)));
+        }
+
+        _mm_storeu_si128((__m128i*)(colors + iCol), color);
+    }
+#endif
+
+    // remaining cells
+    for(; iCol < m_iWidth; ++iCol)
+    {
+        unsigned int uColor = uAlpha;
+        if(pRed)
+            uColor |= ColorChannel(pRed[iCol]) << 16;
+        if(pGreen)
+            uColor |= ColorChannel(pGreen[iCol]) << 8;
+        if(pBlue)
+            uColor |= ColorChannel(pBlue[iCol]);
+        colors[iCol] = uColor;
+    }
+}
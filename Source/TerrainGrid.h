@@ -0,0 +1,64 @@
+/*******************************************************************************
+* Game Development Project
+* TerrainGrid.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Aligned multi-layer grid for terrain analysis
+*
+*******************************************************************************/
+
+#pragma once
+
+// SSE2 kernels on x86/x64 builds; other targets use the scalar loops
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define TERRAIN_GRID_SSE
+#endif
+
+// byte alignment of every layer row
+const int kTerrainGridAlignment = 16;
+
+/**
+* Float grid with several layers in one allocation. Each layer is a
+* contiguous row-major block, and rows are padded to a multiple of four
+* floats so that every row starts on a 16 byte boundary. The kernels walk
+* rows in memory order and process four cells per instruction (scalar
+* loops when SSE is not available); padding cells are never read back.
+*/
+class TerrainGrid
+{
+    public:
+
+        // constructor (cells are not initialized)
+        TerrainGrid(int iWidth, int iHeight, int iLayers);
+        ~TerrainGrid();
+
+        // grid info
+        int GetWidth() const { return m_iWidth; }
+        int GetHeight() const { return m_iHeight; }
+        int GetLayerCount() const { return m_iLayers; }
+
+        // cell access
+        float* GetRow(int iLayer, int iRow) { return m_pCells + (iLayer * m_iHeight + iRow) * m_iStride; }
+        const float* GetRow(int iLayer, int iRow) const { return m_pCells + (iLayer * m_iHeight + iRow) * m_iStride; }
+        float& operator()(int iLayer, int iRow, int iCol) { return GetRow(iLayer, iRow)[iCol]; }
+        float operator()(int iLayer, int iRow, int iCol) const { return GetRow(iLayer, iRow)[iCol]; }
+
+        // kernels
+        void Clear(int iLayer, float fValue);
+        void AddSpan(int iLayer, int iRow, int iColMin, int iColMax, float fValue, float fMin, float fMax);
+        void BlendColors(int iRow, int iRedLayer, int iGreenLayer, int iBlueLayer, float fAlpha, unsigned int* colors) const;
+
+    private:
+
+        int m_iWidth;
+        int m_iHeight;
+        int m_iLayers;
+        int m_iStride;              // floats per row (padded)
+        float* m_pCells;            // layers (aligned)
+
+        // prevent copy and assignment
+        TerrainGrid(const TerrainGrid&);
+        TerrainGrid& operator=(const TerrainGrid&);
+};
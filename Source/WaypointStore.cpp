@@ -0,0 +1,226 @@
+/*******************************************************************************
+* Game Development Project
+* WaypointStore.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Pooled per-agent waypoint lists
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "WaypointStore.h"
+
+// initial ring buffer size (power of two), and waypoints per arena slab
+static const int kMinWaypointCapacity = 16;
+static const int kArenaSlabSize = 4096;
+
+/**
+* Constructor
+*/
+PathWaypointList::PathWaypointList() :
+    m_pStore(NULL),
+    m_pBuffer(NULL),
+    m_iCapacity(0),
+    m_iHead(0),
+    m_iCount(0)
+{}
+
+/**
+* Removes the front waypoint
+*/
+void PathWaypointList::pop_front()
+{
+    m_iHead = (m_iHead + 1) & (m_iCapacity - 1);
+    --m_iCount;
+}
+
+/**
+* Adds a waypoint to the back
+*/
+void PathWaypointList::push_back(const D3DXVECTOR2& vWaypoint)
+{
+    Reserve(m_iCount + 1);
+    m_pBuffer[(m_iHead + m_iCount) & (m_iCapacity - 1)] = vWaypoint;
+    ++m_iCount;
+}
+
+/**
+* Adds waypoints from the specified index onwards to the back
+*/
+void PathWaypointList::append(const PathWaypointArray& waypoints, int iFirst)
+{
+    Reserve(m_iCount + (int)waypoints.size() - iFirst);
+    for(int i = iFirst; i < (int)waypoints.size(); ++i)
+    {
+        m_pBuffer[(m_iHead + m_iCount) & (m_iCapacity - 1)] = waypoints[i];
+        ++m_iCount;
+    }
+}
+
+/**
+* Grows the ring buffer to hold the specified number of waypoints. Waypoints
+* are moved to the start of a larger block and the old block is returned to
+* the store.
+*/
+void PathWaypointList::Reserve(int iCount)
+{
+    if( iCount <= m_iCapacity )
+        return;
+
+    int iCapacity = m_iCapacity ? m_iCapacity : kMinWaypointCapacity;
+    while( iCapacity < iCount )
+        iCapacity *= 2;
+
+    D3DXVECTOR2* pBuffer = m_pStore->AllocateBlock(iCapacity);
+    for(int i = 0; i < m_iCount; ++i)
+        pBuffer[i] = (*this)[i];
+
+    if(m_pBuffer)
+        m_pStore->FreeBlock(m_pBuffer, m_iCapacity);
+
+    m_pBuffer = pBuffer;
+    m_iCapacity = iCapacity;
+    m_iHead = 0;
+}
+
+/**
+* Constructor
+*/
+WaypointStore::WaypointStore() :
+    m_iSlotCount(0),
+    m_pArenaNext(NULL),
+    m_iArenaRemaining(0),
+    m_iArenaSize(0)
+{}
+
+/**
+* Deconstructor
+*/
+WaypointStore::~WaypointStore()
+{
+    for(std::vector<PathWaypointList*>::iterator slab = m_vSlotSlabs.begin(); slab != m_vSlotSlabs.end(); ++slab)
+    {
+        delete [] (*slab);
+    }
+
+    for(std::vector<D3DXVECTOR2*>::iterator slab = m_vArenaSlabs.begin(); slab != m_vArenaSlabs.end(); ++slab)
+    {
+        delete [] (*slab);
+    }
+}
+
+/**
+* Hands out an empty waypoint list, reusing a released slot if there is one
+*/
+WaypointHandle WaypointStore::Allocate()
+{
+    WaypointHandle handle;
+    if( !m_vFreeSlots.empty() )
+    {
+        handle = m_vFreeSlots.back();
+        m_vFreeSlots.pop_back();
+    }
+    else
+    {
+        if( (m_iSlotCount & (kSlotSlabSize - 1)) == 0 )
+            m_vSlotSlabs.push_back(new PathWaypointList[kSlotSlabSize]);
+
+        handle = m_iSlotCount++;
+    }
+
+    Get(handle)->m_pStore = this;
+    return handle;
+}
+
+/**
+* Returns a waypoint list and its buffer block to the pool. The handle must
+* not be used afterwards.
+*/
+void WaypointStore::Release(WaypointHandle handle)
+{
+    PathWaypointList* waypointList = Get(handle);
+    if(waypointList->m_pBuffer)
+        FreeBlock(waypointList->m_pBuffer, waypointList->m_iCapacity);
+
+    waypointList->m_pBuffer = NULL;
+    waypointList->m_iCapacity = 0;
+    waypointList->clear();
+
+    m_vFreeSlots.push_back(handle);
+}
+
+/**
+* Returns a block for the power of two number of waypoints: a released block
+* of that size, or one carved from the arena. A slab too small for the block
+* is split into free blocks and a new slab is started; blocks larger than a
+* slab get a slab of their own.
+*/
+D3DXVECTOR2* WaypointStore::AllocateBlock(int iCapacity)
+{
+    int iClass = GetBlockClass(iCapacity);
+    assert(iClass < kBlockClassCount);
+
+    // reuse a released block
+    if( !m_vFreeBlocks[iClass].empty() )
+    {
+        D3DXVECTOR2* pBlock = m_vFreeBlocks[iClass].back();
+        m_vFreeBlocks[iClass].pop_back();
+        return pBlock;
+    }
+
+    // large block
+    if( iCapacity > kArenaSlabSize )
+    {
+        D3DXVECTOR2* pBlock = new D3DXVECTOR2[iCapacity];
+        m_vArenaSlabs.push_back(pBlock);
+        m_iArenaSize += iCapacity;
+        return pBlock;
+    }
+
+    // new slab, keeping the rest of the last one as free blocks
+    if( m_iArenaRemaining < iCapacity )
+    {
+        while( m_iArenaRemaining >= kMinWaypointCapacity )
+        {
+            int iPiece = kMinWaypointCapacity;
+            while( iPiece * 2 <= m_iArenaRemaining )
+                iPiece *= 2;
+
+            m_vFreeBlocks[GetBlockClass(iPiece)].push_back(m_pArenaNext);
+            m_pArenaNext += iPiece;
+            m_iArenaRemaining -= iPiece;
+        }
+
+        m_pArenaNext = new D3DXVECTOR2[kArenaSlabSize];
+        m_vArenaSlabs.push_back(m_pArenaNext);
+        m_iArenaRemaining = kArenaSlabSize;
+        m_iArenaSize += kArenaSlabSize;
+    }
+
+    D3DXVECTOR2* pBlock = m_pArenaNext;
+    m_pArenaNext += iCapacity;
+    m_iArenaRemaining -= iCapacity;
+    return pBlock;
+}
+
+/**
+* Keeps a block for reuse by the next list needing its size
+*/
+void WaypointStore::FreeBlock(D3DXVECTOR2* pBlock, int iCapacity)
+{
+    m_vFreeBlocks[GetBlockClass(iCapacity)].push_back(pBlock);
+}
+
+/**
+* Returns the size class of a power of two block size
+*/
+int WaypointStore::GetBlockClass(int iCapacity) const
+{
+    int iClass = 0;
+    while( (kMinWaypointCapacity << iClass) < iCapacity )
+        ++iClass;
+
+    return iClass;
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Game Development Project
+* WaypointStore.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Pooled per-agent waypoint lists
+*
+*******************************************************************************/
+
+#pragma once
+#include <vector>
+#include "PathWaypoints.h"
+
+/* waypoint list handle (store slot index) */
+typedef int WaypointHandle;
+
+class WaypointStore;
+
+/**
+* Waypoints an agent has yet to reach, stored in a contiguous ring buffer
+* carved from the pooled blocks of its store. Popping the front and appending
+* refined segments never allocate once the buffer has grown to the longest
+* path the agent followed; a grown list returns its old block to the pool.
+*/
+class PathWaypointList
+{
+    public:
+
+        // constructor
+        PathWaypointList();
+
+        // waypoints
+        bool empty() const { return m_iCount == 0; }
+        int size() const { return m_iCount; }
+        const D3DXVECTOR2& front() const { return m_pBuffer[m_iHead]; }
+        const D3DXVECTOR2& back() const { return (*this)[m_iCount - 1]; }
+        const D3DXVECTOR2& operator[](int i) const { return m_pBuffer[(m_iHead + i) & (m_iCapacity - 1)]; }
+
+        void pop_front();
+        void push_back(const D3DXVECTOR2& vWaypoint);
+        void append(const PathWaypointArray& waypoints, int iFirst);
+        void clear() { m_iHead = 0; m_iCount = 0; }
+
+    private:
+
+        friend class WaypointStore;
+
+        WaypointStore* m_pStore;            // store owning the buffer block
+        D3DXVECTOR2* m_pBuffer;             // ring buffer (null until the first waypoint)
+        int m_iCapacity;                    // buffer size (power of two)
+        int m_iHead;                        // front waypoint index
+        int m_iCount;                       // waypoints in the list
+
+        void Reserve(int iCount);
+
+        // prevent copy and assignment
+        PathWaypointList(const PathWaypointList&);
+        PathWaypointList& operator=(const PathWaypointList&);
+};
+
+/**
+* Pooled waypoint lists, one per agent. Lists live in fixed slabs of slots,
+* so a handle lookup is two array accesses and a list never moves while its
+* handle is held. Ring buffers are blocks of power of two sizes carved from
+* shared arena slabs; released blocks are kept on a free list per size and
+* reused by the next list needing that size. Released slots are reused by
+* the next allocation. Memory is returned when the store is destroyed.
+*/
+class WaypointStore
+{
+    public:
+
+        // constructor
+        WaypointStore();
+        ~WaypointStore();
+
+        // slots
+        WaypointHandle Allocate();
+        void Release(WaypointHandle handle);
+        PathWaypointList* Get(WaypointHandle handle) { return &m_vSlotSlabs[handle >> kSlotSlabShift][handle & (kSlotSlabSize - 1)]; }
+
+        // buffer blocks (power of two sizes)
+        D3DXVECTOR2* AllocateBlock(int iCapacity);
+        void FreeBlock(D3DXVECTOR2* pBlock, int iCapacity);
+
+        // pool info
+        int GetSlotCount() const { return m_iSlotCount - (int)m_vFreeSlots.size(); }
+        int GetArenaSize() const { return m_iArenaSize; }
+
+    private:
+
+        static const int kSlotSlabShift = 6;                        // 64 lists per slot slab
+        static const int kSlotSlabSize = 1 << kSlotSlabShift;
+        static const int kBlockClassCount = 20;                     // block sizes 16 to 8M waypoints
+
+        // slots
+        std::vector<PathWaypointList*> m_vSlotSlabs;    // list slabs by handle
+        std::vector<WaypointHandle> m_vFreeSlots;       // released handles
+        int m_iSlotCount;                               // slots handed out
+
+        // arena
+        std::vector<D3DXVECTOR2*> m_vArenaSlabs;                    // arena slabs (owned)
+        D3DXVECTOR2* m_pArenaNext;                                  // uncarved part of the last slab
+        int m_iArenaRemaining;                                      // waypoints left in the last slab
+        int m_iArenaSize;                                           // waypoints in all slabs
+        std::vector<D3DXVECTOR2*> m_vFreeBlocks[kBlockClassCount];  // released blocks by size class
+
+        int GetBlockClass(int iCapacity) const;
+
+        // prevent copy and assignment
+        WaypointStore(const WaypointStore&);
+        WaypointStore& operator=(const WaypointStore&);
+};
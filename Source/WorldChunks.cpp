@@ -0,0 +1,551 @@
+/*******************************************************************************
+* Game Development Project
+* WorldChunks.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Streaming of fixed-size world chunks around active agents
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "WorldChunks.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <utility>
+
+// chunk builds per frame when loading on the main thread
+static const int kMainThreadLoadsPerFrame = 2;
+
+/**
+* Constructor. Starts the loader thread (chunks are built on the main thread
+* if it cannot be started).
+*/
+WorldChunks::WorldChunks(const WorldFile& worldFile, int iLoadRadius, int iMaxChunks) :
+    m_worldFile(worldFile),
+    m_iChunksX((worldFile.GetWidth() + kWorldChunkSize - 1) / kWorldChunkSize),
+    m_iChunksY((worldFile.GetHeight() + kWorldChunkSize - 1) / kWorldChunkSize),
+    m_uWorldVersion(worldFile.GetVersion()),
+    m_iLoadRadius(iLoadRadius),
+    m_iMaxChunks(iMaxChunks),
+    m_uFrame(0),
+    m_iLoading(0),
+    m_iLoadedTotal(0),
+    m_hThread(NULL),
+    m_bShutdown(false)
+{
+    ChunkSlot slot;
+    slot.state = kChunkUnloaded;
+    slot.bReloading = false;
+    slot.bStale = false;
+    slot.uWantedFrame = 0;
+    slot.uKeptFrame = 0;
+    slot.iDistance = 0;
+    m_vSlots.assign(m_iChunksX * m_iChunksY, slot);
+
+    InitializeCriticalSection(&m_queueLock);
+    m_hJobSemaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+    m_hCompleteEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    m_hThread = CreateThread(NULL, 0, ThreadProc, this, 0, NULL);
+}
+
+/**
+* Deconstructor. Stops the loader and deletes all chunk data.
+*/
+WorldChunks::~WorldChunks()
+{
+    // signal shutdown and wake the loader
+    EnterCriticalSection(&m_queueLock);
+    m_bShutdown = true;
+    LeaveCriticalSection(&m_queueLock);
+
+    if(m_hThread)
+    {
+        ReleaseSemaphore(m_hJobSemaphore, 1, NULL);
+        WaitForSingleObject(m_hThread, INFINITE);
+        CloseHandle(m_hThread);
+    }
+
+    // delete jobs and their data
+    m_completed.insert(m_completed.end(), m_jobQueue.begin(), m_jobQueue.end());
+    m_jobQueue.clear();
+    for(std::vector<ChunkJob*>::iterator job = m_completed.begin(); job != m_completed.end(); ++job)
+    {
+        for(std::vector<WorldChunkData*>::iterator data = (*job)->data.begin(); data != (*job)->data.end(); ++data)
+            delete (*data);
+        delete (*job);
+    }
+
+    // delete chunk data
+    for(std::vector<int>::iterator chunk = m_vLive.begin(); chunk != m_vLive.end(); ++chunk)
+    {
+        Unload(*chunk);
+    }
+
+    CloseHandle(m_hCompleteEvent);
+    CloseHandle(m_hJobSemaphore);
+    DeleteCriticalSection(&m_queueLock);
+}
+
+/**
+* Registers a client. Every chunk loaded afterwards includes its data.
+*/
+int WorldChunks::AddClient(WorldChunkClient* client)
+{
+    assert(m_vLive.empty() && "chunk clients must register before chunks load");
+
+    m_vClients.push_back(client);
+    return (int)m_vClients.size() - 1;
+}
+
+/**
+* Returns the chunk holding a cell (-1 outside the world)
+*/
+int WorldChunks::GetChunkIndex(int iRow, int iCol) const
+{
+    if( iRow < 0 || iRow >= m_worldFile.GetHeight() || iCol < 0 || iCol >= m_worldFile.GetWidth() )
+        return -1;
+
+    return (iRow / kWorldChunkSize) * m_iChunksX + (iCol / kWorldChunkSize);
+}
+
+/**
+* Returns the cells of a chunk
+*/
+void WorldChunks::GetChunkBounds(int iChunk, WorldChunkBounds* bounds) const
+{
+    bounds->iRowMin = (iChunk / m_iChunksX) * kWorldChunkSize;
+    bounds->iColMin = (iChunk % m_iChunksX) * kWorldChunkSize;
+    bounds->iRowMax = std::min(bounds->iRowMin + kWorldChunkSize, m_worldFile.GetHeight()) - 1;
+    bounds->iColMax = std::min(bounds->iColMin + kWorldChunkSize, m_worldFile.GetWidth()) - 1;
+}
+
+/**
+* Returns a client's data of a resident chunk (null if not resident)
+*/
+WorldChunkData* WorldChunks::GetChunkData(int iClient, int iChunk) const
+{
+    if( iChunk < 0 || m_vSlots[iChunk].state != kChunkResident )
+        return NULL;
+
+    return m_vSlots[iChunk].data[iClient];
+}
+
+/**
+* Streams chunks around the focus points:
+*
+* 1. Publish chunks built since the last update
+* 2. Rebuild chunks whose cells changed
+* 3. Release chunks outside the keep radius, then ring chunks over the cap
+* 4. Queue loads of wanted chunks (nearest first, up to the chunk cap)
+*/
+void WorldChunks::Update(const std::vector<D3DXVECTOR2>& focusPoints, bool bWait)
+{
+    ++m_uFrame;
+
+    // publish completed builds
+    m_vPublished.clear();
+    CollectCompletedJobs();
+
+    // rebuild changed chunks
+    ApplyCellChanges();
+
+    // find wanted chunks, nearest first
+    std::vector<int> wanted;
+    MarkFocus(focusPoints, &wanted);
+
+    std::vector< std::pair<int, int> > byDistance;
+    byDistance.reserve(wanted.size());
+    for(std::vector<int>::iterator chunk = wanted.begin(); chunk != wanted.end(); ++chunk)
+        byDistance.push_back( std::make_pair(m_vSlots[*chunk].iDistance, *chunk) );
+    std::sort(byDistance.begin(), byDistance.end());
+
+    wanted.resize( std::min((int)byDistance.size(), m_iMaxChunks) );
+    for(int i = 0; i < (int)wanted.size(); ++i)
+        wanted[i] = byDistance[i].second;
+
+    // release chunks no longer kept
+    std::vector<int> live;
+    live.reserve(m_vLive.size() + wanted.size());
+    for(std::vector<int>::iterator chunk = m_vLive.begin(); chunk != m_vLive.end(); ++chunk)
+    {
+        ChunkSlot& slot = m_vSlots[*chunk];
+        if( slot.uKeptFrame != m_uFrame && (slot.state == kChunkResident || CancelJob(*chunk)) )
+            Unload(*chunk);
+        else
+            live.push_back(*chunk);
+    }
+
+    // release ring chunks (kept, not wanted) while over the cap
+    int iUnloadedWanted = 0;
+    for(std::vector<int>::iterator chunk = wanted.begin(); chunk != wanted.end(); ++chunk)
+    {
+        if( m_vSlots[*chunk].state == kChunkUnloaded )
+            ++iUnloadedWanted;
+    }
+
+    int iOverCap = (int)live.size() + iUnloadedWanted - m_iMaxChunks;
+    for(std::vector<int>::iterator chunk = live.begin(); chunk != live.end() && iOverCap > 0; )
+    {
+        ChunkSlot& slot = m_vSlots[*chunk];
+        if( slot.uWantedFrame != m_uFrame && (slot.state == kChunkResident || CancelJob(*chunk)) )
+        {
+            Unload(*chunk);
+            chunk = live.erase(chunk);
+            --iOverCap;
+        }
+        else
+        {
+            ++chunk;
+        }
+    }
+
+    // queue wanted chunks (the cap includes chunks still loading)
+    for(std::vector<int>::iterator chunk = wanted.begin(); chunk != wanted.end() && (int)live.size() < m_iMaxChunks; ++chunk)
+    {
+        if( m_vSlots[*chunk].state == kChunkUnloaded )
+        {
+            QueueJob(*chunk);
+            m_vSlots[*chunk].state = kChunkLoading;
+            live.push_back(*chunk);
+        }
+    }
+    m_vLive.swap(live);
+
+    // block until every queued chunk is resident
+    if(bWait)
+    {
+        while(m_iLoading > 0)
+        {
+            if(m_hThread)
+                WaitForSingleObject(m_hCompleteEvent, INFINITE);
+            else
+                RunQueuedJobs(INT_MAX);
+
+            CollectCompletedJobs();
+        }
+    }
+    else if(!m_hThread)
+    {
+        RunQueuedJobs(kMainThreadLoadsPerFrame);
+        CollectCompletedJobs();
+    }
+
+    // resident list for clients
+    m_vResident.clear();
+    for(std::vector<int>::iterator chunk = m_vLive.begin(); chunk != m_vLive.end(); ++chunk)
+    {
+        if( m_vSlots[*chunk].state == kChunkResident )
+            m_vResident.push_back(*chunk);
+    }
+
+    // published list for clients (chunks may publish twice or be released since)
+    std::sort(m_vPublished.begin(), m_vPublished.end());
+    m_vPublished.erase(std::unique(m_vPublished.begin(), m_vPublished.end()), m_vPublished.end());
+
+    std::vector<int>::iterator published = m_vPublished.begin();
+    for(std::vector<int>::iterator chunk = m_vPublished.begin(); chunk != m_vPublished.end(); ++chunk)
+    {
+        if( m_vSlots[*chunk].state == kChunkResident )
+            *published++ = *chunk;
+    }
+    m_vPublished.erase(published, m_vPublished.end());
+}
+
+/**
+* Stamps the chunks within the load radius (wanted) and keep radius (kept)
+* of any focus point.
+*/
+void WorldChunks::MarkFocus(const std::vector<D3DXVECTOR2>& focusPoints, std::vector<int>* wanted)
+{
+    int iKeepRadius = m_iLoadRadius + 1;
+
+    for(std::vector<D3DXVECTOR2>::const_iterator point = focusPoints.begin(); point != focusPoints.end(); ++point)
+    {
+        int iFocusX = (int)point->x / kWorldChunkSize;
+        int iFocusY = (int)point->y / kWorldChunkSize;
+
+        for(int y = std::max(0, iFocusY - iKeepRadius); y <= std::min(m_iChunksY - 1, iFocusY + iKeepRadius); ++y)
+        {
+            for(int x = std::max(0, iFocusX - iKeepRadius); x <= std::min(m_iChunksX - 1, iFocusX + iKeepRadius); ++x)
+            {
+                ChunkSlot& slot = m_vSlots[y * m_iChunksX + x];
+                slot.uKeptFrame = m_uFrame;
+
+                int iDistance = std::max(abs(x - iFocusX), abs(y - iFocusY));
+                if( iDistance > m_iLoadRadius )
+                    continue;
+
+                if( slot.uWantedFrame != m_uFrame )
+                {
+                    slot.uWantedFrame = m_uFrame;
+                    slot.iDistance = iDistance;
+                    wanted->push_back(y * m_iChunksX + x);
+                }
+                else if( iDistance < slot.iDistance )
+                {
+                    slot.iDistance = iDistance;
+                }
+            }
+        }
+    }
+}
+
+/**
+* Queues a chunk build
+*/
+void WorldChunks::QueueJob(int iChunk)
+{
+    ChunkJob* job = new ChunkJob;
+    job->iChunk = iChunk;
+
+    EnterCriticalSection(&m_queueLock);
+    m_jobQueue.push_back(job);
+    LeaveCriticalSection(&m_queueLock);
+
+    ++m_iLoading;
+    if(m_hThread)
+        ReleaseSemaphore(m_hJobSemaphore, 1, NULL);
+}
+
+/**
+* Removes a chunk build that has not started. Returns false if the loader
+* already has it (it is released once published).
+*/
+bool WorldChunks::CancelJob(int iChunk)
+{
+    ChunkJob* job = NULL;
+
+    EnterCriticalSection(&m_queueLock);
+    for(std::deque<ChunkJob*>::iterator queued = m_jobQueue.begin(); queued != m_jobQueue.end(); ++queued)
+    {
+        if( (*queued)->iChunk == iChunk )
+        {
+            job = *queued;
+            m_jobQueue.erase(queued);
+            break;
+        }
+    }
+    LeaveCriticalSection(&m_queueLock);
+
+    if(!job)
+        return false;
+
+    // the semaphore count stays; the loader skips the missing job
+    delete job;
+    --m_iLoading;
+    return true;
+}
+
+/**
+* Publishes finished builds. New chunks become resident; rebuilt chunks
+* swap their data.
+*/
+void WorldChunks::CollectCompletedJobs()
+{
+    std::vector<ChunkJob*> completed;
+
+    EnterCriticalSection(&m_queueLock);
+    completed.swap(m_completed);
+    LeaveCriticalSection(&m_queueLock);
+
+    for(std::vector<ChunkJob*>::iterator job = completed.begin(); job != completed.end(); ++job)
+    {
+        int iChunk = (*job)->iChunk;
+        ChunkSlot& slot = m_vSlots[iChunk];
+        --m_iLoading;
+
+        // chunk released while rebuilding
+        if( slot.state == kChunkUnloaded )
+        {
+            for(std::vector<WorldChunkData*>::iterator data = (*job)->data.begin(); data != (*job)->data.end(); ++data)
+                delete (*data);
+            delete (*job);
+            continue;
+        }
+
+        // release replaced data
+        for(std::vector<WorldChunkData*>::iterator data = slot.data.begin(); data != slot.data.end(); ++data)
+            delete (*data);
+
+        slot.data.swap((*job)->data);
+        slot.state = kChunkResident;
+        slot.bReloading = false;
+        ++m_iLoadedTotal;
+        m_vPublished.push_back(iChunk);
+        delete (*job);
+
+        // cells changed during the build
+        if(slot.bStale)
+        {
+            slot.bStale = false;
+            slot.bReloading = true;
+            QueueJob(iChunk);
+        }
+    }
+}
+
+/**
+* Builds queued chunks on the main thread (no loader thread)
+*/
+void WorldChunks::RunQueuedJobs(int iMaxJobs)
+{
+    while(iMaxJobs-- > 0 && !m_jobQueue.empty())
+    {
+        ChunkJob* job = m_jobQueue.front();
+        m_jobQueue.pop_front();
+
+        BuildJob(job);
+        m_completed.push_back(job);
+    }
+}
+
+/**
+* Rebuilds the chunks around changed cells (wall faces and terrain depend
+* on the neighboring cells)
+*/
+void WorldChunks::ApplyCellChanges()
+{
+    if( m_uWorldVersion == m_worldFile.GetVersion() )
+        return;
+
+    std::vector<WorldFile::CellChange> changes;
+    if( m_worldFile.GetCellChanges(m_uWorldVersion, &changes) )
+    {
+        // chunks holding a changed cell or one of its neighbors
+        std::vector<int> changed;
+        for(std::vector<WorldFile::CellChange>::iterator change = changes.begin(); change != changes.end(); ++change)
+        {
+            for(int dRow = -1; dRow <= 1; ++dRow)
+            {
+                for(int dCol = -1; dCol <= 1; ++dCol)
+                {
+                    int iChunk = GetChunkIndex(change->row + dRow, change->col + dCol);
+                    if( iChunk != -1 )
+                        changed.push_back(iChunk);
+                }
+            }
+        }
+
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for(std::vector<int>::iterator chunk = changed.begin(); chunk != changed.end(); ++chunk)
+            MarkChanged(*chunk);
+    }
+
+    // changes unknown: rebuild everything
+    else
+    {
+        for(std::vector<int>::iterator chunk = m_vLive.begin(); chunk != m_vLive.end(); ++chunk)
+            MarkChanged(*chunk);
+    }
+
+    m_uWorldVersion = m_worldFile.GetVersion();
+}
+
+/**
+* Schedules a rebuild of a loading or resident chunk
+*/
+void WorldChunks::MarkChanged(int iChunk)
+{
+    ChunkSlot& slot = m_vSlots[iChunk];
+
+    if( slot.state == kChunkLoading || slot.bReloading )
+    {
+        slot.bStale = true;
+    }
+    else if( slot.state == kChunkResident )
+    {
+        slot.bReloading = true;
+        QueueJob(iChunk);
+    }
+}
+
+/**
+* Releases a chunk's data (resident chunk, or loading chunk whose job was
+* cancelled). A rebuild still running is discarded when it completes.
+*/
+void WorldChunks::Unload(int iChunk)
+{
+    ChunkSlot& slot = m_vSlots[iChunk];
+
+    if(slot.bReloading)
+    {
+        CancelJob(iChunk);
+        slot.bReloading = false;
+    }
+
+    for(std::vector<WorldChunkData*>::iterator data = slot.data.begin(); data != slot.data.end(); ++data)
+        delete (*data);
+
+    slot.data.clear();
+    slot.state = kChunkUnloaded;
+    slot.bStale = false;
+}
+
+/**
+* Loader thread entry point
+*/
+DWORD WINAPI WorldChunks::ThreadProc(LPVOID lpParameter)
+{
+    WorldChunks* chunks = (WorldChunks*)lpParameter;
+
+    // build chunks until shutdown
+    ChunkJob* job = NULL;
+    while( (job = chunks->WaitForJob()) != NULL )
+    {
+        chunks->BuildJob(job);
+
+        EnterCriticalSection(&chunks->m_queueLock);
+        chunks->m_completed.push_back(job);
+        LeaveCriticalSection(&chunks->m_queueLock);
+
+        SetEvent(chunks->m_hCompleteEvent);
+    }
+
+    return 0;
+}
+
+/**
+* Blocks until a job is available. Returns null on shutdown.
+*/
+WorldChunks::ChunkJob* WorldChunks::WaitForJob()
+{
+    while(true)
+    {
+        WaitForSingleObject(m_hJobSemaphore, INFINITE);
+
+        ChunkJob* job = NULL;
+        bool bShutdown = false;
+
+        EnterCriticalSection(&m_queueLock);
+        bShutdown = m_bShutdown;
+        if(!bShutdown && !m_jobQueue.empty())
+        {
+            job = m_jobQueue.front();
+            m_jobQueue.pop_front();
+        }
+        LeaveCriticalSection(&m_queueLock);
+
+        // cancelled jobs leave extra semaphore counts
+        if(job || bShutdown)
+            return job;
+    }
+}
+
+/**
+* Builds every client's data for a chunk (loader thread)
+*/
+void WorldChunks::BuildJob(ChunkJob* job) const
+{
+    WorldChunkBounds bounds;
+    GetChunkBounds(job->iChunk, &bounds);
+
+    job->data.resize(m_vClients.size());
+    for(int i = 0; i < (int)m_vClients.size(); ++i)
+    {
+        job->data[i] = m_vClients[i]->LoadChunk(bounds);
+    }
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+* Game Development Project
+* WorldChunks.h
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Streaming of fixed-size world chunks around active agents
+*
+*******************************************************************************/
+
+#pragma once
+#include <deque>
+#include <vector>
+#include "singleton.h"
+#include "WorldFile.h"
+
+// chunk size in cells (a multiple of the WorldFile tile size)
+const int kWorldChunkSize = 32;
+
+/* chunk cell rectangle (inclusive) */
+struct WorldChunkBounds
+{
+    int iRowMin;
+    int iColMin;
+    int iRowMax;
+    int iColMax;
+};
+
+/**
+* Per-chunk data of one client (vertices, collision quads, terrain layers).
+* Owned by WorldChunks and deleted when the chunk is unloaded or rebuilt.
+*/
+class WorldChunkData
+{
+    public:
+        virtual ~WorldChunkData() {}
+};
+
+/**
+* Subsystem keeping per-chunk data. LoadChunk runs on the loader thread; it
+* may only read the world grid and must return new data (never modify data
+* of resident chunks). The data is published on the main thread.
+*/
+class WorldChunkClient
+{
+    public:
+        virtual ~WorldChunkClient() {}
+        virtual WorldChunkData* LoadChunk(const WorldChunkBounds& bounds) = 0;
+};
+
+/**
+* Splits the world into kWorldChunkSize square chunks and keeps the chunks
+* around the focus points (active agents) resident. Chunks within the load
+* radius are built asynchronously on a loader thread; chunks are released
+* once they are farther than the load radius plus one (so agents crossing a
+* chunk edge do not thrash), and the number of resident chunks is capped,
+* keeping memory bounded on worlds of any size. Chunks whose cells change
+* are rebuilt and swapped in when ready.
+*
+* Chunk data may only be read on the main thread, and only for resident
+* chunks.
+*
+* Only the chunk data is bounded by chunking. Two structures stay full-map:
+* the world grid in the WorldFile (2 bits per cell, packed or mapped) and
+* the clearance field (2 bytes per cell), about 36 MB on a 4000x4000 world.
+* Path data per cell (search node grids, landmark tables, flow fields) is
+* only kept up to the WorldData large world size of 512x512 cells, about
+* 45 MB at that size; larger worlds search on the cluster graph with one
+* cluster of nodes per search and pursue with sparse D* Lite planners.
+*/
+class WorldChunks : public Singleton<WorldChunks>
+{
+    public:
+
+        // constructor
+        WorldChunks(const WorldFile& worldFile, int iLoadRadius, int iMaxChunks);
+        ~WorldChunks();
+
+        // clients (register before the first update; returns the client index)
+        int AddClient(WorldChunkClient* client);
+
+        // streaming (main thread, once per frame; wait blocks until the wanted chunks are resident)
+        void Update(const std::vector<D3DXVECTOR2>& focusPoints, bool bWait);
+
+        // chunks
+        int GetChunkCount() const { return (int)m_vSlots.size(); }
+        int GetChunkIndex(int iRow, int iCol) const;
+        void GetChunkBounds(int iChunk, WorldChunkBounds* bounds) const;
+        bool IsResident(int iChunk) const { return m_vSlots[iChunk].state == kChunkResident; }
+        const std::vector<int>& GetResidentChunks() const { return m_vResident; }
+        const std::vector<int>& GetPublishedChunks() const { return m_vPublished; }
+        WorldChunkData* GetChunkData(int iClient, int iChunk) const;
+
+        // stats
+        int GetLoadingCount() const { return m_iLoading; }
+        int GetLoadedTotal() const { return m_iLoadedTotal; }
+
+    private:
+
+        /**
+        * Chunk state (main thread)
+        */
+        enum ChunkState
+        {
+            kChunkUnloaded,
+            kChunkLoading,
+            kChunkResident
+        };
+
+        /**
+        * Chunk slot (main thread)
+        */
+        struct ChunkSlot
+        {
+            ChunkState state;
+            bool bReloading;                    // resident chunk with a rebuild in flight
+            bool bStale;                        // cells changed after the in-flight build started
+            unsigned int uWantedFrame;          // last frame within the load radius
+            unsigned int uKeptFrame;            // last frame within the keep radius
+            int iDistance;                      // chunk distance to the nearest focus point (wanted frame)
+            std::vector<WorldChunkData*> data;  // data by client (resident only)
+        };
+
+        /**
+        * Loader job. Data is written by the loader thread only.
+        */
+        struct ChunkJob
+        {
+            int iChunk;
+            std::vector<WorldChunkData*> data;  // built data by client
+        };
+
+        // world info
+        const WorldFile& m_worldFile;
+        int m_iChunksX;                         // chunks per row
+        int m_iChunksY;                         // chunk rows
+        unsigned int m_uWorldVersion;           // world version of the chunk data
+
+        // streaming
+        int m_iLoadRadius;                      // chunks loaded around a focus point
+        int m_iMaxChunks;                       // resident and loading chunk cap
+        unsigned int m_uFrame;                  // update counter
+        std::vector<WorldChunkClient*> m_vClients;
+        std::vector<ChunkSlot> m_vSlots;        // slots by chunk index
+        std::vector<int> m_vLive;               // loading and resident chunks
+        std::vector<int> m_vResident;           // resident chunks
+        std::vector<int> m_vPublished;          // resident chunks with new data since the previous update
+        int m_iLoading;                         // jobs in flight
+        int m_iLoadedTotal;                     // jobs completed
+
+        // loader thread
+        HANDLE m_hThread;                       // loader (null if loading on the main thread)
+        CRITICAL_SECTION m_queueLock;           // guards queues and shutdown flag
+        HANDLE m_hJobSemaphore;                 // counts queued jobs
+        HANDLE m_hCompleteEvent;                // set when a job completes
+        std::deque<ChunkJob*> m_jobQueue;       // jobs not started
+        std::vector<ChunkJob*> m_completed;     // jobs finished
+        bool m_bShutdown;                       // loader exits when set
+
+        // main thread methods
+        void QueueJob(int iChunk);
+        bool CancelJob(int iChunk);
+        void CollectCompletedJobs();
+        void RunQueuedJobs(int iMaxJobs);
+        void ApplyCellChanges();
+        void MarkChanged(int iChunk);
+        void MarkFocus(const std::vector<D3DXVECTOR2>& focusPoints, std::vector<int>* wanted);
+        void Unload(int iChunk);
+
+        // loader methods
+        static DWORD WINAPI ThreadProc(LPVOID lpParameter);
+        ChunkJob* WaitForJob();
+        void BuildJob(ChunkJob* job) const;
+
+        // prevent copy and assignment
+        WorldChunks(const WorldChunks&);
+        WorldChunks& operator=(const WorldChunks&);
+};
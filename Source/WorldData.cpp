@@ -12,28 +12,136 @@
 #include "DXUT.h"
 #include "WorldData.h"
 #include "database.h"
+#include "GridRay.h"
+#include <float.h>
+
+// A* node expansions between computation time checks
+static const int kSearchExpansionsPerCheck = 16;
+
+// main thread search budget per frame (seconds), allowance for the last
+// slice before a frame counts as an overrun, and searches run side by side
+static const double kSearchBudget = 0.005;
+static const double kSearchBudgetTolerance = 0.0005;
+static const int kMaxSearchesInFlight = 4;
+
+// hierarchical pathing: cluster size, smallest world dimension using it, and
+// the number of waypoints left before the next cluster is refined
+static const int kAbstractionClusterSize = 16;
+static const int kAbstractionMinSize = 64;
+static const int kRefineLookahead = 4;
+
+// landmarks for the ALT heuristic, and frames the world must stay unchanged
+// before the tables are rebuilt
+static const int kLandmarkCount = 8;
+static const unsigned int kLandmarkRebuildFrames = 30;
+
+// worlds with more cells than this keep no per-cell search data: no landmark
+// tables or flow fields, and every path is searched on the cluster graph so
+// each search only holds the nodes of one cluster
+static const int kLargeWorldCells = 512 * 512;
+
+// flow fields kept for distinct goal cells, and cells a field expands per
+// frame
+static const int kMaxFlowFields = 4;
+static const int kFlowFieldExpansionsPerUpdate = 4096;
+
+// pursuit planners: cells expanded per update, cleared planners kept for
+// reuse, and largest cell table a kept planner may hold
+static const int kPursuitExpansionsPerUpdate = 512;
+static const int kMaxFreePlanners = 8;
+static const int kMaxFreePlannerTable = 64 * 1024;
+
+// waypoint lists kept in the path cache
+static const int kPathCacheSize = 64;
+
+// line of fire cone: half angle (radians), range (cells), value at the cone
+// edges, and most rays cast per cone
+static const float kLineOfFireHalfAngle = 0.2f;
+static const float kLineOfFireRange = 48.0f;
+static const float kLineOfFireFlankValue = 0.2f;
+static const int kLineOfFireMaxRays = 33;
+
+// wall distance kept by the clearance field (cells), and the distance at
+// which terrain openness falls to its lowest value
+static const int kMaxClearance = 32;
+static const float kOpennessRange = 4.0f;
+static const float kOpennessMin = 0.15f;
 
 /**
 * Constructor
 */
 WorldData::WorldData(const WorldFile& worldFile) :
     GameObject(g_database.GetNewObjectID(), OBJECT_Debug, "PATH_DEBUG"),
-    m_bPathInProgress(false),
+    m_pPathThreads(NULL),
+    m_pLandmarks(NULL),
+    m_uLandmarkVersion(worldFile.GetVersion()),
+    m_uLandmarkChangeVersion(worldFile.GetVersion()),
+    m_uLandmarkChangeFrame(0),
+    m_pAbstraction(NULL),
+    m_pRefineSearch(NULL),
+    m_bLargeWorld(worldFile.GetWidth() * worldFile.GetHeight() > kLargeWorldCells),
+    m_uFrame(1),
+    m_dPursuitTime(0.0),
+    m_iPursuitExpansions(0),
+    m_uFlowFieldVersion(worldFile.GetVersion()),
+    m_uPathCacheVersion(worldFile.GetVersion()),
     m_worldFile(worldFile),
+    m_clearance(worldFile, kMaxClearance),
     m_rubberband(true),
     m_heuristicCalc(true),
     m_smooth(true),
+    m_anyAngle(false),
+    m_jumpPoint(true),
+    m_landmarks(true),
+    m_incrementalPursuit(false),
     m_heuristicWeight(1.01f),
     m_debuglines(false),
     m_terrainType(kTerrainAnalysisNone)
 {
-    // allocate terrain analysis grids
-    m_fTerrainOpenness = AllocateTerrainGrid();
-    m_fTerrainOccupancy = AllocateTerrainGrid();
-    m_fTerrainLineOfFire = AllocateTerrainGrid();
+    // terrain analysis layers are kept per resident chunk
+    m_iChunkClient = g_chunks.AddClient(this);
 
-    // initialize quad memory
-    m_vQuads.reserve(m_worldFile.GetHeight()*m_worldFile.GetWidth());
+    // wall distance field
+    m_clearance.Build();
+
+    // landmark heuristic tables (unused by any-angle searches)
+    if( m_landmarks && !m_anyAngle && !m_bLargeWorld )
+        BuildLandmarks();
+
+    // searches on large worlds hold one cluster of nodes
+    int iSearchWindow = m_bLargeWorld ? kAbstractionClusterSize : 0;
+
+    // build the cluster graph for large worlds
+    if( m_worldFile.GetWidth() >= kAbstractionMinSize || m_worldFile.GetHeight() >= kAbstractionMinSize )
+    {
+        m_pRefineSearch = new PathSearch(m_worldFile, iSearchWindow);
+        m_pAbstraction = new PathAbstraction(m_worldFile, kAbstractionClusterSize, m_bLargeWorld);
+        m_pAbstraction->Build(m_pRefineSearch);
+    }
+
+    // start path worker threads (single processor machines search on the main thread)
+    int iThreadCount = PathThreadPool::GetDefaultThreadCount();
+    if(iThreadCount > 0)
+    {
+        m_pPathThreads = new PathThreadPool(m_worldFile, iThreadCount, iSearchWindow);
+        if(m_pPathThreads->GetThreadCount() == 0)
+        {
+            delete m_pPathThreads;
+            m_pPathThreads = NULL;
+        }
+    }
+
+    // otherwise, searches are time sliced on the main thread
+    if(!m_pPathThreads)
+    {
+        for(int i = 0; i < kMaxSearchesInFlight; ++i)
+        {
+            m_vSearches.push_back(new PathSearch(m_worldFile, iSearchWindow));
+        }
+        m_vFreeSearches = m_vSearches;
+    }
+
+    ResetPathStats();
 }
 
 /**
@@ -41,40 +149,59 @@ WorldData::WorldData(const WorldFile& worldFile) :
 */
 WorldData::~WorldData()
 {
-    // delete terrain grids
-    DeleteTerrainGrid(m_fTerrainOpenness);
-    DeleteTerrainGrid(m_fTerrainOccupancy);
-    DeleteTerrainGrid(m_fTerrainLineOfFire);
-}
+    // stop path workers before releasing their jobs
+    delete m_pPathThreads;
+    for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end(); ++req)
+    {
+        if( IsLastJobRequest(*req) )
+            delete req->pJob;
+    }
 
-/**
-* Allocates a new 2D grid for terrain analysis.
-*/
-float** WorldData::AllocateTerrainGrid()
-{
-    float** fGrid = NULL;
+    // delete main thread searches
+    for(std::vector<PathSearch*>::iterator search = m_vSearches.begin(); search != m_vSearches.end(); ++search)
+    {
+        delete (*search);
+    }
 
-    // allocate terrain analysis grid rows
-    fGrid = new float*[m_worldFile.GetHeight()];
+    // delete hierarchical path data
+    delete m_pRefineSearch;
+    delete m_pAbstraction;
 
-    // allocate each column
-    for(int row = 0; row < m_worldFile.GetHeight(); ++row)
-        fGrid[row] = new float[m_worldFile.GetWidth()];
+    // delete landmark tables
+    delete m_pLandmarks;
+    for(std::vector<PathLandmarks*>::iterator landmarks = m_vRetiredLandmarks.begin(); landmarks != m_vRetiredLandmarks.end(); ++landmarks)
+    {
+        delete (*landmarks);
+    }
 
-    return fGrid;
+    // delete flow fields
+    for(std::vector<FlowField*>::iterator field = m_vFlowFields.begin(); field != m_vFlowFields.end(); ++field)
+    {
+        delete (*field);
+    }
+
+    // delete pursuit planners
+    for(std::map<objectID, DStarLite*>::iterator planner = m_pursuitPlanners.begin(); planner != m_pursuitPlanners.end(); ++planner)
+    {
+        delete planner->second;
+    }
+    for(std::vector<DStarLite*>::iterator planner = m_vFreePlanners.begin(); planner != m_vFreePlanners.end(); ++planner)
+    {
+        delete (*planner);
+    }
 }
 
 /**
-* Deletes a 2D terrain analysis grid.
+* Returns a terrain analysis cell, or null if its chunk is not resident.
 */
-void WorldData::DeleteTerrainGrid(float** fGrid)
+float* WorldData::GetTerrainCell(TerrainLayer layer, int row, int col) const
 {
-    // delete each column
-    for(int row = 0; row < m_worldFile.GetHeight(); ++row)
-        delete [] fGrid[row];
+    int iChunk = g_chunks.GetChunkIndex(row, col);
+    TerrainChunk* chunk = static_cast<TerrainChunk*>( g_chunks.GetChunkData(m_iChunkClient, iChunk) );
+    if(!chunk)
+        return NULL;
 
-    // delete grid rows
-    delete [] fGrid;
+    return &chunk->grid(layer, row % kWorldChunkSize, col % kWorldChunkSize);
 }
 
 /**
@@ -128,53 +255,21 @@ std::wstring WorldData::GetTerrainAnalysisName() const
 */
 HRESULT WorldData::Initialize(IDirect3DDevice9* pd3dDevice)
 {
-    // initialize terrain openness
-    for(int col = 0; col < m_worldFile.GetWidth(); ++col)
-    {
-        for(int row = 0; row < m_worldFile.GetHeight(); ++row)
-        {
-            m_fTerrainOpenness[row][col] = 0.0f;
-        }
-    }
-
-    // analyze terrain openness
-    for(int col = 0; col < m_worldFile.GetWidth(); ++col)
-    {
-        for(int row = 0; row < m_worldFile.GetHeight(); ++row)
-        {
-            // occupied cell
-            if( m_worldFile(row,col) == WorldFile::OCCUPIED_CELL )
-            {
-                m_fTerrainOpenness[row][col] = 1.0f;
-            }
-
-            // next to occupied cell
-            else if( m_worldFile(row-1,col) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row+1,col) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row,col-1) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row,col+1) == WorldFile::OCCUPIED_CELL )
-            {
-                m_fTerrainOpenness[row][col] = 0.67f;
-            }
-
-            // corner to occupied cell
-            else if( m_worldFile(row-1,col-1) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row+1,col+1) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row+1,col-1) == WorldFile::OCCUPIED_CELL ||
-                     m_worldFile(row-1,col+1) == WorldFile::OCCUPIED_CELL )
-            {
-                m_fTerrainOpenness[row][col] = 0.33f;
-            }
+    return MAKE_HRESULT(SEVERITY_SUCCESS, 0, 0);
+}
 
-            // no occupied cells nearby
-            else
-            {
-                m_fTerrainOpenness[row][col] = 0.15f;
-            }
-        }
-    }
+/**
+* Creates the (cleared) terrain layers of a world chunk. Openness is filled
+* from the clearance field when the chunk is published; occupancy and line
+* of fire are recomputed every update. Runs on the chunk loader thread.
+*/
+WorldChunkData* WorldData::LoadChunk(const WorldChunkBounds& bounds)
+{
+    TerrainChunk* chunk = new TerrainChunk;
+    for(int layer = 0; layer < kTerrainLayerCount; ++layer)
+        chunk->grid.Clear(layer, 0.0f);
 
-    return MAKE_HRESULT(SEVERITY_SUCCESS, 0, 0);
+    return chunk;
 }
 
 /**
@@ -182,6 +277,12 @@ HRESULT WorldData::Initialize(IDirect3DDevice9* pd3dDevice)
 */
 void WorldData::Update()
 {
+    // advance flow field frame
+    ++m_uFrame;
+
+    // rebuild landmark tables after world changes
+    UpdateLandmarks();
+
     // compute paths
     ComputePaths();
 
@@ -191,10 +292,10 @@ void WorldData::Update()
     // update path debug lines
     if(m_debuglines)
     {
-        for(std::map<objectID, PathWaypointList>::iterator list = m_completeWaypointLists.begin(); list != m_completeWaypointLists.end(); ++list)
+        for(std::map<objectID, WaypointHandle>::iterator list = m_waypointHandles.begin(); list != m_waypointHandles.end(); ++list)
         {
             // get waypoint list and object
-            PathWaypointList& waypointList = (*list).second;
+            PathWaypointList& waypointList = *m_waypointStore.Get( (*list).second );
             GameObject* obj = g_database.Find( (*list).first );
               
             // if list not empty
@@ -204,9 +305,9 @@ void WorldData::Update()
 		        D3DXVECTOR3 vPrevPoint = obj->GetPosition();
     		    
                 // add lines for remaining points
-		        for( PathWaypointList::iterator point = waypointList.begin(); point != waypointList.end(); ++point )
+		        for( int point = 0; point < waypointList.size(); ++point )
 		        {
-                    D3DXVECTOR3 vPoint = CreateLinePosition( *point );
+                    D3DXVECTOR3 vPoint = CreateLinePosition( waypointList[point] );
                     D3DXVECTOR3 vPointMarker = vPoint;
                     vPointMarker.y -= 0.25f;
 
@@ -221,6 +322,9 @@ void WorldData::Update()
         }
     }
     
+    // analyze wall openness
+    AnalyzeTerrainOpenness();
+
     // analyze world occupancy
     AnalyzeTerrainOccupancy();
 
@@ -232,16 +336,86 @@ void WorldData::Update()
 }
 
 /**
-* Update terrain occupancy based on objects in the world
+* Clears a terrain layer of every resident chunk
+*/
+void WorldData::ResetTerrainLayer(TerrainLayer layer)
+{
+    const std::vector<int>& chunks = g_chunks.GetResidentChunks();
+    for(std::vector<int>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        TerrainChunk* chunk = static_cast<TerrainChunk*>( g_chunks.GetChunkData(m_iChunkClient, *it) );
+        chunk->grid.Clear(layer, 0.0f);
+    }
+}
+
+/**
+* Update terrain openness from the clearance field: in chunks with new data,
+* and in chunks near cells changed since the last update (the field is
+* updated first).
+*/
+void WorldData::AnalyzeTerrainOpenness()
+{
+    const std::vector<int>& chunks = g_chunks.GetPublishedChunks();
+    for(std::vector<int>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+    {
+        FillTerrainOpenness(*chunk);
+    }
+
+    if( m_clearance.Update() )
+    {
+        const std::vector<int>& updated = m_clearance.GetUpdatedChunks();
+        for(std::vector<int>::const_iterator chunk = updated.begin(); chunk != updated.end(); ++chunk)
+        {
+            FillTerrainOpenness(*chunk);
+        }
+    }
+}
+
+/**
+* Sets the openness of a resident chunk's cells: one on walls, falling
+* linearly with the wall distance to the lowest value at the openness range.
+*/
+void WorldData::FillTerrainOpenness(const int iChunk)
+{
+    TerrainChunk* chunk = static_cast<TerrainChunk*>( g_chunks.GetChunkData(m_iChunkClient, iChunk) );
+    if(!chunk)
+        return;
+
+    WorldChunkBounds bounds;
+    g_chunks.GetChunkBounds(iChunk, &bounds);
+
+    for(int row = bounds.iRowMin; row <= bounds.iRowMax; ++row)
+    {
+        float* fOpenness = chunk->grid.GetRow(kTerrainLayerOpenness, row - bounds.iRowMin);
+
+        for(int col = bounds.iColMin; col <= bounds.iColMax; ++col)
+        {
+            float fDistance = min(m_clearance.GetClearance(row, col), kOpennessRange);
+            fOpenness[col - bounds.iColMin] = 1.0f - (1.0f - kOpennessMin) * fDistance / kOpennessRange;
+        }
+    }
+}
+
+/**
+* Update terrain occupancy based on objects in the world. Each agent's stamp
+* stays in the layer until the agent changes cell (or leaves the world), so
+* only movers update cells. Chunks streamed in since the last update start
+* empty and receive the stamps overlapping them.
 */
 void WorldData::AnalyzeTerrainOccupancy()
 {
-    // reset terrain occupancy
-    for(int col = 0; col < m_worldFile.GetWidth(); ++col)
+    // stamp agents into chunks with new data
+    const std::vector<int>& chunks = g_chunks.GetPublishedChunks();
+    for(std::vector<int>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
     {
-        for(int row = 0; row < m_worldFile.GetHeight(); ++row)
+        WorldChunkBounds bounds;
+        g_chunks.GetChunkBounds(*chunk, &bounds);
+
+        for(std::map<objectID, OccupancyStamp>::iterator stamp = m_occupancyStamps.begin(); stamp != m_occupancyStamps.end(); ++stamp)
         {
-            m_fTerrainOccupancy[row][col] = 0.0f;
+            const OccupancyStamp& s = stamp->second;
+            if( s.iRow >= bounds.iRowMin-2 && s.iRow <= bounds.iRowMax+2 && s.iCol >= bounds.iColMin-2 && s.iCol <= bounds.iColMax+2 )
+                StampTerrainOccupancy(s.iRow, s.iCol, 1.0f, *chunk);
         }
     }
 
@@ -249,172 +423,241 @@ void WorldData::AnalyzeTerrainOccupancy()
     dbCompositionList playerList;
     g_database.ComposeList(playerList, OBJECT_NPC | OBJECT_Player);
 
-    // update occupancy based on player/NPC positions
+    // move stamps of players/NPCs that changed cell
     for(dbCompositionList::iterator it = playerList.begin(); it != playerList.end(); ++it)
     {
         int row = (int)(*it)->GetGridPosition().y;
         int col = (int)(*it)->GetGridPosition().x;
 
-        // check if out of bounds
-        if( (row >= 0 && row < m_worldFile.GetHeight()) && (col >= 0 && col < m_worldFile.GetWidth()) )
-            m_fTerrainOccupancy[row][col] = min(1.0f, m_fTerrainOccupancy[row][col]+1.0f);
-
-        // occupied at location of player
+        std::map<objectID, OccupancyStamp>::iterator stamp = m_occupancyStamps.find( (*it)->GetID() );
+        if( stamp == m_occupancyStamps.end() )
+        {
+            OccupancyStamp s = { row, col, m_uFrame };
+            m_occupancyStamps[(*it)->GetID()] = s;
+            StampTerrainOccupancy(row, col, 1.0f, -1);
+            continue;
+        }
 
-        // partially occupied near player (one cell from player)
-        UpdateTerrainGridCells(m_fTerrainOccupancy, row, col, 1, 0.67f);
+        OccupancyStamp& s = stamp->second;
+        s.uFrame = m_uFrame;
+        if( s.iRow != row || s.iCol != col )
+        {
+            StampTerrainOccupancy(s.iRow, s.iCol, -1.0f, -1);
+            StampTerrainOccupancy(row, col, 1.0f, -1);
+            s.iRow = row;
+            s.iCol = col;
+        }
+    }
 
-        // partially occupied near player (two cells from player)
-        UpdateTerrainGridCells(m_fTerrainOccupancy, row, col, 2, 0.33f);
+    // remove stamps of players/NPCs no longer in the world
+    for(std::map<objectID, OccupancyStamp>::iterator stamp = m_occupancyStamps.begin(); stamp != m_occupancyStamps.end(); )
+    {
+        if( stamp->second.uFrame != m_uFrame )
+        {
+            StampTerrainOccupancy(stamp->second.iRow, stamp->second.iCol, -1.0f, -1);
+            m_occupancyStamps.erase(stamp++);
+        }
+        else
+        {
+            ++stamp;
+        }
     }
 }
 
 /**
-* Updates terrain  a distance of range from the specified row and column
+* Adds (scale 1) or removes (scale -1) an agent's occupancy stamp: occupied at
+* the agent's cell, partially occupied one and two cells away. Cells of
+* chunks that are not resident are skipped; a chunk index other than -1
+* limits the stamp to that chunk.
 */
-void WorldData::UpdateTerrainGridCells(float** grid, const int row, const int col, const int range, const float value)
+void WorldData::StampTerrainOccupancy(const int row, const int col, const float fScale, const int iChunk)
 {
-    // partially occupied near player (one cell from player)
-    for(int i = col-range; i <= col+range; ++i)
+    static const float kRingValues[3] = { 1.0f, 0.67f, 0.33f };
+
+    for(int j = row-2; j <= row+2; ++j)
     {
-        for(int j = row-range; j <= row+range; ++j)
+        // spans of cells at the same distance from the agent
+        int i = col-2;
+        while(i <= col+2)
         {
-            // check if along border of selected grid
-            if(i == col-range || i == col+range || j == row-range || j == row+range)
-            {
-                // check if valid cell
-                if( (j >= 0 && j < m_worldFile.GetHeight()) && (i >= 0 && i < m_worldFile.GetWidth()) )
-                {
-                    grid[j][i] = min(1.0f, grid[j][i]+value);
-                }
-            }
+            int iRing = max(abs(j-row), abs(i-col));
+            int iEnd = i;
+            while( iEnd < col+2 && max(abs(j-row), abs(iEnd+1-col)) == iRing )
+                ++iEnd;
+
+            AddTerrainSpan(kTerrainLayerOccupancy, j, i, iEnd, fScale*kRingValues[iRing], 0.0f, FLT_MAX, iChunk);
+            i = iEnd+1;
         }
     }
 }
 
 /**
-* Update terrain line of fire based on player objects and direction
+* Adds a value to a row span of terrain cells and clamps them. The span is
+* split at chunk edges; cells of chunks that are not resident are skipped,
+* and a chunk index other than -1 limits the span to that chunk.
 */
-void WorldData::AnalyzeTerrainLineOfFire()
+void WorldData::AddTerrainSpan(TerrainLayer layer, const int row, const int colMin, const int colMax, const float value, const float fMin, const float fMax, const int iChunk)
 {
-    // reset terrain occupancy
-    for(int col = 0; col < m_worldFile.GetWidth(); ++col)
+    if( row < 0 || row >= m_worldFile.GetHeight() )
+        return;
+
+    int col = max(colMin, 0);
+    int colLast = min(colMax, m_worldFile.GetWidth()-1);
+    while(col <= colLast)
     {
-        for(int row = 0; row < m_worldFile.GetHeight(); ++row)
+        int colChunkMax = min(colLast, (col / kWorldChunkSize + 1) * kWorldChunkSize - 1);
+        int chunkIndex = g_chunks.GetChunkIndex(row, col);
+
+        TerrainChunk* chunk = static_cast<TerrainChunk*>( g_chunks.GetChunkData(m_iChunkClient, chunkIndex) );
+        if( chunk && (iChunk == -1 || iChunk == chunkIndex) )
         {
-            m_fTerrainLineOfFire[row][col] = 0.0f;
+            chunk->grid.AddSpan(layer, row % kWorldChunkSize, col % kWorldChunkSize, colChunkMax % kWorldChunkSize, value, fMin, fMax);
         }
+
+        col = colChunkMax+1;
     }
+}
+
+/**
+* Update terrain line of fire from the player and NPC positions and
+* directions. Each casts a cone of rays, strongest along its facing, and
+* every crossed cell is written once per ray.
+*/
+void WorldData::AnalyzeTerrainLineOfFire()
+{
+    // reset terrain line of fire
+    ResetTerrainLayer(kTerrainLayerLineOfFire);
+
+    // rays per cone (odd, so the center ray is cast; neighboring rays at
+    // most a cell apart at full range)
+    int iRays = min(kLineOfFireMaxRays, (int)ceilf(2.0f * kLineOfFireHalfAngle * kLineOfFireRange) + 1) | 1;
 
     // generate list of players/NPCs
-    dbCompositionList playerList;
-    g_database.ComposeList(playerList, OBJECT_Player);
+    dbCompositionList shooterList;
+    g_database.ComposeList(shooterList, OBJECT_NPC | OBJECT_Player);
 
-    // update occupancy based on player/NPC positions
-    for(dbCompositionList::iterator it = playerList.begin(); it != playerList.end(); ++it)
+    // cast a fan of rays from each player/NPC
+    for(dbCompositionList::iterator it = shooterList.begin(); it != shooterList.end(); ++it)
     {
-        // get player position and direction
+        // get position and direction
         D3DXVECTOR3 vDir = (*it)->GetDirection();
         D3DXVECTOR3 vPos = (*it)->GetPosition();
-        D3DXVec3Normalize(&vDir, &vDir);
+        if( vDir.x == 0.0f && vDir.z == 0.0f )
+            continue;
 
-        // compute initial grid position
-        int row = (int)vPos.z;
-        int col = (int)vPos.x;
+        D3DXVECTOR2 vStart(vPos.x / kWorldScale, vPos.z / kWorldScale);
+        float fAngle = atan2f(vDir.z, vDir.x);
 
-        // until empty cell found
-        while( m_worldFile(row, col) == WorldFile::EMPTY_CELL )
+        for(int ray = 0; ray < iRays; ++ray)
         {
-            // set cell in direct line of fire
-            if( (row >= 0 && row < m_worldFile.GetHeight()) && (col >= 0 && col < m_worldFile.GetWidth()) )
-                m_fTerrainLineOfFire[row][col] = 1.0f;
-
-            // update cells around direct line of fire
-            UpdateTerrainGridCells(m_fTerrainLineOfFire, row, col, 1, 0.2f);
+            // offset from the facing direction (-1 to 1 across the cone)
+            float fOffset = iRays > 1 ? (2.0f * ray / (iRays - 1) - 1.0f) : 0.0f;
+            float fValue = 1.0f - (1.0f - kLineOfFireFlankValue) * fabsf(fOffset);
 
-            // move to next grid position
-            vPos += vDir;
-            row = (int)vPos.z;
-            col = (int)vPos.x;
+            CastLineOfFire(vStart, fAngle + fOffset * kLineOfFireHalfAngle, fValue);
         }
     }
 }
 
 /**
-* Determine the color for the specified grid
+* Marks the empty cells crossed by a ray until it reaches an occupied (or
+* invalid) cell or its range. Each cell keeps the strongest value written.
 */
-D3DXCOLOR WorldData::GetTerrainColor(const int row, const int col)
+void WorldData::CastLineOfFire(const D3DXVECTOR2& vStart, const float fAngle, const float fValue)
 {
-    // alpha
+    GridRay ray(vStart, D3DXVECTOR2(cosf(fAngle), sinf(fAngle)), kLineOfFireRange);
+
+    do
+    {
+        if( m_worldFile(ray.GetRow(), ray.GetCol()) != WorldFile::EMPTY_CELL )
+            break;
+
+        float* fCell = GetTerrainCell(kTerrainLayerLineOfFire, ray.GetRow(), ray.GetCol());
+        if( fCell && *fCell < fValue )
+            *fCell = fValue;
+    }
+    while( ray.Step() );
+}
+
+/**
+* Create the quads for displaying terrain analysis debug
+*/
+void WorldData::GenerateTerrainQuads()
+{
+    // update terrain analysis grid
+    float fGridHeight = 0.05f;
     float fGridAlpha = 0.5f;
 
-    // default color
-    D3DXCOLOR color = D3DXCOLOR(0.0f, 0.0f, 0.0f, fGridAlpha);
+    // clear quads
+    m_vQuads.clear();
+
+    // layer shown in each color channel
+    int iRedLayer = -1;
+    int iGreenLayer = -1;
+    int iBlueLayer = -1;
 
     switch(m_terrainType)
     {
     case kTerrainAnalysisNone:
-        break;
+        return;
     case kTerrainAnalysisOccupancy:
-        color.r = m_fTerrainOccupancy[row][col];
+        iRedLayer = kTerrainLayerOccupancy;
         break;
     case kTerrainAnalysisOpenness:
-        color.g = m_fTerrainOpenness[row][col];
+        iGreenLayer = kTerrainLayerOpenness;
         break;
     case kTerrainAnalysisLineOfFire:
-        color.b = m_fTerrainLineOfFire[row][col];
+        iBlueLayer = kTerrainLayerLineOfFire;
         break;
     case kTerrainAnalysisAll:
-        color.r = m_fTerrainOccupancy[row][col];
-        color.g = m_fTerrainOpenness[row][col];
-        color.b = m_fTerrainLineOfFire[row][col];
+        iRedLayer = kTerrainLayerOccupancy;
+        iGreenLayer = kTerrainLayerOpenness;
+        iBlueLayer = kTerrainLayerLineOfFire;
         break;
     }
 
-    return color;
-}
+    // resident chunks
+    const std::vector<int>& chunks = g_chunks.GetResidentChunks();
+    m_vQuads.reserve(chunks.size() * kWorldChunkSize * kWorldChunkSize * 6);
 
-/**
-* Create the quads for displaying terrain analysis debug
-*/
-void WorldData::GenerateTerrainQuads()
-{
-    // update terrain analysis grid
-    float fGridHeight = 0.05f;
-
-    // clear quads
-    m_vQuads.clear();
-
-    for(int col = 0; col < m_worldFile.GetWidth(); ++col)
+    unsigned int colors[kWorldChunkSize];
+    for(std::vector<int>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
     {
-        for(int row = 0; row < m_worldFile.GetHeight(); ++row)
+        TerrainChunk* chunk = static_cast<TerrainChunk*>( g_chunks.GetChunkData(m_iChunkClient, *it) );
+        WorldChunkBounds bounds;
+        g_chunks.GetChunkBounds(*it, &bounds);
+
+        for(int row = bounds.iRowMin; row <= bounds.iRowMax; ++row)
         {
-            // determine color
-            D3DXCOLOR color = GetTerrainColor(row, col);
+            // determine row colors
+            chunk->grid.BlendColors(row - bounds.iRowMin, iRedLayer, iGreenLayer, iBlueLayer, fGridAlpha, colors);
 
-            // initialize vertex
-            CustomVertex vertex;
-            vertex.cColor = color;
+            for(int col = bounds.iColMin; col <= bounds.iColMax; ++col)
+            {
+                // initialize vertex
+                CustomVertex vertex;
+                vertex.cColor = colors[col - bounds.iColMin];
 
-            // lower triangle
-            vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, (float)row);
-            m_vQuads.push_back(vertex);
+                // lower triangle
+                vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, (float)row);
+                m_vQuads.push_back(vertex);
 
-            vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, row+kWorldScale);
-            m_vQuads.push_back(vertex);
+                vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, row+kWorldScale);
+                m_vQuads.push_back(vertex);
 
-            vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, row+kWorldScale);
-            m_vQuads.push_back(vertex);
+                vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, row+kWorldScale);
+                m_vQuads.push_back(vertex);
 
-            // upper triangle
-            vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, (float)row);
-            m_vQuads.push_back(vertex);
+                // upper triangle
+                vertex.vPos = D3DXVECTOR3((float)col, fGridHeight, (float)row);
+                m_vQuads.push_back(vertex);
 
-            vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, row+kWorldScale);
-            m_vQuads.push_back(vertex);
+                vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, row+kWorldScale);
+                m_vQuads.push_back(vertex);
 
-            vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, (float)row);
-            m_vQuads.push_back(vertex);
+                vertex.vPos = D3DXVECTOR3(col+kWorldScale, fGridHeight, (float)row);
+                m_vQuads.push_back(vertex);
+            }
         }
     }
 }
@@ -601,562 +844,913 @@ void WorldData::AddPathRequest(
     const D3DXVECTOR2& vDestPos,
     objectID id)
 {
-    PathRequest req;
+    // queue until the next computation, so requests made in the same frame
+    // are batched (existing waypoints are cleared then)
+    PathQuery query;
+    query.vPos = vPos;
+    query.vDestPos = vDestPos;
+    query.id = id;
+    query.dRequestTime = g_time.GetHighResolutionSeconds();
+    m_vQueuedQueries.push_back(query);
+}
+
+/**
+* Adds a batch of path requests. Requests that are not cached and share a
+* destination cell are answered by one reverse search from the destination,
+* so several objects heading to the same point cost a single search.
+*/
+void WorldData::AddPathRequests(const std::vector<PathQuery>& queries)
+{
+    std::vector<PathRequest> requests(queries.size());
+    std::vector<bool> cached(queries.size());
+    std::map<std::pair<int, int>, int> destCounts;
+    std::map<std::pair<int, int>, PathJob*> groupJobs;
+
+    for(int i = 0; i < (int)queries.size(); ++i)
+    {
+        PathRequest& req = requests[i];
+
+        // clear any existing waypoints
+        ClearWaypointList(queries[i].id);
+
+        // create destination key
+        GetRowColumn(queries[i].vDestPos, &req.nkDestPos);
+
+        // create current position key
+        GetRowColumn(queries[i].vPos, &req.nkPos);
+
+        // set id
+        req.id = queries[i].id;
+        req.pSearch = NULL;
+        req.dRequestTime = queries[i].dRequestTime;
+        req.uWorldVersion = m_worldFile.GetVersion();
+        req.pJob = NULL;
+        req.iGroupIndex = -1;
+
+        // cache key
+        req.cacheKey.nkPos = req.nkPos;
+        req.cacheKey.nkDestPos = req.nkDestPos;
+        req.cacheKey.options = GetSearchOptions();
+        req.cacheKey.bSmooth = m_smooth && !m_anyAngle;
+
+        // serve cached waypoints (completed in request order)
+        cached[i] = FindCachedPath(req.cacheKey, &req.waypointList);
+        if( !cached[i] )
+        {
+            ++destCounts[std::make_pair(req.nkDestPos.iRow, req.nkDestPos.iCol)];
+        }
+    }
+
+    for(int i = 0; i < (int)requests.size(); ++i)
+    {
+        if( cached[i] )
+            continue;
+
+        PathRequest* req = &requests[i];
 
-    // clear any existing waypoints
-    ClearWaypointList(id);
+        std::pair<int, int> dest = std::make_pair(req->nkDestPos.iRow, req->nkDestPos.iCol);
 
-    // create destination key
-    GetRowColumn(vDestPos, &req.nkDestPos);
+        // large worlds search each path on the cluster graph (a reverse
+        // search would need the nodes of every start)
+        bool bBatch = destCounts[dest] > 1 && !m_bLargeWorld;
 
-    // create current position key
-    GetRowColumn(vPos, &req.nkPos);
+        // create search job
+        if( !bBatch || !groupJobs[dest] )
+        {
+            req->pJob = new PathJob;
+            req->pJob->nkStart = req->nkPos;
+            req->pJob->nkDest = req->nkDestPos;
+            req->pJob->options = req->cacheKey.options;
+            req->pJob->pAbstraction = m_pAbstraction;
+            req->pJob->lComplete = 0;
+
+            if( bBatch )
+                groupJobs[dest] = req->pJob;
+        }
 
-    // set id
-    req.id = id;
+        // join the batch job for the destination
+        if( bBatch )
+        {
+            req->pJob = groupJobs[dest];
+            req->iGroupIndex = (int)req->pJob->groupStarts.size();
+            req->pJob->groupStarts.push_back(req->nkPos);
+        }
+    }
 
-    // add request
-    m_requestList.push_back(req);
+    for(std::vector<PathRequest>::iterator req = requests.begin(); req != requests.end(); ++req)
+    {
+        // hand each search to the worker threads once
+        if( m_pPathThreads && req->pJob && req->iGroupIndex <= 0 )
+        {
+            m_pPathThreads->Submit(req->pJob);
+        }
+
+        // add request
+        m_requestList.push_back(*req);
+    }
 }
 
 /**
-* Find waypoint list for specified object id. Returns null if not found.
+* Find waypoint list handle for specified object id. A list is created for
+* the object on first use and kept for every later path, until the object
+* leaves the database.
 */
-PathWaypointList* WorldData::GetWaypointList(objectID id)
+WaypointHandle WorldData::GetWaypointHandle(objectID id)
 {
-    return &(m_completeWaypointLists[id]);
+    std::map<objectID, WaypointHandle>::iterator handle = m_waypointHandles.find(id);
+    if( handle != m_waypointHandles.end() )
+        return handle->second;
+
+    return (m_waypointHandles[id] = m_waypointStore.Allocate());
 }
 
 /**
-* Clears an object waypoint list.
+* Find waypoint list for specified handle. The pointer stays valid until the
+* object leaves the database.
 */
-void WorldData::ClearWaypointList(objectID id)
+PathWaypointList* WorldData::GetWaypointList(WaypointHandle handle)
 {
-    m_completeWaypointLists.erase(id);
+    PathWaypointList* waypointList = m_waypointStore.Get(handle);
+
+    // refine the next cluster of a hierarchical path when running low
+    if( !m_pendingRefinements.empty() )
+    {
+        RefineWaypointList(handle, waypointList);
+    }
+
+    return waypointList;
 }
 
 /**
-* Runs a single pass of the A* computation. Updates state when computation complete.
-* Compute paths. Only works on path calculations for a specific interval.
+* Releases the path data of an object leaving the database: its waypoint
+* list returns to the pool, queued requests are dropped, requests being
+* searched complete without a waypoint list and its pursuit planner is
+* released.
 */
-void WorldData::ComputePaths()
+void WorldData::ReleaseObject(objectID id)
 {
-    // check if a path computation in progress
-    if(m_bPathInProgress)
+    std::map<objectID, WaypointHandle>::iterator handle = m_waypointHandles.find(id);
+    if( handle != m_waypointHandles.end() )
     {
-        std::list<PathRequest>::iterator req = m_requestList.begin();
-        
-        // run computation
-        if( RunComputationLoop(*req) )
-        {
-            // request complete, reset computation
-            m_bPathInProgress = false;
-
-            // send completion message
-            g_database.SendMsgFromSystem(m_requestList.begin()->id, MSG_PathComputed);
-
-            // store completed waypoints
-            m_completeWaypointLists[req->id] = req->waypointList;
+        m_pendingRefinements.erase(handle->second);
+        m_waypointStore.Release(handle->second);
+        m_waypointHandles.erase(handle);
+    }
 
-            // remove request
-            m_requestList.pop_front();
-        }
+    for(std::vector<PathQuery>::iterator query = m_vQueuedQueries.begin(); query != m_vQueuedQueries.end(); )
+    {
+        if( query->id == id )
+            query = m_vQueuedQueries.erase(query);
+        else
+            ++query;
     }
 
-    // start new request if one in queue
-    else if(!m_bPathInProgress && !m_requestList.empty() )
+    for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end(); ++req)
     {
-        // make search in progress
-        m_bPathInProgress = true;    
-    
-        // clear list
-        m_mNodeList.clear();
+        if( req->id == id )
+            req->id = INVALID_OBJECT_ID;
+    }
 
-        // create starting node
-        CreateNode(m_requestList.begin()->nkPos, m_requestList.begin()->nkDestPos, m_mNodeList.end());
+    ReleasePursuit(id);
+}
+
+/**
+* Clears an object waypoint list.
+*/
+void WorldData::ClearWaypointList(objectID id)
+{
+    std::map<objectID, WaypointHandle>::iterator handle = m_waypointHandles.find(id);
+    if( handle != m_waypointHandles.end() )
+    {
+        m_waypointStore.Get(handle->second)->clear();
+        m_pendingRefinements.erase(handle->second);
     }
 }
 
 /**
-* Runs A* computation for a specific duration on the request. 
-* If request completed, returns true; otherwise false.
+* Finds the direction from the position towards the goal position, using the
+* flow field for the goal cell. Fields are computed a bounded number of cells
+* per frame, so the result is pending until the field reaches the position.
 */
-bool WorldData::RunComputationLoop(const PathRequest& req)
+PursuitStatus WorldData::GetFlowDirection(const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, D3DXVECTOR2* vDirection)
 {
-    bool bComplete = false;
+    NodeKey nkPos;
+    NodeKey nkGoal;
+    GetRowColumn(vPos, &nkPos);
+    GetRowColumn(vGoalPos, &nkGoal);
 
-    // loop until out of computation time (5ms)
-    float fStartTime = g_time.GetCurTime();
-    while( (g_time.GetCurTime() - fStartTime) < 0.005 )
-    {
-        // get waypoint list
-        PathWaypointList* waypointList = &(m_requestList.begin()->waypointList);
+    FlowField* field = GetFlowField(nkGoal);
+    StepFlowField(field);
 
-        // pop lowest cost
-        NodeList::iterator nLowest = FindLowestCostNode();
+    // find next cell
+    NodeKey nkNext;
+    if( !field->GetNextCell(nkPos, &nkNext) )
+        return field->IsComplete() ? kPursuitUnreachable : kPursuitPending;
 
-        // if no nodes open, done
-        if( nLowest == m_mNodeList.end() )
-        {
-            // no path, push current position
-            waypointList->push_back( GetCoordinates(req.nkPos) );
-            bComplete = true;
-            break;
-        }
+    GetStepDirection(vPos, vGoalPos, nkPos, nkGoal, nkNext, vDirection);
+    return kPursuitMove;
+}
 
-        // if lowest cost is destination, done
-        else if( nLowest->loc.iRow == req.nkDestPos.iRow && nLowest->loc.iCol == req.nkDestPos.iCol )
-        {
-            // push all waypoints
-            AddWaypoints(waypointList, nLowest);
+/**
+* Finds the direction for a pursuer from its position towards a moving goal.
+* By default pursuers of the same goal cell share its flow field. With
+* incremental pursuit, each pursuer keeps its own D* Lite planner alive
+* between calls, so goal moves and world changes only repair the affected
+* part of its search. Planners run on the main thread within the frame
+* search budget shared with path requests, a bounded number of cells per
+* call, so a long search reports pending for a few frames before giving a
+* direction. Large worlds always use planners, since their cell tables only
+* hold the cells searched while a flow field holds every cell.
+*/
+PursuitStatus WorldData::GetPursuitDirection(objectID id, const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, D3DXVECTOR2* vDirection)
+{
+    if( !m_incrementalPursuit && !m_bLargeWorld )
+        return GetFlowDirection(vPos, vGoalPos, vDirection);
 
-            // run catmull-rom if requested
-            if(m_smooth)
-            {
-                SmoothWaypoints(waypointList);
-            }
-            
-            bComplete = true;
-            break;
-        }
+    NodeKey nkPos;
+    NodeKey nkGoal;
+    GetRowColumn(vPos, &nkPos);
+    GetRowColumn(vGoalPos, &nkGoal);
 
-        // otherwise, add all neighboring nodes
+    // find planner, or reuse a released one
+    DStarLite*& planner = m_pursuitPlanners[id];
+    if( !planner )
+    {
+        if( m_vFreePlanners.empty() )
+        {
+            planner = new DStarLite(m_worldFile);
+        }
         else
         {
-            // add neighbor nodes
-            AddNeighborNodes(nLowest, req.nkDestPos);
-
-            // move node to closed list
-            nLowest->bClosed = true;
-            
-            // set terrain color (for closed node)
-	        //g_terrain.SetColor( nLowest->loc.iRow, nLowest->loc.iCol, DEBUG_COLOR_YELLOW );
+            planner = m_vFreePlanners.back();
+            m_vFreePlanners.pop_back();
         }
     }
 
-    return bComplete;
+    // frame search budget used up, keep heading
+    if( m_dPursuitTime >= kSearchBudget )
+        return kPursuitPending;
+
+    // repair plan and find next cell
+    double dStartTime = g_time.GetHighResolutionSeconds();
+    planner->Update(nkPos, nkGoal, kPursuitExpansionsPerUpdate);
+    m_dPursuitTime += g_time.GetHighResolutionSeconds() - dStartTime;
+    m_iPursuitExpansions += planner->GetExpandedCount();
+
+    NodeKey nkNext;
+    if( !planner->IsComplete() )
+        return kPursuitPending;
+    if( !planner->GetNextCell(&nkNext) )
+        return kPursuitUnreachable;
+
+    GetStepDirection(vPos, vGoalPos, nkPos, nkGoal, nkNext, vDirection);
+    return kPursuitMove;
 }
 
 /**
-* Push all waypoints to the movement list
+* Releases the pursuit planner of an object. The planner is cleared and kept
+* for the next pursuit unless enough are kept or its table grew large.
 */
-void WorldData::AddWaypoints(PathWaypointList* waypointList, NodeList::iterator position)
+void WorldData::ReleasePursuit(objectID id)
 {
-    NodeList::iterator prev = m_mNodeList.end();
-    NodeList::iterator next = m_mNodeList.end();
-
-    // until starting parent node reached
-    while(position != m_mNodeList.end())
+    std::map<objectID, DStarLite*>::iterator planner = m_pursuitPlanners.find(id);
+    if( planner != m_pursuitPlanners.end() )
     {
-        // set next node
-        next = position->nParent;
-
-        // check for node rubberbanding if requested
-        if( m_rubberband && CheckNodeRubberband(position, prev, next) )
+        if( (int)m_vFreePlanners.size() < kMaxFreePlanners && planner->second->GetTableSize() <= kMaxFreePlannerTable )
         {
-            // remove node
-            prev->nParent = next;
-            position = prev;
+            planner->second->Clear();
+            m_vFreePlanners.push_back(planner->second);
         }
-
-        // node required, push point to front
         else
         {
-            D3DXVECTOR2 point = GetCoordinates( position->loc );
-            waypointList->push_front( point );
+            delete planner->second;
         }
-
-        // set previous and move to next position
-        prev = position;
-        position = position->nParent;
-    }  
+        m_pursuitPlanners.erase(planner);
+    }
 }
 
 /**
-* Smooth the specified waypoint list using catmull-rom.
+* Turns incremental pursuit on or off. Turning it off releases the planners;
+* pursuers continue on the shared flow fields.
 */
-void WorldData::SmoothWaypoints(PathWaypointList* waypointList)
+void WorldData::SetIncrementalPursuit(bool bIncrementalPursuit)
 {
-    float fTotalDist = 0.0f;
-    float fAvgDist = 0.0f;
-    int iPointCount = 0;
+    m_incrementalPursuit = bIncrementalPursuit;
 
-    // find average point distance
-    for(PathWaypointList::iterator cur = waypointList->begin(); cur != waypointList->end(); ++cur)
+    while( !m_incrementalPursuit && !m_pursuitPlanners.empty() )
     {
-        // find next point
-        PathWaypointList::iterator next = cur; 
-        ++next;
+        ReleasePursuit(m_pursuitPlanners.begin()->first);
+    }
+}
 
-        // compute distance vector between current and next point
-        if( next != waypointList->end() )
+/**
+* Computes the normalized direction towards the next cell center, or towards
+* the goal itself once in its cell.
+*/
+void WorldData::GetStepDirection(const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, const NodeKey& nkPos, const NodeKey& nkGoal, const NodeKey& nkNext, D3DXVECTOR2* vDirection)
+{
+    if( nkPos.iRow == nkGoal.iRow && nkPos.iCol == nkGoal.iCol )
+        *vDirection = vGoalPos - vPos;
+    else
+        *vDirection = GetCoordinates(nkNext) - vPos;
+
+    if( D3DXVec2Length(vDirection) > 0.0f )
+        D3DXVec2Normalize(vDirection, vDirection);
+}
+
+/**
+* Returns the flow field for the goal cell. Fields are shared by every caller
+* with the same goal cell and only change goal when the goal cell changes: a
+* field not used this frame whose goal is a neighbor of the new goal is
+* repaired incrementally, otherwise the least recently used field is reused.
+*/
+FlowField* WorldData::GetFlowField(const NodeKey& nkGoal)
+{
+    // world changed, recompute every field
+    if( m_uFlowFieldVersion != m_worldFile.GetVersion() )
+    {
+        for(std::vector<FlowField*>::iterator field = m_vFlowFields.begin(); field != m_vFlowFields.end(); ++field)
         {
-            D3DXVECTOR2 vDist = (*next) - (*cur);
+            (*field)->Invalidate();
+        }
+        m_uFlowFieldVersion = m_worldFile.GetVersion();
+    }
 
-            // add distance to total
-            fTotalDist += D3DXVec2Length(&vDist);
-            ++iPointCount;
+    // existing field
+    for(std::vector<FlowField*>::iterator field = m_vFlowFields.begin(); field != m_vFlowFields.end(); ++field)
+    {
+        if( (*field)->HasGoal(nkGoal) )
+        {
+            (*field)->SetLastUsedFrame(m_uFrame);
+            return (*field);
         }
     }
 
-    // compute average
-    fAvgDist = fTotalDist / iPointCount;
+    FlowField* reuse = NULL;
 
-    // make points evenly spaced (for catmull-rom)
-    PathWaypointList::iterator cur = waypointList->begin();
+    // field for a goal that moved one cell
+    for(std::vector<FlowField*>::iterator field = m_vFlowFields.begin(); field != m_vFlowFields.end() && !reuse; ++field)
+    {
+        if( (*field)->GetLastUsedFrame() != m_uFrame && (*field)->IsNeighborGoal(nkGoal) )
+            reuse = (*field);
+    }
 
-    while( cur != waypointList->end() )
+    // new field
+    if( !reuse && (int)m_vFlowFields.size() < kMaxFlowFields )
     {
-        // find next point
-        PathWaypointList::iterator next = cur; 
-        ++next;
+        reuse = new FlowField(m_worldFile);
+        m_vFlowFields.push_back(reuse);
+    }
 
-        // check for valid next point
-        if( next != waypointList->end() )
+    // least recently used field
+    if( !reuse )
+    {
+        reuse = m_vFlowFields.front();
+        for(std::vector<FlowField*>::iterator field = m_vFlowFields.begin(); field != m_vFlowFields.end(); ++field)
         {
-            // compute distance vector between current and next point
-            D3DXVECTOR2 vDist = (*next) - (*cur);
-
-            // if distance greater than average, insert a new point in the middle
-            if( D3DXVec2Length(&vDist) > fAvgDist )
-            {
-                D3DXVECTOR2 vNewPoint = (*cur) + vDist/2.0f;
-                waypointList->insert(next, vNewPoint);
-                continue;
-            }
+            if( (*field)->GetLastUsedFrame() < reuse->GetLastUsedFrame() )
+                reuse = (*field);
         }
+    }
 
-        // move to next point
-        ++cur;
+    reuse->BeginGoal(nkGoal);
+    reuse->SetLastUsedFrame(m_uFrame);
+    return reuse;
+}
+
+/**
+* Computes the next part of an incomplete flow field, once per frame and
+* within the frame search budget shared with path requests
+*/
+void WorldData::StepFlowField(FlowField* field)
+{
+    if( field->IsComplete() || field->GetStepFrame() == m_uFrame || m_dPursuitTime >= kSearchBudget )
+        return;
+
+    field->SetStepFrame(m_uFrame);
+
+    int iUpdated = field->GetUpdatedCount();
+    double dStartTime = g_time.GetHighResolutionSeconds();
+    field->Step(kFlowFieldExpansionsPerUpdate);
+    m_dPursuitTime += g_time.GetHighResolutionSeconds() - dStartTime;
+    m_iPursuitExpansions += field->GetUpdatedCount() - iUpdated;
+}
+
+/**
+* Computes paths for the frame. Without worker threads, searches run on the
+* main thread within the frame budget. Completed requests are then finished
+* in request order.
+*/
+void WorldData::ComputePaths()
+{
+    m_pathStats.iFrameExpansions = m_iPursuitExpansions;
+
+    // batch the requests made since the last computation
+    if( !m_vQueuedQueries.empty() )
+    {
+        AddPathRequests(m_vQueuedQueries);
+        m_vQueuedQueries.clear();
     }
 
-    // add catmull rom points
-    PathWaypointList::iterator p1 = waypointList->begin(); 
-    
-    while(p1 != waypointList->end())
-    {
-        // determine next point
-        PathWaypointList::iterator next = p1; ++next; 
-        
-        // compute points from p1
-        PathWaypointList::iterator p0 = p1; 
-        PathWaypointList::iterator p2 = p1; 
-        PathWaypointList::iterator p3 = p1;
-
-        // compute previous point (p0)
-        if(p0 != waypointList->begin())
+    // run main thread searches
+    if(!m_pPathThreads)
+    {
+        RunComputationLoop();
+    }
+
+    // finish completed requests
+    CollectCompletedPaths();
+
+    if( m_pathStats.iFrameExpansions > m_pathStats.iMaxFrameExpansions )
+        m_pathStats.iMaxFrameExpansions = m_pathStats.iFrameExpansions;
+
+    // pursuit work done after this computation counts towards the next
+    m_dPursuitTime = 0.0;
+    m_iPursuitExpansions = 0;
+}
+
+/**
+* Runs the main thread searches until they are done or the frame budget is
+* used up. Up to kMaxSearchesInFlight requests are searched round-robin, so
+* a long search does not hold up the requests queued behind it. Time is
+* measured with the high resolution clock, not the frame time.
+*/
+void WorldData::RunComputationLoop()
+{
+    // time used by pursuit planners and flow fields counts against the budget
+    double dStartTime = g_time.GetHighResolutionSeconds() - m_dPursuitTime;
+    bool bSearching = true;
+
+    while( bSearching && (g_time.GetHighResolutionSeconds() - dStartTime) < kSearchBudget )
+    {
+        // start waiting requests on free searches
+        StartSearches(dStartTime);
+
+        // run each search for a slice
+        bSearching = false;
+        for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end(); ++req)
         {
-            --p0;
-        }
+            if( !req->pSearch )
+                continue;
+
+            int iExpanded = req->pSearch->GetExpandedCount();
+            PathSearch::SearchResult result = req->pSearch->Step(kSearchExpansionsPerCheck);
+            m_pathStats.iFrameExpansions += req->pSearch->GetExpandedCount() - iExpanded;
 
-        // compute next points (decrement if last point)
-        ++p2;
-        if(p2 == waypointList->end()) 
-        { 
-            break;    
+            if( result == PathSearch::kSearchInProgress )
+                bSearching = true;
+            else
+                FinishSearch(*req);
         }
-        else
+
+        // more requests may be waiting for the searches just freed
+        for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end() && !bSearching; ++req)
         {
-            p3 = p2; 
-            ++p3;
-            if(p3 == waypointList->end())
-            { 
-                --p3; 
-            }
+            if( !IsRequestComplete(*req) )
+                bSearching = true;
         }
+    }
 
-        // compute and add calmull-rom points
-        D3DXVECTOR2 result;
-        waypointList->insert(p2, *D3DXVec2CatmullRom(&result, &(*p0), &(*p1), &(*p2), &(*p3), 0.25f));
-        waypointList->insert(p2, *D3DXVec2CatmullRom(&result, &(*p0), &(*p1), &(*p2), &(*p3), 0.50f));
-        waypointList->insert(p2, *D3DXVec2CatmullRom(&result, &(*p0), &(*p1), &(*p2), &(*p3), 0.75f));
-
-        // move past added points
-        p1 = next;
+    // frame over budget
+    if( (g_time.GetHighResolutionSeconds() - dStartTime) > kSearchBudget + kSearchBudgetTolerance )
+    {
+        ++m_pathStats.iBudgetOverruns;
     }
 }
 
 /**
-* Check if node is unnecessary and should be removed from path.
-* Return true if remove, else false
+* Assigns free main thread searches to waiting requests, in request order.
+* Long hierarchical requests only need their abstract path and first
+* cluster, so they are completed immediately while budget remains.
 */
-bool WorldData::CheckNodeRubberband(NodeList::iterator position, NodeList::iterator prev, NodeList::iterator next)
+void WorldData::StartSearches(double dStartTime)
 {
-    int iMinRow = position->loc.iRow;
-    int iMaxRow = position->loc.iRow;
-    int iMinCol = position->loc.iCol;
-    int iMaxCol = position->loc.iCol;
-
-    // check for valid prev and next nodes
-    if(prev == m_mNodeList.end() || next == m_mNodeList.end())
+    for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end() && !m_vFreeSearches.empty(); ++req)
     {
-        // node position required for path
-        return false;
-    }
+        if( (g_time.GetHighResolutionSeconds() - dStartTime) >= kSearchBudget )
+            break;
 
-    // form node set bounds
-    UpdateRubberbandBounds(prev, iMinRow, iMaxRow, iMinCol, iMaxCol);
-    UpdateRubberbandBounds(next, iMinRow, iMaxRow, iMinCol, iMaxCol);
+        // batch jobs are searched by their first request
+        if( req->pSearch || IsRequestComplete(*req) || req->iGroupIndex > 0 )
+            continue;
 
-    // check each point for wall
-    for(int row = iMinRow; row <= iMaxRow; row++)
-    {
-        for(int col = iMinCol; col <= iMaxCol; col++)
+        PathJob* job = req->pJob;
+
+        PathSearch* search = m_vFreeSearches.back();
+
+        // batch: one reverse search from the shared destination
+        if( !job->groupStarts.empty() )
         {
-            // wall found, node required for path
-            if( m_worldFile(row, col) == WorldFile::OCCUPIED_CELL )
-                return false;
+            m_vFreeSearches.pop_back();
+            req->pSearch = search;
+            req->pSearch->BeginReverse(job->nkDest, job->groupStarts, job->options);
+            continue;
         }
-    }
 
-    return true;
+        // long paths: abstract path and first cluster
+        if( m_pAbstraction && m_pAbstraction->IsLongPath(job->nkStart, job->nkDest) )
+        {
+            job->result = m_pAbstraction->BeginPath(search, job->nkStart, job->nkDest, job->options, &job->abstractPath, &job->nodeList);
+            job->iExpanded = search->GetExpandedCount();
+            job->lComplete = 1;
+            m_pathStats.iFrameExpansions += job->iExpanded;
+            continue;
+        }
+
+        // create starting node
+        m_vFreeSearches.pop_back();
+        req->pSearch = search;
+        req->pSearch->Begin(job->nkStart, job->nkDest, job->options);
+    }
 }
 
 /**
-* Update row and column bounds for checking rubberbanding.
+* Stores the result of a finished main thread search in the request job and
+* releases the search.
 */
-void WorldData::UpdateRubberbandBounds(NodeList::iterator node, int& iMinRow, int& iMaxRow, int& iMinCol, int& iMaxCol)
+void WorldData::FinishSearch(PathRequest& req)
 {
-    // minimum row
-    if(iMinRow > node->loc.iRow)
-        iMinRow = node->loc.iRow;
+    PathJob* job = req.pJob;
+
+    job->result = req.pSearch->GetResult();
+    job->iExpanded = req.pSearch->GetExpandedCount();
+    job->abstractPath.nodes.clear();
+    job->abstractPath.iNext = 0;
 
-    // maximum row
-    if(iMaxRow < node->loc.iRow)
-        iMaxRow = node->loc.iRow;
+    job->nodeList.clear();
+    if( job->result == PathSearch::kSearchComplete )
+    {
+        req.pSearch->GetPath(&job->nodeList);
+    }
+
+    // batch: path from each start
+    job->groupNodeLists.resize(job->groupStarts.size());
+    for(int i = 0; i < (int)job->groupStarts.size(); ++i)
+    {
+        req.pSearch->GetPathFrom(job->groupStarts[i], &job->groupNodeLists[i]);
+    }
 
-    // minimum column
-    if(iMinCol > node->loc.iCol)
-        iMinCol = node->loc.iCol;
+    job->lComplete = 1;
 
-    // maximum column
-    if(iMaxCol < node->loc.iCol)
-        iMaxCol = node->loc.iCol;
+    m_vFreeSearches.push_back(req.pSearch);
+    req.pSearch = NULL;
 }
 
 /**
-* Add all neighboring nodes
+* Completes finished requests. Requests are completed strictly in the order
+* they were added, so path completion messages are delivered in the same
+* order regardless of which search finished first.
 */
-void WorldData::AddNeighborNodes(NodeList::iterator position, const NodeKey& nkDest)
+void WorldData::CollectCompletedPaths()
 {
-    NodeKey nkPos = position->loc;
-    NodeKey nkNew;
+    double dTime = g_time.GetHighResolutionSeconds();
 
-    bool bUpWall;
-    bool bDownWall;
-    bool bLeftWall;
-    bool bRightWall;
+    while( !m_requestList.empty() && IsRequestComplete(*m_requestList.begin()) )
+    {
+        std::list<PathRequest>::iterator req = m_requestList.begin();
 
-    ////////////////////
-    // ADJACENT NODES //
-    ////////////////////
+        // worker thread expansions are counted when collected (once per batch)
+        if( m_pPathThreads && req->pJob && req->iGroupIndex <= 0 )
+        {
+            m_pathStats.iFrameExpansions += req->pJob->iExpanded;
+        }
 
-    // up
-    nkNew.iRow = nkPos.iRow + 1;
-    nkNew.iCol = nkPos.iCol;
+        // queue wait statistics
+        double dWaitTime = dTime - req->dRequestTime;
+        m_pathStats.dLastWaitTime = dWaitTime;
+        m_pathStats.dTotalWaitTime += dWaitTime;
+        if( dWaitTime > m_pathStats.dMaxWaitTime )
+            m_pathStats.dMaxWaitTime = dWaitTime;
+        ++m_pathStats.iCompleted;
 
-    if( !(bUpWall = (m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL)) )
-        CreateNode(nkNew, nkDest, position);
+        CompleteRequest(*req);
 
-    // right
-    nkNew.iRow = nkPos.iRow;
-    nkNew.iCol = nkPos.iCol + 1;
+        // remove request (batch jobs with their last request)
+        if( IsLastJobRequest(*req) )
+            delete req->pJob;
+        m_requestList.pop_front();
+    }
+}
 
-    if( !(bRightWall = (m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL)) )
-        CreateNode(nkNew, nkDest, position);
+/**
+* Resets the path computation statistics.
+*/
+void WorldData::ResetPathStats()
+{
+    m_pathStats.iFrameExpansions = 0;
+    m_pathStats.iMaxFrameExpansions = 0;
+    m_pathStats.iBudgetOverruns = 0;
+    m_pathStats.iCompleted = 0;
+    m_pathStats.dLastWaitTime = 0.0;
+    m_pathStats.dMaxWaitTime = 0.0;
+    m_pathStats.dTotalWaitTime = 0.0;
+    m_pathStats.iCacheHits = 0;
+    m_pathStats.iCacheMisses = 0;
+}
 
-    // down
-    nkNew.iRow = nkPos.iRow - 1;
-    nkNew.iCol = nkPos.iCol;
+/**
+* Builds the waypoint list for a finished search, stores it and notifies
+* the requesting object. Complete paths are added to the path cache; an
+* unrefined abstract path is kept for lazy refinement. Requests served from
+* the cache already hold their waypoints.
+*/
+void WorldData::CompleteRequest(PathRequest& req)
+{
+    PathJob* job = req.pJob;
+    bool bRefining = false;
 
-    if( !(bDownWall = (m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL)) )
-        CreateNode(nkNew, nkDest, position);
+    if(job)
+    {
+        PathSearch::SearchResult result = job->result;
+        const PathNodeList* nodeList = &job->nodeList;
 
-    // left
-    nkNew.iRow = nkPos.iRow;
-    nkNew.iCol = nkPos.iCol - 1;
+        // batch requests take the path from their own start
+        if( req.iGroupIndex != -1 )
+        {
+            nodeList = &job->groupNodeLists[req.iGroupIndex];
+            result = nodeList->empty() ? PathSearch::kSearchNoPath : PathSearch::kSearchComplete;
+        }
 
-    if( !(bLeftWall = (m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL)) )
-        CreateNode(nkNew, nkDest, position);
+        // if no nodes open, no path
+        if( result == PathSearch::kSearchNoPath )
+        {
+            // push current position
+            req.waypointList.push_back( GetCoordinates(req.nkPos) );
+        }
 
-    ////////////////////
-    // DIAGONAL NODES //
-    ////////////////////
+        // if destination reached, done
+        else if( result == PathSearch::kSearchComplete )
+        {
+            // push all waypoints (rubberbanded by the search if requested)
+            AddWaypoints(&req.waypointList, *nodeList);
 
-    // upper right
-    nkNew.iRow = nkPos.iRow + 1;
-    nkNew.iCol = nkPos.iCol + 1;
+            // run catmull-rom if requested
+            if(req.cacheKey.bSmooth)
+            {
+                SmoothWaypoints(&req.waypointList);
+            }
 
-    if( !(m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL) && !bUpWall && !bRightWall )
-        CreateNode(nkNew, nkDest, position);
+            bRefining = !job->abstractPath.IsRefined();
+        }
 
-    // lower right
-    nkNew.iRow = nkPos.iRow - 1;
-    nkNew.iCol = nkPos.iCol + 1;
+        // cache complete paths found on the current world
+        if( !bRefining && req.uWorldVersion == m_worldFile.GetVersion() )
+        {
+            AddCachedPath(req.cacheKey, req.waypointList);
+        }
+    }
 
-    if( !(m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL) && !bDownWall && !bRightWall )
-        CreateNode(nkNew, nkDest, position);
+    // requester left the database
+    if( req.id == INVALID_OBJECT_ID )
+        return;
 
-    // lower left
-    nkNew.iRow = nkPos.iRow - 1;
-    nkNew.iCol = nkPos.iCol - 1;
+    // store completed waypoints
+    WaypointHandle handle = GetWaypointHandle(req.id);
+    PathWaypointList* waypointList = m_waypointStore.Get(handle);
+    waypointList->clear();
+    waypointList->append(req.waypointList, 0);
 
-    if( !(m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL) && !bDownWall && !bLeftWall )
-        CreateNode(nkNew, nkDest, position);
+    // keep the rest of a hierarchical path
+    m_pendingRefinements.erase(handle);
+    if(bRefining)
+    {
+        PathRefinement& refinement = m_pendingRefinements[handle];
+        refinement.path = job->abstractPath;
+        refinement.vLastWaypoint = req.waypointList.back();
+    }
 
-    // upper left
-    nkNew.iRow = nkPos.iRow + 1;
-    nkNew.iCol = nkPos.iCol - 1;
+    // send completion message
+    g_database.SendMsgFromSystem(req.id, MSG_PathComputed);
+}
 
-    if( !(m_worldFile(nkNew.iRow, nkNew.iCol) == WorldFile::OCCUPIED_CELL) && !bUpWall && !bLeftWall )
-        CreateNode(nkNew, nkDest, position);
+/**
+* Path cache key ordering
+*/
+bool WorldData::PathCacheKey::operator<(const PathCacheKey& rhs) const
+{
+    if( nkPos.iRow != rhs.nkPos.iRow ) return nkPos.iRow < rhs.nkPos.iRow;
+    if( nkPos.iCol != rhs.nkPos.iCol ) return nkPos.iCol < rhs.nkPos.iCol;
+    if( nkDestPos.iRow != rhs.nkDestPos.iRow ) return nkDestPos.iRow < rhs.nkDestPos.iRow;
+    if( nkDestPos.iCol != rhs.nkDestPos.iCol ) return nkDestPos.iCol < rhs.nkDestPos.iCol;
+    if( options.bHeuristicCalc != rhs.options.bHeuristicCalc ) return options.bHeuristicCalc < rhs.options.bHeuristicCalc;
+    if( options.fHeuristicWeight != rhs.options.fHeuristicWeight ) return options.fHeuristicWeight < rhs.options.fHeuristicWeight;
+    if( options.bJumpPoint != rhs.options.bJumpPoint ) return options.bJumpPoint < rhs.options.bJumpPoint;
+    if( options.bRubberband != rhs.options.bRubberband ) return options.bRubberband < rhs.options.bRubberband;
+    if( options.bAnyAngle != rhs.options.bAnyAngle ) return options.bAnyAngle < rhs.options.bAnyAngle;
+    if( options.pLandmarks != rhs.options.pLandmarks ) return options.pLandmarks < rhs.options.pLandmarks;
+    return bSmooth < rhs.bSmooth;
 }
 
 /**
-* Creates a new node
+* Looks up a cached waypoint list and marks it most recently used. The cache
+* is emptied when the world has changed since the paths were found.
 */
-void WorldData::CreateNode(const NodeKey& nkPos, const NodeKey& nkDest, NodeList::iterator parent)
+bool WorldData::FindCachedPath(const PathCacheKey& key, PathWaypointArray* waypointList)
 {
-    NodeData data;
+    // world changed, cached paths are stale
+    if( m_uPathCacheVersion != m_worldFile.GetVersion() )
+    {
+        m_pathCache.clear();
+        m_pathCacheIndex.clear();
+        m_uPathCacheVersion = m_worldFile.GetVersion();
+    }
 
-    // check if within bounds
-    if( nkPos.iCol >= m_worldFile.GetWidth() ||
-        nkPos.iCol < 0 ||
-        nkPos.iRow >= m_worldFile.GetHeight() ||
-        nkPos.iRow < 0)
+    std::map<PathCacheKey, PathCacheList::iterator>::iterator index = m_pathCacheIndex.find(key);
+    if( index == m_pathCacheIndex.end() )
     {
-        return;
+        ++m_pathStats.iCacheMisses;
+        return false;
     }
 
-    // set location data
-    data.loc = nkPos;
+    // move to front
+    m_pathCache.splice(m_pathCache.begin(), m_pathCache, index->second);
 
-    // set parent node
-    data.nParent = parent;
+    *waypointList = index->second->waypointList;
+    ++m_pathStats.iCacheHits;
+    return true;
+}
 
-    // compute current distance cost
-    if(parent != m_mNodeList.end())
-    {
-        data.fDistanceCost = ComputeDistanceCost(nkPos, parent);
-    }
-    else
+/**
+* Adds a waypoint list to the cache, evicting the least recently used entry
+* when full.
+*/
+void WorldData::AddCachedPath(const PathCacheKey& key, const PathWaypointArray& waypointList)
+{
+    if( m_uPathCacheVersion != m_worldFile.GetVersion() || m_pathCacheIndex.find(key) != m_pathCacheIndex.end() )
+        return;
+
+    // evict least recently used
+    if( (int)m_pathCache.size() >= kPathCacheSize )
     {
-        data.fDistanceCost = 0.0f;
+        m_pathCacheIndex.erase(m_pathCache.back().key);
+        m_pathCache.pop_back();
     }
 
-    // compute heustic cost (future distance)
-    data.fHeuristicCost = m_heuristicWeight * ComputeHeuristicCost(nkPos, nkDest);
+    PathCacheEntry entry;
+    entry.key = key;
+    entry.waypointList = waypointList;
 
-    // compute total cost
-    data.fTotalCost = data.fDistanceCost + data.fHeuristicCost;
+    m_pathCache.push_front(entry);
+    m_pathCacheIndex[key] = m_pathCache.begin();
+}
 
-    // initialize
-    data.bClosed = false;
+/**
+* Refines the next cluster of a pending hierarchical path once fewer than
+* kRefineLookahead waypoints remain. Each refinement is bounded by a single
+* cluster search, independent of the world size.
+*/
+void WorldData::RefineWaypointList(WaypointHandle handle, PathWaypointList* waypointList)
+{
+    std::map<WaypointHandle, PathRefinement>::iterator refinement = m_pendingRefinements.find(handle);
+    if( refinement == m_pendingRefinements.end() )
+        return;
 
-    // check if it exists
-    NodeList::iterator node;
+    if( waypointList->size() >= kRefineLookahead )
+        return;
 
-    for(node = m_mNodeList.begin(); node != m_mNodeList.end(); ++node)
+    // refine next cluster
+    PathNodeList nodeList;
+    if( m_pAbstraction->RefineNext(m_pRefineSearch, GetSearchOptions(), &refinement->second.path, &nodeList) )
     {
-        if( (node->loc.iRow == nkPos.iRow) && (node->loc.iCol == nkPos.iCol) )
+        // smooth from the last refined waypoint so segments join
+        PathWaypointArray segment;
+        segment.push_back(refinement->second.vLastWaypoint);
+        AddWaypoints(&segment, nodeList);
+
+        if(m_smooth && !m_anyAngle)
         {
-            break;
+            SmoothWaypoints(&segment);
         }
-    }
 
-    // node does not exist
-    if( node == m_mNodeList.end() )
-    {
-        m_mNodeList.push_back(data);
-	    //g_terrain.SetColor( nkPos.iRow, nkPos.iCol, DEBUG_COLOR_BLUE );
+        // append all but the joining waypoint
+        refinement->second.vLastWaypoint = segment.back();
+        waypointList->append(segment, 1);
     }
 
-    // node exists with higher cost
-    else if( node->fTotalCost > data.fTotalCost )
+    // world changed under the path, stop at the last refined waypoint
+    else
     {
-        (*node) = data;
-	    //g_terrain.SetColor( nkPos.iRow, nkPos.iCol, DEBUG_COLOR_BLUE );
+        refinement->second.path.iNext = (int)refinement->second.path.nodes.size();
     }
 
-    // node exists with lower cost
-    else
+    // done refining
+    if( refinement->second.path.IsRefined() )
     {
-        // ignore
+        m_pendingRefinements.erase(refinement);
     }
 }
 
 /**
-* Compute distance cost
+* Turns any-angle paths on or off. Any-angle searches use neither jump point
+* search nor landmarks, so the landmark tables are built the first time they
+* can be used (never on large worlds).
 */
-float WorldData::ComputeDistanceCost(const NodeKey& nkPos, NodeList::iterator parent)
+void WorldData::SetAnyAngle(bool bAnyAngle)
 {
-    // get node and parent position
-    D3DXVECTOR2 vNodePos = GetCoordinates(nkPos);
-    D3DXVECTOR2 vParentPos = GetCoordinates(parent->loc);
-    D3DXVECTOR2 vDist;
-
-    // compute distance between node and parent (add to parent distance)
-    vDist = vNodePos - vParentPos;
-    return parent->fDistanceCost + D3DXVec2Length( &vDist );
+    m_anyAngle = bAnyAngle;
+
+    if( m_landmarks && !m_anyAngle && !m_pLandmarks && !m_bLargeWorld )
+        BuildLandmarks();
 }
 
 /**
-* Compute heuristic cost
+* Builds the landmark heuristic tables for the current world
 */
-float WorldData::ComputeHeuristicCost(const NodeKey& nkPos, const NodeKey& nkDest)
+void WorldData::BuildLandmarks()
 {
-    // get node and destination position
-    D3DXVECTOR2 vNodePos = GetCoordinates(nkPos);
-    D3DXVECTOR2 vDestPos = GetCoordinates(nkDest);
-    
-    float cost = 0.0f;
+    if( !m_pLandmarks )
+        m_pLandmarks = new PathLandmarks(m_worldFile, kLandmarkCount);
 
-    // cardinal/intercardinal
-    if(m_heuristicCalc)
-    {
-        // compute axis differences
-        float xDiff = abs(vNodePos.x - vDestPos.x);
-        float yDiff = abs(vNodePos.y - vDestPos.y);
+    m_pLandmarks->Build();
+    m_uLandmarkVersion = m_worldFile.GetVersion();
+}
 
-        // compute cost
-        cost = min(xDiff,yDiff) * sqrt(2.0f) + max(xDiff,yDiff) - min(xDiff,yDiff);
-    }
+/**
+* Rebuilds out of date landmark tables once the world has stopped changing
+* for kLandmarkRebuildFrames, so a burst of cell changes costs one rebuild.
+* Searches may still read the old tables, so new tables are built and the
+* old ones are retired until no request uses them.
+*/
+void WorldData::UpdateLandmarks()
+{
+    ReleaseRetiredLandmarks();
 
-    // eucladian
-    else
-    {
-        // calculate distance vector
-        D3DXVECTOR2 vDist;
-        vDist = vNodePos - vDestPos;
+    if( !m_landmarks || m_anyAngle || !m_pLandmarks || m_uLandmarkVersion == m_worldFile.GetVersion() )
+        return;
 
-        // compute cost
-        cost = D3DXVec2Length( &vDist );
+    // wait for the world to settle
+    if( m_uLandmarkChangeVersion != m_worldFile.GetVersion() )
+    {
+        m_uLandmarkChangeVersion = m_worldFile.GetVersion();
+        m_uLandmarkChangeFrame = m_uFrame;
+        return;
     }
 
-    return cost;
+    if( m_uFrame - m_uLandmarkChangeFrame < kLandmarkRebuildFrames )
+        return;
+
+    m_vRetiredLandmarks.push_back(m_pLandmarks);
+    m_pLandmarks = NULL;
+    BuildLandmarks();
 }
 
 /**
-* Find lowest cost node
+* Deletes retired landmark tables that no outstanding search job uses
 */
-WorldData::NodeList::iterator WorldData::FindLowestCostNode()
+void WorldData::ReleaseRetiredLandmarks()
 {
-    NodeList::iterator nLowest = m_mNodeList.end();
+    std::vector<PathLandmarks*>::iterator landmarks = m_vRetiredLandmarks.begin();
+    while( landmarks != m_vRetiredLandmarks.end() )
+    {
+        bool bInUse = false;
+        for(std::list<PathRequest>::iterator req = m_requestList.begin(); req != m_requestList.end() && !bInUse; ++req)
+        {
+            bInUse = req->pJob && req->pJob->options.pLandmarks == (*landmarks);
+        }
 
-    for(NodeList::iterator it = m_mNodeList.begin(); it != m_mNodeList.end(); ++it)
-    {     
-        // if not closed
-        if(!it->bClosed)
+        if( bInUse )
         {
-            // if nothing found yet or lowest cost, set node
-            if( nLowest == m_mNodeList.end() || it->fTotalCost < nLowest->fTotalCost )
-            {
-                nLowest = it;
-            }
+            ++landmarks;
+        }
+        else
+        {
+            delete (*landmarks);
+            landmarks = m_vRetiredLandmarks.erase(landmarks);
         }
     }
+}
+
+/**
+* Returns the search options for new requests.
+*/
+PathSearchOptions WorldData::GetSearchOptions() const
+{
+    PathSearchOptions options;
+    options.bHeuristicCalc = m_heuristicCalc;
+    options.fHeuristicWeight = m_heuristicWeight;
+    options.bJumpPoint = m_jumpPoint;
+    options.bRubberband = m_rubberband;
+    options.bAnyAngle = m_anyAngle;
+    options.pLandmarks = NULL;
+
+    // landmark distances are only admissible on the world they were built for
+    if( m_landmarks && !m_anyAngle && m_pLandmarks && m_uLandmarkVersion == m_worldFile.GetVersion() )
+    {
+        options.pLandmarks = m_pLandmarks;
+    }
+
+    return options;
+}
 
-    return nLowest;
+/**
+* Push all waypoints to the movement list
+*/
+void WorldData::AddWaypoints(PathWaypointArray* waypointList, const PathNodeList& nodeList)
+{
+    for(PathNodeList::const_iterator node = nodeList.begin(); node != nodeList.end(); ++node)
+    {
+        waypointList->push_back( GetCoordinates(*node) );
+    }
 }
 
 /**
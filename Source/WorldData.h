@@ -14,11 +14,17 @@
 #include <map>
 #include "gameobject.h"
 #include "WorldFile.h"
+#include "PathSearch.h"
+#include "PathAbstraction.h"
+#include "PathLandmarks.h"
+#include "FlowField.h"
+#include "DStarLite.h"
+#include "PathThreadPool.h"
+#include "WaypointStore.h"
+#include "WorldChunks.h"
+#include "TerrainGrid.h"
+#include "ClearanceField.h"
 
-
-/* path waypoint list */
-typedef std::list<D3DXVECTOR2> PathWaypointList;
-        
 const float kWorldScale = 1.0f;;
 
 /* debug drawing color */
@@ -36,8 +42,48 @@ enum DebugDrawingColor
 	DEBUG_COLOR_NUM
 };
 
+/* path computation statistics */
+struct PathStats
+{
+    int iFrameExpansions;       // nodes expanded last frame
+    int iMaxFrameExpansions;    // most nodes expanded in a frame
+    int iBudgetOverruns;        // frames over the main thread search budget
+    int iCompleted;             // requests completed
+    double dLastWaitTime;       // seconds from request to completion (last request)
+    double dMaxWaitTime;        // longest wait
+    double dTotalWaitTime;      // total wait of completed requests
+    int iCacheHits;             // requests served from the path cache
+    int iCacheMisses;           // requests searched
+};
+
+/* path request (batched requests) */
+struct PathQuery
+{
+    D3DXVECTOR2 vPos;           // current position
+    D3DXVECTOR2 vDestPos;       // destination position
+    objectID id;                // requesting object
+    double dRequestTime;        // time the request was made (seconds)
+};
+
+/* pursuit step result */
+enum PursuitStatus
+{
+    kPursuitMove,               // direction towards the goal found
+    kPursuitPending,            // plan not finished yet (no direction)
+    kPursuitUnreachable         // goal cannot be reached
+};
+
+/* terrain analysis layer */
+enum TerrainLayer
+{
+    kTerrainLayerOpenness,
+    kTerrainLayerOccupancy,
+    kTerrainLayerLineOfFire,
+    kTerrainLayerCount
+};
+
 /* world path computations */
-class WorldData : public GameObject, public Singleton<WorldData>
+class WorldData : public GameObject, public Singleton<WorldData>, public WorldChunkClient
 {
     public:
 
@@ -59,12 +105,31 @@ class WorldData : public GameObject, public Singleton<WorldData>
 
         // path requests
         void AddPathRequest(const D3DXVECTOR2& vCurPos, const D3DXVECTOR2& vDestPos, objectID id);
+        void AddPathRequests(const std::vector<PathQuery>& queries);
         D3DXVECTOR2 GetRandomMapLocation();
 
-        // waypoint lsits
-        PathWaypointList* GetWaypointList(objectID id);
+        // waypoint lsits (handle lookup once, list lookup per frame)
+        WaypointHandle GetWaypointHandle(objectID id);
+        PathWaypointList* GetWaypointList(WaypointHandle handle);
         void ClearWaypointList(objectID id);
 
+        // path data of an object leaving the database
+        void ReleaseObject(objectID id);
+
+        // path statistics
+        const PathStats& GetPathStats() const { return m_pathStats; }
+        void ResetPathStats();
+
+        // flow fields
+        PursuitStatus GetFlowDirection(const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, D3DXVECTOR2* vDirection);
+
+        // pursuit (shared flow fields, or an incremental planner per pursuer)
+        PursuitStatus GetPursuitDirection(objectID id, const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, D3DXVECTOR2* vDirection);
+        void ReleasePursuit(objectID id);
+        void SetIncrementalPursuit(bool bIncrementalPursuit);
+        void ToggleIncrementalPursuit() { SetIncrementalPursuit(!m_incrementalPursuit); }
+        bool IsIncrementalPursuit() const { return m_incrementalPursuit; }
+
         // debugging
         void SetTerrainAnalysisType(TerrainAnalysisType type) { m_terrainType = type; }
         void ToggleTerrainAnalysisType();
@@ -75,6 +140,21 @@ class WorldData : public GameObject, public Singleton<WorldData>
         void HidePathDebug() { m_debuglines = false; }
         void TogglePathDebug() { m_debuglines = !m_debuglines; }
 
+        // any-angle paths (turns off jump point search and landmarks)
+        void SetAnyAngle(bool bAnyAngle);
+        void ToggleAnyAngle() { SetAnyAngle(!m_anyAngle); }
+        bool IsAnyAngle() const { return m_anyAngle; }
+
+        // terrain analysis (resident chunks only; null elsewhere). Occupancy cells
+        // hold the sum of the agent stamps and may exceed one.
+        float* GetTerrainCell(TerrainLayer layer, int row, int col) const;
+
+        // distance to the nearest wall of every cell (whole world)
+        const ClearanceField& GetClearanceField() const { return m_clearance; }
+
+        // world chunks
+        WorldChunkData* LoadChunk(const WorldChunkBounds& bounds);
+
     protected:
 
         // game object methods
@@ -111,20 +191,40 @@ class WorldData : public GameObject, public Singleton<WorldData>
         // TERRAIN ANALYSIS //
         //////////////////////
 
-        float** m_fTerrainOpenness;
-        float** m_fTerrainOccupancy;
-        float** m_fTerrainLineOfFire;
+        /**
+        * Terrain analysis layers of one world chunk
+        */
+        class TerrainChunk : public WorldChunkData
+        {
+            public:
+                TerrainChunk() : grid(kWorldChunkSize, kWorldChunkSize, kTerrainLayerCount) {}
+                TerrainGrid grid;
+        };
+
+        /**
+        * Cell an agent's occupancy is stamped at
+        */
+        struct OccupancyStamp
+        {
+            int iRow;
+            int iCol;
+            unsigned int uFrame;                // last frame the agent was seen
+        };
 
+        int m_iChunkClient;                     // world chunk client index
         TerrainAnalysisType m_terrainType;      // terrain analysis type
         std::vector<CustomVertex> m_vQuads;     // debug line vertices
+        std::map<objectID, OccupancyStamp> m_occupancyStamps;  // stamped agents
 
-        float** AllocateTerrainGrid();
-        void DeleteTerrainGrid(float** fGrid);
         void GenerateTerrainQuads();
+        void ResetTerrainLayer(TerrainLayer layer);
+        void AnalyzeTerrainOpenness();
+        void FillTerrainOpenness(const int iChunk);
         void AnalyzeTerrainOccupancy();
+        void StampTerrainOccupancy(const int row, const int col, const float fScale, const int iChunk);
         void AnalyzeTerrainLineOfFire();
-        void UpdateTerrainGridCells(float** grid, const int row, const int col, const int range, const float value);
-        D3DXCOLOR GetTerrainColor(const int row, const int col);
+        void CastLineOfFire(const D3DXVECTOR2& vStart, const float fAngle, const float fValue);
+        void AddTerrainSpan(TerrainLayer layer, const int row, const int colMin, const int colMax, const float value, const float fMin, const float fMax, const int iChunk);
 
         /////////////////////
         // PATHING OPTIONS //
@@ -132,46 +232,111 @@ class WorldData : public GameObject, public Singleton<WorldData>
 
         // world info
         const WorldFile& m_worldFile;
+        ClearanceField m_clearance;     // wall distance of every cell
 
         // path options
         bool m_debuglines;          // show path debug lines
         bool m_rubberband;          // enable path rubberbanding
         bool m_heuristicCalc;       // true for cardinal/intercardinal; false for eucladian
-        bool m_smooth;              // enable catmull-rom path smoothing
+        bool m_smooth;              // enable catmull-rom path smoothing (grid paths only)
+        bool m_anyAngle;            // enable any-angle (Theta*) paths
+        bool m_jumpPoint;           // enable jump point search (uniform cost grid)
+        bool m_landmarks;           // enable landmark (ALT) heuristic
+        bool m_incrementalPursuit;  // pursue with incremental (D* Lite) planners instead of flow fields
         float m_heuristicWeight;    // heuristic weight (1.01f is preferred)
 
         //////////////////
         // A* node data //
         //////////////////
-        struct NodeKey;
-        struct NodeData;
-
-        // node list
-        typedef std::list<NodeData> NodeList;
 
         // node key
-        struct NodeKey
+        typedef PathNodeKey NodeKey;
+
+        std::vector<PathSearch*> m_vSearches;       // main thread searches (no worker threads)
+        std::vector<PathSearch*> m_vFreeSearches;   // main thread searches not in use
+        PathThreadPool* m_pPathThreads;             // worker threads (null if single threaded)
+        PathStats m_pathStats;                      // computation statistics
+        PathLandmarks* m_pLandmarks;                // landmark heuristic tables
+        unsigned int m_uLandmarkVersion;            // world version of the tables
+        unsigned int m_uLandmarkChangeVersion;      // world version last seen changing
+        unsigned int m_uLandmarkChangeFrame;        // frame the world was last seen changing
+        std::vector<PathLandmarks*> m_vRetiredLandmarks;    // replaced tables still used by searches
+
+        ////////////////////////////
+        // hierarchical path data //
+        ////////////////////////////
+
+        /**
+        * Hierarchical path still being refined as the agent consumes its
+        * waypoints.
+        */
+        struct PathRefinement
         {
-            int iRow;
-            int iCol;
+            AbstractPath path;              // abstract path and refinement position
+            D3DXVECTOR2 vLastWaypoint;      // last refined waypoint (smoothing continuity)
         };
 
-        // node data
-        struct NodeData
-        {
-            NodeKey loc;
+        PathAbstraction* m_pAbstraction;    // cluster graph (null for small worlds)
+        PathSearch* m_pRefineSearch;        // main thread search for refinement
+        bool m_bLargeWorld;                 // searches windowed to one cluster, no landmarks or flow fields
+        std::map<WaypointHandle, PathRefinement> m_pendingRefinements;
+
+        /////////////////
+        // flow fields //
+        /////////////////
+
+        std::vector<FlowField*> m_vFlowFields;  // fields by goal cell (least recently used reused)
+        unsigned int m_uFrame;                  // update frame counter
+        unsigned int m_uFlowFieldVersion;       // world version of the fields
+
+        FlowField* GetFlowField(const NodeKey& nkGoal);
+        void StepFlowField(FlowField* field);
+        void GetStepDirection(const D3DXVECTOR2& vPos, const D3DXVECTOR2& vGoalPos, const NodeKey& nkPos, const NodeKey& nkGoal, const NodeKey& nkNext, D3DXVECTOR2* vDirection);
 
-            NodeList::iterator nParent;
+        ///////////////////////
+        // pursuit planners //
+        ///////////////////////
 
-            float fDistanceCost;
-            float fHeuristicCost;
-            float fTotalCost;
+        std::map<objectID, DStarLite*> m_pursuitPlanners;  // planner state kept alive per pursuer
+        std::vector<DStarLite*> m_vFreePlanners;            // cleared planners kept for reuse
+        double m_dPursuitTime;                              // planner and flow field time since the last computation (seconds)
+        int m_iPursuitExpansions;                           // planner and flow field expansions since the last computation
 
-            bool bClosed;
+        ////////////////
+        // path cache //
+        ////////////////
+
+        /**
+        * Path cache key: request cells and every option affecting the
+        * resulting waypoints.
+        */
+        struct PathCacheKey
+        {
+            NodeKey nkPos;
+            NodeKey nkDestPos;
+            PathSearchOptions options;
+            bool bSmooth;
+
+            bool operator<(const PathCacheKey& rhs) const;
         };
 
-        bool m_bPathInProgress;
-        NodeList m_mNodeList;
+        /**
+        * Cached waypoint list
+        */
+        struct PathCacheEntry
+        {
+            PathCacheKey key;
+            PathWaypointArray waypointList;
+        };
+
+        typedef std::list<PathCacheEntry> PathCacheList;
+
+        PathCacheList m_pathCache;                                  // entries, most recently used first
+        std::map<PathCacheKey, PathCacheList::iterator> m_pathCacheIndex;
+        unsigned int m_uPathCacheVersion;                           // world version of cached paths
+
+        bool FindCachedPath(const PathCacheKey& key, PathWaypointArray* waypointList);
+        void AddCachedPath(const PathCacheKey& key, const PathWaypointArray& waypointList);
 
         ///////////////////////
         // path request list //
@@ -181,27 +346,39 @@ class WorldData : public GameObject, public Singleton<WorldData>
             objectID id;
             NodeKey nkPos;
             NodeKey nkDestPos;
-            PathWaypointList waypointList;
+            PathWaypointArray waypointList;
+            PathJob* pJob;              // search job and result
+            int iGroupIndex;            // start index in a batch job shared with other requests (-1 if own job)
+            PathSearch* pSearch;        // main thread search (null if not running)
+            double dRequestTime;        // time the request was made (seconds)
+            PathCacheKey cacheKey;      // request cells and options
+            unsigned int uWorldVersion; // world version when requested
         };
 
+        bool IsRequestComplete(const PathRequest& req) const { return !req.pJob || PathThreadPool::IsComplete(req.pJob); }
+        bool IsLastJobRequest(const PathRequest& req) const { return req.iGroupIndex == -1 || req.iGroupIndex + 1 == (int)req.pJob->groupStarts.size(); }
+
         std::list<PathRequest> m_requestList;
+        std::vector<PathQuery> m_vQueuedQueries;    // single requests, batched at the next computation
 
-        std::map<objectID, PathWaypointList> m_completeWaypointLists;
+        WaypointStore m_waypointStore;                          // completed waypoint lists
+        std::map<objectID, WaypointHandle> m_waypointHandles;   // waypoint list of each object
 
         ////////////////
         // A* methods //
         ////////////////
         void ComputePaths();
-        bool RunComputationLoop(const PathRequest& req);
-        void AddWaypoints(PathWaypointList* waypointList, NodeList::iterator position);
-        void SmoothWaypoints(PathWaypointList* waypointList);
-        bool CheckNodeRubberband(NodeList::iterator position, NodeList::iterator prev, NodeList::iterator next);
-        void UpdateRubberbandBounds(NodeList::iterator node, int& iMinRow, int& iMaxRow, int& iMinCol, int& iMaxCol);
-        void AddNeighborNodes(NodeList::iterator position, const NodeKey& nkDest);
-        void CreateNode(const NodeKey& nkPos, const NodeKey& nkDest, NodeList::iterator parent);
-        float ComputeDistanceCost(const NodeKey& nkPos, NodeList::iterator parent);
-        float ComputeHeuristicCost(const NodeKey& nkPos, const NodeKey& nkDest);
-        NodeList::iterator FindLowestCostNode();
+        void RunComputationLoop();
+        void StartSearches(double dStartTime);
+        void FinishSearch(PathRequest& req);
+        void CollectCompletedPaths();
+        void CompleteRequest(PathRequest& req);
+        void RefineWaypointList(WaypointHandle handle, PathWaypointList* waypointList);
+        PathSearchOptions GetSearchOptions() const;
+        void BuildLandmarks();
+        void UpdateLandmarks();
+        void ReleaseRetiredLandmarks();
+        void AddWaypoints(PathWaypointArray* waypointList, const PathNodeList& nodeList);
         void GetRowColumn( const D3DXVECTOR2& pos, NodeKey* key );
         D3DXVECTOR2 GetCoordinates( const NodeKey& key );
 };
@@ -11,17 +11,58 @@
 
 #include "DXUT.h"
 #include "WorldFile.h"
+#ifdef _WIN32
 #include "DXUT/SDKmisc.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #pragma warning(disable : 4996)
 
+// cell changes kept for incremental consumers
+static const unsigned int kMaxCellChanges = 1024;
+
+// packed cell codes
+static const unsigned int kEmptyCode = 0;
+static const unsigned int kOccupiedCode = 1;
+static const unsigned int kInvalidCode = 3;
+static const unsigned int kInvalidWord = 0xFFFFFFFF;    // tile row of invalid cells
+
+/**
+* Binary grid file header, followed by the packed tiles (row-major tiles, 16
+* little-endian words per tile, 2 bits per cell with column 0 in the low
+* bits).
+*/
+struct WorldFileHeader
+{
+    char magic[4];              // "WGRD"
+    unsigned int format;        // kBinaryFormat
+    int width;                  // cells
+    int height;                 // cells
+    int tileShift;              // log2 of the tile size
+    unsigned int dataOffset;    // bytes from the file start to the tiles
+    unsigned int dataSize;      // bytes of tiles
+    unsigned int reserved;
+};
+
+static const char kBinaryMagic[4] = { 'W', 'G', 'R', 'D' };
+static const unsigned int kBinaryFormat = 1;
+static const unsigned int kBinaryDataOffset = 64;       // tiles start on a cache line
+
 /**
 * WorldFile Constructor
 */
 WorldFile::WorldFile() : 
     m_cx(0),
     m_cy(0),
-    m_pGrid(0)
+    m_tilesX(0),
+    m_pCells(0),
+    m_pMapView(0),
+    m_mapSize(0),
+    m_version(0)
 {}
 
 /**
@@ -29,7 +70,7 @@ WorldFile::WorldFile() :
 */
 WorldFile::~WorldFile()
 {
-    delete [] m_pGrid;
+    Unload();
 }
 
 /**
@@ -37,58 +78,314 @@ WorldFile::~WorldFile()
 */
 bool WorldFile::Load(const LPCWSTR szFilename)
 {
-    SAFE_DELETE_ARRAY(m_pGrid);
+    Unload();
+    ++m_version;
+    m_changes.clear();
 
+#ifdef _WIN32
     // search for file
     WCHAR wsNewPath[ MAX_PATH ];
     HRESULT result = DXUTFindDXSDKMediaFileCch(wsNewPath, sizeof(wsNewPath), szFilename);
 
-	FILE* fp = _wfopen(wsNewPath, L"rt");
+	FILE* fp = _wfopen(wsNewPath, L"rb");
+#else
+    // path as given (headless tools)
+    const WCHAR* wsNewPath = szFilename;
+    char szPath[ MAX_PATH ];
+    wcstombs(szPath, szFilename, sizeof(szPath));
+
+    FILE* fp = fopen(szPath, "rb");
+#endif
     if (fp)
     {
-        char sz[32768];
-        fgets (sz, sizeof(sz), fp);
-        sscanf(sz, "%d,%d", &m_cx, &m_cy);
-        m_pGrid = new ECell[m_cy * m_cx];
+        // binary grid files are mapped, not read
+        char magic[4];
+        bool bBinary = (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) && memcmp(magic, kBinaryMagic, sizeof(magic)) == 0);
 
-        for (int y = m_cy - 1; y >= 0; --y)
+        if (bBinary)
         {
-            fgets (sz, sizeof(sz), fp);
-            char *pc = sz;
-            for (int x = 0; x < m_cx; x++)
-            {
-                if (*pc == '#')
-                {
-                    m_pGrid[y * m_cx + x] = OCCUPIED_CELL;
-                }
-                else if (*pc == '.')
-                {
-                    m_pGrid[y * m_cx + x] = EMPTY_CELL;
-                }
-                else
-                {
-                    m_pGrid[y * m_cx + x] = INVALID_CELL;
-                }
-                ++pc;
-            }
+            fclose (fp);
+            return MapBinary(wsNewPath);
         }
+
+        rewind (fp);
+        bool bLoaded = LoadText(fp);
         fclose (fp);
-        return true;
+        return bLoaded;
     }
     return false;
 }
 
 /**
-* Get cell type at position
+* Parse a text grid: "width,height" followed by one line per row (top row
+* first), '#' for occupied and '.' for empty cells.
+*/
+bool WorldFile::LoadText(FILE* fp)
+{
+    char sz[256];
+    if (!fgets (sz, sizeof(sz), fp) || sscanf(sz, "%d,%d", &m_cx, &m_cy) != 2 || m_cx <= 0 || m_cy <= 0)
+    {
+        m_cx = m_cy = 0;
+        return false;
+    }
+
+    m_tilesX = (m_cx + kTileMask) >> kTileShift;
+    int tilesY = (m_cy + kTileMask) >> kTileShift;
+    m_cells.assign((size_t)m_tilesX * tilesY * kTileSize, kInvalidWord);
+    m_pCells = &m_cells[0];
+
+    // rows may be any length (missing cells are invalid)
+    for (int y = m_cy - 1; y >= 0; --y)
+    {
+        int x = 0;
+        int c = getc(fp);
+        for (; c != EOF && c != '\n'; c = getc(fp), ++x)
+        {
+            if (x >= m_cx)
+            {
+                continue;
+            }
+
+            unsigned int code = kInvalidCode;
+            if (c == '#')
+            {
+                code = kOccupiedCode;
+            }
+            else if (c == '.')
+            {
+                code = kEmptyCode;
+            }
+
+            unsigned int& word = m_pCells[GetWordIndex(y, x)];
+            word = (word & ~(3u << GetShift(x))) | (code << GetShift(x));
+        }
+    }
+    return true;
+}
+
+/**
+* Map a binary grid file copy-on-write (cell changes stay in memory)
 */
-WorldFile::ECell WorldFile::operator () ( int row, int col ) const
+bool WorldFile::MapBinary(const LPCWSTR szPath)
 {
-    if (m_pGrid)
+    void* pView = NULL;
+    size_t size = 0;
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileW(szPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE hMapping = NULL;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= kBinaryDataOffset)
+    {
+        size = (size_t)fileSize.QuadPart;
+        hMapping = CreateFileMappingW(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    }
+    CloseHandle(hFile);
+
+    if (!hMapping)
+    {
+        return false;
+    }
+
+    // the view keeps the mapping alive
+    pView = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(hMapping);
+
+    if (!pView)
+    {
+        return false;
+    }
+#else
+    char szFile[ MAX_PATH ];
+    wcstombs(szFile, szPath, sizeof(szFile));
+
+    int fd = open(szFile, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)kBinaryDataOffset)
+    {
+        size = (size_t)st.st_size;
+        pView = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (pView == MAP_FAILED)
+        {
+            pView = NULL;
+        }
+    }
+    close(fd);
+
+    if (!pView)
+    {
+        return false;
+    }
+#endif
+
+    m_pMapView = pView;
+    m_mapSize = size;
+
+    // validate header
+    const WorldFileHeader* header = (const WorldFileHeader*)pView;
+    if (memcmp(header->magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 || header->format != kBinaryFormat || header->tileShift != kTileShift ||
+        header->width <= 0 || header->height <= 0 || (header->dataOffset & 3) != 0)
+    {
+        Unload();
+        return false;
+    }
+
+    size_t tilesX = ((size_t)header->width + kTileMask) >> kTileShift;
+    size_t tilesY = ((size_t)header->height + kTileMask) >> kTileShift;
+    size_t dataSize = tilesX * tilesY * kTileSize * sizeof(unsigned int);
+    if (header->dataSize != dataSize || header->dataOffset < sizeof(WorldFileHeader) || header->dataOffset > size || size - header->dataOffset < dataSize)
+    {
+        Unload();
+        return false;
+    }
+
+    m_cx = header->width;
+    m_cy = header->height;
+    m_tilesX = (int)tilesX;
+    m_pCells = (unsigned int*)((char*)pView + header->dataOffset);
+    return true;
+}
+
+/**
+* Release the grid data
+*/
+void WorldFile::Unload()
+{
+    if (m_pMapView)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_pMapView);
+#else
+        munmap(m_pMapView, m_mapSize);
+#endif
+    }
+
+    std::vector<unsigned int>().swap(m_cells);
+    m_pCells = 0;
+    m_pMapView = 0;
+    m_mapSize = 0;
+    m_cx = m_cy = 0;
+    m_tilesX = 0;
+}
+
+/**
+* Save the grid as a binary grid file
+*/
+bool WorldFile::SaveBinary(const LPCWSTR szFilename) const
+{
+    if (!m_pCells)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+	FILE* fp = _wfopen(szFilename, L"wb");
+#else
+    char szPath[ MAX_PATH ];
+    wcstombs(szPath, szFilename, sizeof(szPath));
+
+    FILE* fp = fopen(szPath, "wb");
+#endif
+    if (!fp)
+    {
+        return false;
+    }
+
+    int tilesY = (m_cy + kTileMask) >> kTileShift;
+    size_t words = (size_t)m_tilesX * tilesY * kTileSize;
+
+    WorldFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.format = kBinaryFormat;
+    header.width = m_cx;
+    header.height = m_cy;
+    header.tileShift = kTileShift;
+    header.dataOffset = kBinaryDataOffset;
+    header.dataSize = (unsigned int)(words * sizeof(unsigned int));
+
+    char padding[kBinaryDataOffset - sizeof(WorldFileHeader)];
+    memset(padding, 0, sizeof(padding));
+
+    bool bWritten = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                    fwrite(padding, sizeof(padding), 1, fp) == 1 &&
+                    fwrite(m_pCells, sizeof(unsigned int), words, fp) == words;
+
+    bWritten = (fclose (fp) == 0) && bWritten;
+    return bWritten;
+}
+
+/**
+* Set cell type at position. Main thread only. Worker threads reading the
+* grid at the same time see the old or the new cell: the packed word is
+* written with a single aligned 32-bit store, which is atomic on the target
+* processors, and the other cells of the word keep their values since no
+* other thread writes the grid. Readers that may have seen the change are
+* redone from the change log: path results found on an older version are
+* not cached, chunks being loaded are marked stale and rebuilt, and the next
+* influence map job updates the changed cells.
+*/
+void WorldFile::SetCell( int row, int col, ECell cell )
+{
+    if (m_pCells)
     {
         if (0 <= row && row < m_cy && 0 <= col && col < m_cx)
         {
-            return m_pGrid[row * m_cx + col];
+            unsigned int code = (cell == OCCUPIED_CELL) ? kOccupiedCode : (cell == EMPTY_CELL) ? kEmptyCode : kInvalidCode;
+            volatile unsigned int& word = m_pCells[GetWordIndex(row, col)];
+            word = (word & ~(3u << GetShift(col))) | (code << GetShift(col));
+            ++m_version;
+
+            // log change
+            CellChange change;
+            change.version = m_version;
+            change.row = row;
+            change.col = col;
+            m_changes.push_back(change);
+
+            if (m_changes.size() > kMaxCellChanges)
+            {
+                m_changes.pop_front();
+            }
+        }
+    }
+}
+
+/**
+* Get the cells changed since the specified version. Returns false if the
+* changes are no longer known (world reloaded or log overflowed).
+*/
+bool WorldFile::GetCellChanges( unsigned int sinceVersion, std::vector<CellChange>* changes ) const
+{
+    changes->clear();
+
+    if (sinceVersion == m_version)
+    {
+        return true;
+    }
+
+    // oldest change must directly follow the version
+    if (m_changes.empty() || m_changes.front().version > sinceVersion + 1)
+    {
+        return false;
+    }
+
+    for (std::deque<CellChange>::const_iterator change = m_changes.begin(); change != m_changes.end(); ++change)
+    {
+        if (change->version > sinceVersion)
+        {
+            changes->push_back(*change);
         }
     }
-    return INVALID_CELL;
+    return true;
 }
@@ -10,9 +10,24 @@
 *******************************************************************************/
 
 #pragma once
+#include <stdio.h>
+#include <deque>
+#include <vector>
 
 /**
 * WorldFile Class
+*
+* Cells are packed 2 bits each in 16x16 tiles (one 32-bit word per tile row),
+* so a tile fills one 64 byte cache line. Text (.grd) files are parsed into
+* this layout; binary grid files store it directly and are memory mapped
+* copy-on-write, so they open without parsing and cells may still be set.
+*
+* Threading: cells are set on the main thread only, while the path workers,
+* the chunk loader and the influence map worker may be reading the grid.
+* SetCell changes a cell with one aligned 32-bit store, so a reader sees the
+* old or the new cell, never a mix. A reader may see a change part way
+* through its work; results built on an older world version are not cached
+* (paths) or are rebuilt (chunks, influence map), see SetCell.
 */
 class WorldFile
 {
@@ -27,25 +42,78 @@ class WorldFile
             CELL_MAX
         };
 
+        // cell change
+        struct CellChange
+        {
+            unsigned int version;   // world version after the change
+            int row;
+            int col;
+        };
+
         WorldFile();
         ~WorldFile();
 
-        // load file
+        // load file (text or binary grid, detected from the contents)
         bool Load(const LPCWSTR szFilename);
 
+        // save binary grid file
+        bool SaveBinary(const LPCWSTR szFilename) const;
+
         // get cell type
-        ECell operator () ( int row, int col ) const;
+        inline ECell operator () ( int row, int col ) const;
+
+        // set cell type (main thread only; other threads may be reading)
+        void SetCell( int row, int col, ECell cell );
+
+        // world version (changes with every load or cell change)
+        unsigned int GetVersion() const { return m_version; }
+        bool GetCellChanges( unsigned int sinceVersion, std::vector<CellChange>* changes ) const;
 
         // get grid size
 	    int GetWidth() const { return m_cx; }
 	    int GetHeight() const { return m_cy; }
 
+        // packed layout
+        static const int kTileShift = 4;                    // 16x16 cell tiles
+        static const int kTileSize = 1 << kTileShift;
+        static const int kTileMask = kTileSize - 1;
+
     private:
 
         int m_cx, m_cy;
-        ECell* m_pGrid;
+        int m_tilesX;                       // tiles per row of tiles
+        unsigned int* m_pCells;             // packed tiles (owned buffer or mapped file)
+        std::vector<unsigned int> m_cells;  // packed tiles of text files
+        void* m_pMapView;                   // mapped binary file (null if not mapped)
+        size_t m_mapSize;                   // mapped bytes
+        unsigned int m_version;
+        std::deque<CellChange> m_changes;   // recent cell changes (oldest first)
+
+        // loading
+        void Unload();
+        bool LoadText(FILE* fp);
+        bool MapBinary(const LPCWSTR szPath);
+
+        // packed cell word and bit shift
+        int GetWordIndex( int row, int col ) const { return (((row >> kTileShift) * m_tilesX + (col >> kTileShift)) << kTileShift) + (row & kTileMask); }
+        static int GetShift( int col ) { return (col & kTileMask) << 1; }
 
         // prevent copy and assignment
         WorldFile(const WorldFile&);
         WorldFile& operator=(const WorldFile&);
 };
+
+/**
+* Get cell type at position (invalid outside the grid)
+*/
+inline WorldFile::ECell WorldFile::operator () ( int row, int col ) const
+{
+    // cell codes: empty, occupied, unused, invalid
+    static const ECell kCells[4] = { EMPTY_CELL, OCCUPIED_CELL, INVALID_CELL, INVALID_CELL };
+
+    if ((unsigned int)row >= (unsigned int)m_cy || (unsigned int)col >= (unsigned int)m_cx)
+    {
+        return INVALID_CELL;
+    }
+    return kCells[(m_pCells[GetWordIndex(row, col)] >> GetShift(col)) & 3];
+}
@@ -42,18 +42,12 @@ WorldNode::WorldNode(
     m_sFloorFilename(sFloorFilename),
     m_sWallFilename(sWallFilename),
     m_pFloorTexture(NULL),
-    m_iFloorTriangleCount(0),
-    m_iFloorCVCount(0),
-    m_iFloorCVBufferSize(0),
-    m_FloorCVBuffer(NULL),
     m_pWallTexture(NULL),
-    m_iWallTriangleCount(0),
-    m_iWallCVCount(0),
-    m_iWallCVBufferSize(0),
-    m_WallCVBuffer(NULL),
     iWorldHeight(0),
     iWorldWidth(0)
 {
+    // chunk vertices and quads are built as chunks are streamed in
+    m_iChunkClient = g_chunks.AddClient(this);
 }
 
 /**
@@ -67,19 +61,30 @@ WorldNode::~WorldNode()
     // cleanup textures
     SAFE_RELEASE(m_pFloorTexture);
     SAFE_RELEASE(m_pWallTexture);
-
-    // cleanup custom vertex buffers
-    SAFE_DELETE_ARRAY(m_FloorCVBuffer);
-    SAFE_DELETE_ARRAY(m_WallCVBuffer);
 }
 
 /*
-* Returns a collision quad list object with world walls. The object will
-* not contain any walls if the world node has not been initialized.
+* Returns the collision quad lists of the resident chunks overlapping an x-z
+* rectangle. Chunks not yet streamed in have no walls.
 */
-VecCollQuad WorldNode::GetCollQuadList()
+void WorldNode::GetQuadLists(float fMinX, float fMinZ, float fMaxX, float fMaxZ, std::vector<const VecCollQuad*>* quadLists) const
 {
-    return m_vCollQuads;
+    // chunk range (quads of a cell lie within the cell bounds)
+    int iChunkMinX = max(0, (int)floorf(fMinX / kWorldScale)) / kWorldChunkSize;
+    int iChunkMinY = max(0, (int)floorf(fMinZ / kWorldScale)) / kWorldChunkSize;
+    int iChunkMaxX = min(m_worldFile.GetWidth() - 1, (int)floorf(fMaxX / kWorldScale)) / kWorldChunkSize;
+    int iChunkMaxY = min(m_worldFile.GetHeight() - 1, (int)floorf(fMaxZ / kWorldScale)) / kWorldChunkSize;
+
+    for(int y = iChunkMinY; y <= iChunkMaxY; ++y)
+    {
+        for(int x = iChunkMinX; x <= iChunkMaxX; ++x)
+        {
+            int iChunk = g_chunks.GetChunkIndex(y * kWorldChunkSize, x * kWorldChunkSize);
+            WorldNodeChunk* chunk = static_cast<WorldNodeChunk*>( g_chunks.GetChunkData(m_iChunkClient, iChunk) );
+            if(chunk)
+                quadLists->push_back(&chunk->vCollQuads);
+        }
+    }
 }
 
 /**
@@ -113,10 +118,24 @@ HRESULT WorldNode::Initialize(IDirect3DDevice9* pd3dDevice)
     iWorldHeight = m_worldFile.GetHeight();
     iWorldWidth = m_worldFile.GetWidth();
 
+    // create vertex declaration
+    HRESULT result = pd3dDevice->CreateVertexDeclaration(m_sCustomVertexDeclaration, &m_pCVDeclaration);
+
+    return result;
+}
+
+/**
+* Build the vertices and collision quads of a world chunk. Runs on the chunk
+* loader thread; only reads the world grid.
+*/
+WorldChunkData* WorldNode::LoadChunk(const WorldChunkBounds& bounds)
+{
+    WorldNodeChunk* chunk = new WorldNodeChunk;
+
     // draw tiles for each row and column entry
-    for(int col = 0; col < m_worldFile.GetWidth(); col++)
+    for(int row = bounds.iRowMin; row <= bounds.iRowMax; row++)
     {
-        for(int row = 0; row < m_worldFile.GetHeight(); row++)
+        for(int col = bounds.iColMin; col <= bounds.iColMax; col++)
         {
             // compute cube base coordinates
             float x = col * kWorldScale;
@@ -129,42 +148,39 @@ HRESULT WorldNode::Initialize(IDirect3DDevice9* pd3dDevice)
                 case WorldFile::OCCUPIED_CELL:
                 {
                     // draw cube top
-                    DrawTile(x, y, z, kWorldScale, kTop, kWall);
+                    DrawTile(x, y, z, kWorldScale, kTop, kWall, chunk);
 
                     // check for occupied cells next to cell, draw cube sides if not occupied
 
                     // left
                     if(m_worldFile(row,col-1) == WorldFile::EMPTY_CELL || m_worldFile(row,col-1) == WorldFile::INVALID_CELL)
-                        DrawTile(x, y, z, kWorldScale, kLeft, kWall);
+                        DrawTile(x, y, z, kWorldScale, kLeft, kWall, chunk);
 
                     // right
                     if(m_worldFile(row,col+1) == WorldFile::EMPTY_CELL || m_worldFile(row,col+1) == WorldFile::INVALID_CELL)
-                        DrawTile(x, y, z, kWorldScale, kRight, kWall);
+                        DrawTile(x, y, z, kWorldScale, kRight, kWall, chunk);
 
                     // upper
                     if(m_worldFile(row+1,col) == WorldFile::EMPTY_CELL || m_worldFile(row+1,col) == WorldFile::INVALID_CELL)
-                        DrawTile(x, y, z, kWorldScale, kUpper, kWall);
+                        DrawTile(x, y, z, kWorldScale, kUpper, kWall, chunk);
 
                     // lower
                     if(m_worldFile(row-1,col) == WorldFile::EMPTY_CELL || m_worldFile(row-1,col) == WorldFile::INVALID_CELL)
-                        DrawTile(x, y, z, kWorldScale, kLower, kWall);
+                        DrawTile(x, y, z, kWorldScale, kLower, kWall, chunk);
 
                     break;
                 }
                 default:
                 {
                     // draw floor
-                    DrawTile(x, y, z, kWorldScale, kBottom, kFloor);
+                    DrawTile(x, y, z, kWorldScale, kBottom, kFloor, chunk);
                     break;
                 }
             }
         }
     }
-    
-    // create vertex declaration
-    HRESULT result = pd3dDevice->CreateVertexDeclaration(m_sCustomVertexDeclaration, &m_pCVDeclaration);
 
-    return result;
+    return chunk;
 }
 
 /**
@@ -195,19 +211,26 @@ void WorldNode::Render(IDirect3DDevice9* pd3dDevice, const RenderData* rData)
 
     // set vertex declaration
     pd3dDevice->SetVertexDeclaration(m_pCVDeclaration);
+
+    // resident chunks
+    const std::vector<int>& chunks = g_chunks.GetResidentChunks();
     
     // set floor texture and draw primitives
-    if(m_iFloorTriangleCount)
+    pd3dDevice->SetTexture(0, m_pFloorTexture);
+    for(std::vector<int>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
     {
-        pd3dDevice->SetTexture(0, m_pFloorTexture);
-        pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, m_iFloorTriangleCount, m_FloorCVBuffer, sizeof(m_FloorCVBuffer[0]) );
+        WorldNodeChunk* chunk = static_cast<WorldNodeChunk*>( g_chunks.GetChunkData(m_iChunkClient, *it) );
+        if( !chunk->vFloorVertices.empty() )
+            pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, (UINT)chunk->vFloorVertices.size() / 3, &chunk->vFloorVertices[0], sizeof(CustomVertex) );
     }
 
     // set wall texture and draw primitives
-    if(m_iWallTriangleCount)
+    pd3dDevice->SetTexture(0, m_pWallTexture);
+    for(std::vector<int>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
     {
-        pd3dDevice->SetTexture(0, m_pWallTexture);
-        pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, m_iWallTriangleCount, m_WallCVBuffer, sizeof(m_WallCVBuffer[0]) );
+        WorldNodeChunk* chunk = static_cast<WorldNodeChunk*>( g_chunks.GetChunkData(m_iChunkClient, *it) );
+        if( !chunk->vWallVertices.empty() )
+            pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, (UINT)chunk->vWallVertices.size() / 3, &chunk->vWallVertices[0], sizeof(CustomVertex) );
     }
 
 
@@ -235,12 +258,13 @@ void WorldNode::Render(IDirect3DDevice9* pd3dDevice, const RenderData* rData)
         // disable z buffer
         pd3dDevice->SetRenderState(D3DRS_ZWRITEENABLE, FALSE);
 
-        // set wall texture and draw primitives
-        if(m_iWallTriangleCount)
+        // shadow texture and wall primitives
+        pd3dDevice->SetTexture(0, rData->pShadowTexture);
+        for(std::vector<int>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
         {
-            // shadow texture
-            pd3dDevice->SetTexture(0, rData->pShadowTexture);
-            pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, m_iWallTriangleCount, m_WallCVBuffer, sizeof(m_WallCVBuffer[0]) );
+            WorldNodeChunk* chunk = static_cast<WorldNodeChunk*>( g_chunks.GetChunkData(m_iChunkClient, *it) );
+            if( !chunk->vWallVertices.empty() )
+                pd3dDevice->DrawPrimitiveUP( D3DPT_TRIANGLELIST, (UINT)chunk->vWallVertices.size() / 3, &chunk->vWallVertices[0], sizeof(CustomVertex) );
         }
     }
 }
@@ -259,8 +283,9 @@ void WorldNode::Render(IDirect3DDevice9* pd3dDevice, const RenderData* rData)
 * @param size cube scaling size
 * @param side cube side to draw
 * @param type tile type to draw
+* @param chunk chunk receiving the vertices and collision quad
 */
-void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, TileType type)
+void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, TileType type, WorldNodeChunk* chunk) const
 {
     D3DXVECTOR3 n; // normal
 
@@ -278,13 +303,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 1.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     case kBottom:
@@ -298,13 +323,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 1.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     case kLeft:        
@@ -318,13 +343,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(1.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 1.0f) ), 
             CustomVertex( p3, n, D3DXVECTOR2(0.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(1.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     case kRight:
@@ -338,13 +363,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 1.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     case kUpper:
@@ -358,13 +383,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(1.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(0.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(1.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     case kLower:
@@ -378,13 +403,13 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p2, n, D3DXVECTOR2(0.0f, 0.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
-            type);
+            type, chunk);
         AddPlane(
             CustomVertex( p1, n, D3DXVECTOR2(0.0f, 1.0f) ),
             CustomVertex( p3, n, D3DXVECTOR2(1.0f, 0.0f) ),
             CustomVertex( p4, n, D3DXVECTOR2(1.0f, 1.0f) ),
-            type);
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
+            type, chunk);
+        chunk->vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) ); 
         break;
     }
     default:
@@ -400,26 +425,23 @@ void WorldNode::DrawTile(float x, float y, float z, float s, CubeSide side, Tile
 * @param v2 vertex
 * @param v3 vertex
 * @param type tile type
+* @param chunk chunk receiving the vertices
 */
-void WorldNode::AddPlane(const CustomVertex& v1, const CustomVertex& v2, const CustomVertex& v3, const TileType& type)
+void WorldNode::AddPlane(const CustomVertex& v1, const CustomVertex& v2, const CustomVertex& v3, const TileType& type, WorldNodeChunk* chunk) const
 {
     switch(type)
     {
 
     case kFloor:
-        CheckBufferSize(m_iFloorCVCount, &m_iFloorCVBufferSize, &m_FloorCVBuffer);
-        m_FloorCVBuffer[m_iFloorCVCount++] = v1;
-        m_FloorCVBuffer[m_iFloorCVCount++] = v2;
-        m_FloorCVBuffer[m_iFloorCVCount++] = v3;
-        m_iFloorTriangleCount++;
+        chunk->vFloorVertices.push_back(v1);
+        chunk->vFloorVertices.push_back(v2);
+        chunk->vFloorVertices.push_back(v3);
         break;
 
     case kWall:
-        CheckBufferSize(m_iWallCVCount, &m_iWallCVBufferSize, &m_WallCVBuffer);
-        m_WallCVBuffer[m_iWallCVCount++] = v1;
-        m_WallCVBuffer[m_iWallCVCount++] = v2;
-        m_WallCVBuffer[m_iWallCVCount++] = v3;
-        m_iWallTriangleCount++;
+        chunk->vWallVertices.push_back(v1);
+        chunk->vWallVertices.push_back(v2);
+        chunk->vWallVertices.push_back(v3);
         break;
 
     default:
@@ -427,92 +449,3 @@ void WorldNode::AddPlane(const CustomVertex& v1, const CustomVertex& v2, const C
 
     }
 }
-
-/**
-* Verifies the custom vertex buffer has enough space to add three vertices. If not,
-* the buffer is grown.
-*/
-void WorldNode::CheckBufferSize(int iCVCount, int* iCVBufferSize, CustomVertex** buffer)
-{
-    if( (iCVCount+3) > (*iCVBufferSize) )
-    {
-        // allocate new buffer
-        int tmpBufferSize = (*iCVBufferSize) + 100;
-        CustomVertex* tmpBuffer = new CustomVertex[tmpBufferSize];
-
-        // copy buffer data
-        memcpy(tmpBuffer, *buffer, (*iCVBufferSize)*sizeof(CustomVertex));
-
-        // delete old buffer
-        SAFE_DELETE(*buffer);
-
-        // set new buffer and size
-        *buffer = tmpBuffer;
-        *iCVBufferSize = tmpBufferSize;
-    }
-}
-
-/**
-* Adds collision quads for the world boundary walls. Prevents player from leaving
-* the world node area.
-*/
-void WorldNode::SetupWorldCollWalls(const WorldFile& grid)
-{
-    // add boundary walls to quad list
-
-    // world left side
-    for(int row = 0; row < grid.GetHeight(); row++)
-    {
-        D3DXVECTOR3 p1( 0.0f, 0.0f,                 (float)row );
-        D3DXVECTOR3 p2( 0.0f, kWorldScale,  (float)row );
-        D3DXVECTOR3 p3( 0.0f, kWorldScale,  (float)row+kWorldScale );
-        D3DXVECTOR3 p4( 0.0f, 0.0f,                 (float)row+kWorldScale );
-        
-        D3DXVECTOR3 n;
-        D3DXVec3Cross(&n, &(p2-p1), &(p3-p1));
-
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) );
-    }
-
-    // world right side
-    for(int row = 0; row < grid.GetHeight(); row++)
-    {
-        D3DXVECTOR3 p1( (float)grid.GetWidth(), 0.0f,                   (float)row );
-        D3DXVECTOR3 p2( (float)grid.GetWidth(), 0.0f,                   (float)row+kWorldScale );
-        D3DXVECTOR3 p3( (float)grid.GetWidth(), kWorldScale,    (float)row+kWorldScale );
-        D3DXVECTOR3 p4( (float)grid.GetWidth(), kWorldScale,    (float)row );
-        
-        D3DXVECTOR3 n;
-        D3DXVec3Cross(&n, &(p2-p1), &(p3-p1));
-
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) );
-    }
-
-    // world lower side
-    for(int col = 0; col < grid.GetWidth(); col++)
-    {
-        D3DXVECTOR3 p1( (float)col,                     0.0f, 0.0f );
-        D3DXVECTOR3 p2( (float)col+kWorldScale, 0.0f, 0.0f );
-        D3DXVECTOR3 p3( (float)col+kWorldScale, kWorldScale, 0.0f );
-        D3DXVECTOR3 p4( (float)col,                     kWorldScale, 0.0f );
-        
-        D3DXVECTOR3 n;
-        D3DXVec3Cross(&n, &(p2-p1), &(p3-p1));
-
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) );
-    }
-
-    // world upper side
-    for(int col = 0; col < grid.GetWidth(); col++)
-    {
-        D3DXVECTOR3 p1( (float)col,                     0.0f,   (float)grid.GetHeight() );
-        D3DXVECTOR3 p2( (float)col,                     kWorldScale, (float)grid.GetHeight() );
-        D3DXVECTOR3 p3( (float)col+kWorldScale, kWorldScale, (float)grid.GetHeight() );
-        D3DXVECTOR3 p4( (float)col+kWorldScale, 0.0f,   (float)grid.GetHeight() );
-        
-        D3DXVECTOR3 n;
-        D3DXVec3Cross(&n, &(p2-p1), &(p3-p1));
-
-        m_vCollQuads.push_back( CollQuad(p1, p2, p3, p4, n) );
-    }
-}
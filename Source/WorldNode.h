@@ -12,13 +12,15 @@
 #pragma once
 #include "gameobject.h"
 #include "Collision.h"
+#include "WorldChunks.h"
 
 class WorldFile;
 
 /**
-* World Node
+* World Node. Render vertices and collision quads are built per world chunk
+* as chunks are streamed in around the agents.
 */
-class WorldNode : public GameObject
+class WorldNode : public GameObject, public WorldChunkClient, public CollQuadSource
 {
     public:
 
@@ -30,8 +32,11 @@ class WorldNode : public GameObject
 
 	    ~WorldNode();
 
-        // returns a game collision object
-        VecCollQuad GetCollQuadList();
+        // builds the vertices and collision quads of a chunk (loader thread)
+        WorldChunkData* LoadChunk(const WorldChunkBounds& bounds);
+
+        // returns the collision quad lists of the resident chunks in a rectangle
+        void GetQuadLists(float fMinX, float fMinZ, float fMaxX, float fMaxZ, std::vector<const VecCollQuad*>* quadLists) const;
 
         // return world size
         int GetWorldHeight() const { return iWorldHeight; }
@@ -113,43 +118,39 @@ class WorldNode : public GameObject
             kWall
         };
 
+        /**
+        * Vertices and collision quads of one world chunk
+        */
+        class WorldNodeChunk : public WorldChunkData
+        {
+            public:
+                std::vector<CustomVertex> vFloorVertices;   // floor triangle list
+                std::vector<CustomVertex> vWallVertices;    // wall triangle list
+                VecCollQuad vCollQuads;                     // list of quads
+        };
+
         // METHODS
 
         // draw cube tile
-        void DrawTile(float x, float y, float z, float size, CubeSide side, TileType type);
+        void DrawTile(float x, float y, float z, float size, CubeSide side, TileType type, WorldNodeChunk* chunk) const;
 
         // add plane to the appropriate buffer
-        void AddPlane(const CustomVertex& v1, const CustomVertex& v2, const CustomVertex& v3, const TileType& type);
-        
-        // setup world boundary collision walls
-        void SetupWorldCollWalls(const WorldFile& grid);
-
-        // checks if a buffer is large enough
-        void WorldNode::CheckBufferSize(int iCVCount, int* iCVBufferSize, CustomVertex** buffer);
+        void AddPlane(const CustomVertex& v1, const CustomVertex& v2, const CustomVertex& v3, const TileType& type, WorldNodeChunk* chunk) const;
 
         // DATA
         const WorldFile& m_worldFile;           // world file
         std::wstring m_sFloorFilename;          // floor texture filename
         std::wstring m_sWallFilename;           // wall texture filename
+        int m_iChunkClient;                     // world chunk client index
 
         int iWorldHeight;                       // world height (grid size)
         int iWorldWidth;                        // world width (grid size)
 
         // FLOOR
         LPDIRECT3DTEXTURE9 m_pFloorTexture;
-        int m_iFloorTriangleCount;             // number of triangles
-        int m_iFloorCVCount;                   // number of vertices in the buffer
-        int m_iFloorCVBufferSize;              // size of custom vertex buffer (in CVs)
-        CustomVertex* m_FloorCVBuffer;         // custom vertex buffer
 
         // WALLS
         LPDIRECT3DTEXTURE9 m_pWallTexture;
-        int m_iWallTriangleCount;           // number of triangles
-        int m_iWallCVCount;                 // number of vertices in the buffer
-        int m_iWallCVBufferSize;            // size of custom vertex buffer  (in CVs)
-        CustomVertex* m_WallCVBuffer;       // custom vertex buffer
-
-        VecCollQuad m_vCollQuads;           // list of quads (walls only)
 
         // prevent copy and assignment
         WorldNode(const WorldNode&);
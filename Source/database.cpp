@@ -12,6 +12,8 @@
 #include "database.h"
 #include "gameobject.h"
 #include "statemch.h"
+#include "WorldData.h"
+#include <algorithm>
 
 
 Database::Database( void ) : 
@@ -28,6 +30,12 @@ Database::~Database( void )
 		delete( *i );
 		i = m_database.erase( i );
 	}
+
+	for( int type=0; type<DATABASE_TYPE_BITS; ++type )
+	{
+		m_typeLists[type].clear();
+	}
+	m_allObjects.clear();
 }
 
 /*---------------------------------------------------------------------------*
@@ -84,6 +92,8 @@ void Database::UpdateObjects()
 		if( (*i)->IsMarkedForDeletion() )
 		{	
             //Destroy object
+			RemoveFromTypeLists( *i );
+			ReleaseWorldData( *i );
 			delete( *i );
 			i = m_database.erase( i );
 		}
@@ -204,6 +214,7 @@ void Database::Store( GameObject* object )
 
 	if( Find( object->GetID() ) == 0 ) {
 		m_database.push_back( object );
+		AddToTypeLists( object );
 	}
 	else {
 		ASSERTMSG( 0, "Database::Store - Object ID already represented in database." );
@@ -224,6 +235,8 @@ void Database::Remove( objectID id )
 	for( dbContainer::iterator i=m_database.begin(); i!=m_database.end(); ++i )
 	{
 		if( (*i)->GetID() == id ) {
+			RemoveFromTypeLists( *i );
+			ReleaseWorldData( *i );
 			m_database.erase(i);	
 			return;
 		}
@@ -322,13 +335,114 @@ objectID Database::GetNewObjectID( void )
  *---------------------------------------------------------------------------*/
 void Database::ComposeList( dbCompositionList & list, unsigned int type )
 {
-	//Find all objects of "type"
-	for( dbContainer::iterator i=m_database.begin(); i!=m_database.end(); ++i )
+	//Gather the lists of each type bit (objects grouped by their lowest bit in "type")
+	unsigned int remaining = type;
+	do
+	{	//Lowest remaining type bit (all objects for OBJECT_Ignore_Type)
+		unsigned int typeBit = remaining & (~remaining + 1);
+		remaining &= ~typeBit;
+
+		const dbCompositionList & typeList = GetTypeList( typeBit );
+		for( dbCompositionList::const_iterator i=typeList.begin(); i!=typeList.end(); ++i )
+		{
+			if( ((*i)->GetType() & type & (typeBit - 1)) == 0 )
+			{	//Not already added for a lower bit
+				list.push_back(*i);
+			}
+		}
+	} while( remaining != 0 );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         GetTypeList
+
+  Description:  Get the objects of a type bit, in the order stored. The list
+                is kept up to date by Store and Remove, so it can be walked
+				without composing a list (walk it by index up to its initial
+				size if objects may be stored meanwhile).
+
+  Arguments:    type   : a single type bit, or OBJECT_Ignore_Type for all objects
+
+  Returns:      The list of objects.
+ *---------------------------------------------------------------------------*/
+const dbCompositionList & Database::GetTypeList( unsigned int type )
+{
+	if( type == OBJECT_Ignore_Type )
+	{
+		return( m_allObjects );
+	}
+
+	ASSERTMSG( (type & (type - 1)) == 0, "Database::GetTypeList - More than one type bit" );
+
+	int bit = 0;
+	while( (type & (1u << bit)) == 0 )
 	{
-		if( type == OBJECT_Ignore_Type || (*i)->GetType() & type )
-		{	//Type matches
-			list.push_back(*i);
+		++bit;
+	}
+
+	return( m_typeLists[bit] );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         AddToTypeLists
+
+  Description:  Adds an object to the list of each of its type bits.
+
+  Arguments:    object : the game object
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void Database::AddToTypeLists( GameObject* object )
+{
+	m_allObjects.push_back( object );
+
+	for( int bit=0; bit<DATABASE_TYPE_BITS; ++bit )
+	{
+		if( object->GetType() & (1u << bit) )
+		{
+			m_typeLists[bit].push_back( object );
 		}
 	}
 }
 
+/*---------------------------------------------------------------------------*
+  Name:         RemoveFromTypeLists
+
+  Description:  Removes an object from the list of each of its type bits,
+                keeping the order of the others.
+
+  Arguments:    object : the game object
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void Database::RemoveFromTypeLists( GameObject* object )
+{
+	m_allObjects.erase( std::find( m_allObjects.begin(), m_allObjects.end(), object ) );
+
+	for( int bit=0; bit<DATABASE_TYPE_BITS; ++bit )
+	{
+		if( object->GetType() & (1u << bit) )
+		{
+			dbCompositionList & list = m_typeLists[bit];
+			list.erase( std::find( list.begin(), list.end(), object ) );
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         ReleaseWorldData
+
+  Description:  Releases the path data (waypoint list, requests, pursuit
+                planner) the world keeps for an object leaving the database.
+
+  Arguments:    object : the game object
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void Database::ReleaseWorldData( GameObject* object )
+{
+	if( WorldData::DoesSingletonExist() && object != WorldData::GetSingletonPtr() )
+	{
+		g_world.ReleaseObject( object->GetID() );
+	}
+}
@@ -24,6 +24,9 @@ class RenderData;
 // game object list
 typedef std::vector<GameObject*> dbCompositionList;
 
+// object type bits with a subscriber list
+#define DATABASE_TYPE_BITS 32
+
 
 class Database : public Singleton <Database>
 {
@@ -45,6 +48,7 @@ class Database : public Singleton <Database>
 	    GameObject* Find( objectID id );
 	    GameObject* FindByName( char* name );
 	    void ComposeList( dbCompositionList & list, unsigned int type = 0 );
+	    const dbCompositionList & GetTypeList( unsigned int type = 0 );
 
         // objects ids
 	    objectID GetIDByName( char* name );
@@ -63,4 +67,12 @@ class Database : public Singleton <Database>
 	    dbContainer m_database;
 
 	    objectID m_nextFreeID;
+
+	    // objects by type bit, and all objects (store order, kept by Store and Remove)
+	    dbCompositionList m_typeLists[DATABASE_TYPE_BITS];
+	    dbCompositionList m_allObjects;
+
+	    void AddToTypeLists( GameObject* object );
+	    void RemoveFromTypeLists( GameObject* object );
+	    void ReleaseWorldData( GameObject* object );
 };
@@ -24,6 +24,8 @@
 #define g_debugdrawing DebugDrawing::GetSingleton()
 #define g_objcollision ObjectCollision::GetSingleton()
 #define g_world WorldData::GetSingleton()
+#define g_chunks WorldChunks::GetSingleton()
+#define g_influence InfluenceMap::GetSingleton()
 
 
 #define INVALID_OBJECT_ID 0
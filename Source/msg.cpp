@@ -60,7 +60,8 @@ MSG_Object::MSG_Object( void )
   m_deliveryTime( 0.0f ),
   m_delivered( false ),
   m_timer( 0 ),
-  m_cc( false )
+  m_cc( false ),
+  m_cancelled( false )
 {
 
 }
@@ -82,6 +83,7 @@ MSG_Object::MSG_Object( float deliveryTime, MSG_Name name,
 	SetDelivered( false );
 	SetTimer( timer );
 	SetCC( cc );
+	SetCancelled( false );
 	m_data = data;
 }
 
@@ -176,6 +176,9 @@ public:
 	
 	inline bool IsCC( void )						{ return( m_cc ); }
 	inline void SetCC( bool value )					{ m_cc = value; }
+
+	inline bool IsCancelled( void )					{ return( m_cancelled ); }
+	inline void SetCancelled( bool value )			{ m_cancelled = value; }
 	
 
 private:
@@ -192,4 +195,5 @@ private:
 	unsigned int m_delivered: 1;	//Whether the message has been delivered
 	unsigned int m_timer: 1;		//Message is sent periodically
 	unsigned int m_cc: 1;			//Message is a carbon copy that was received by someone else
+	unsigned int m_cancelled: 1;	//Delayed message was removed before delivery (left in the heap as a tombstone)
 };
@@ -14,6 +14,21 @@
 #include "database.h"
 
 
+//Children per node of the delayed message heap
+#define DELAYED_HEAP_ARITY 4
+
+//Initial number of duplicate index buckets (power of 2)
+#define DUPLICATE_INDEX_MIN_BUCKETS 64
+
+//Cancelled messages left in the heap before it is compacted
+#define TOMBSTONE_MIN_COMPACT 64
+
+//Receivers in the receiver index before empty ones are pruned
+#define RECEIVER_INDEX_MIN_PRUNE 64
+
+//Default delayed messages per receiver per frame before other receivers go first
+#define DELIVERY_FAIRNESS_QUOTA 8
+
 
 /*---------------------------------------------------------------------------*
   Name:         MsgRoute
@@ -21,9 +36,19 @@
   Description:  Constructor
  *---------------------------------------------------------------------------*/
 MsgRoute::MsgRoute( void )
-: m_loadBalancingTimeLimit(0.05f/60.0f) //5% of a 60Hz frame
+: m_duplicateIndex(DUPLICATE_INDEX_MIN_BUCKETS),
+  m_duplicateCount(0),
+  m_nextSequence(0),
+  m_tombstoneCount(0),
+  m_poolInUse(0),
+  m_poolHighWater(0),
+  m_loadBalancingTimeLimit(0.05f/60.0f), //5% of a 60Hz frame
+  m_budgetCarry(0.0),
+  m_fairnessQuota(DELIVERY_FAIRNESS_QUOTA),
+  m_deliveryFrame(0),
+  m_lastDeliveryTime(0.0f)
 {
-
+	ResetDeliveryStats();
 }
 
 /*---------------------------------------------------------------------------*
@@ -33,13 +58,16 @@ MsgRoute::MsgRoute( void )
  *---------------------------------------------------------------------------*/
 MsgRoute::~MsgRoute( void )
 {
-	for( MessageContainer::iterator i=m_delayedMessages.begin(); i!=m_delayedMessages.end(); ++i )
+	//Delayed messages (including the tombstones) live in the pool slabs
+	for( std::vector<MSG_Object*>::iterator i=m_poolSlabs.begin(); i!=m_poolSlabs.end(); ++i )
 	{
-		MSG_Object * msg = *i;
-		delete( msg );
+		delete[]( *i );
 	}
 
+	m_poolSlabs.clear();
+	m_poolFree.clear();
 	m_delayedMessages.clear();
+	m_receiverIndex.clear();
 
 }
 
@@ -80,15 +108,12 @@ void MsgRoute::SendMsg( float delay, MSG_Name name,
 	{	
 		float deliveryTime = delay + g_time.GetCurTime();
 
-		//Check for duplicates - time complexity O(n)
-		bool set = false;
-		float lastDeliveryTime = 0.0f;
-		MessageContainer::iterator insertPosition = m_delayedMessages.end();
-		MessageContainer::iterator i;
-		for( i=m_delayedMessages.begin(); i!=m_delayedMessages.end(); ++i )
+		//Check for duplicates - time complexity O(1) (hashed on the message fields)
+		unsigned int hash = HashMessage( name, receiver, sender, rule, scope, queue, timer );
+		MessageBucket & bucket = m_duplicateIndex[hash & (m_duplicateIndex.size() - 1)];
+		for( MessageBucket::iterator i=bucket.begin(); i!=bucket.end(); ++i )
 		{
-			if( (*i)->IsDelivered() == false &&
-				(*i)->GetName() == name &&
+			if( (*i)->GetName() == name &&
 				(*i)->GetReceiver() == receiver &&
 				(*i)->GetSender() == sender &&
 				(*i)->GetScopeRule() == rule &&
@@ -103,38 +128,23 @@ void MsgRoute::SendMsg( float delay, MSG_Name name,
 							 "redundant messages.");
 				return;
 			}
-
-			//Sanity check that list is in order
-			if( (*i)->GetDeliveryTime() < lastDeliveryTime )
-			{
-				ASSERTMSG( 0, "MsgRoute::SendMsg - Message list not in order" );
-			}
-			lastDeliveryTime = (*i)->GetDeliveryTime();
-
-			if( !set && (*i)->GetDeliveryTime() > deliveryTime )
-			{	//Record place to insert new delayed message (we need the entry one beyond)
-				set = true;
-				insertPosition = i;
-			}
-		}
-		
-		//Store in delivery list
-		MSG_Object * msg = new MSG_Object( deliveryTime, name, sender, receiver, rule, scope, queue, data, timer, false );
-		if( m_delayedMessages.empty() || deliveryTime <= m_delayedMessages.front()->GetDeliveryTime() )
-		{	//Put at the front if the list is empty or the delivery time is sooner than the first entry
-			m_delayedMessages.push_front( msg );
-		}
-		else
-		{
-			m_delayedMessages.insert( insertPosition, msg );
 		}
+
+		//Store in delivery heap - time complexity O(log n)
+		MSG_Object * msg = AllocateMsg();
+		*msg = MSG_Object( deliveryTime, name, sender, receiver, rule, scope, queue, data, timer, false );
+		AddToDuplicateIndex( msg );
+		AddToReceiverIndex( msg );
+		PushDelayedMessage( msg );
 	}
 }
 
 /*---------------------------------------------------------------------------*
   Name:         VerifyDelayedMessageOrder
 
-  Description:  Verifies that the delayed messages are being ordered properly.
+  Description:  Verifies that the delayed messages are being ordered properly
+                (no message is delivered before its parent in the heap) and
+				that every pending one is in the duplicate index.
 
   Arguments:    None.
 
@@ -142,18 +152,19 @@ void MsgRoute::SendMsg( float delay, MSG_Name name,
  *---------------------------------------------------------------------------*/
 bool MsgRoute::VerifyDelayedMessageOrder( void )
 {	//Test for order - time complexity O(n)
-	float lastDeliveryTime = 0;
-
-	MessageContainer::iterator i;
-	for( i=m_delayedMessages.begin(); i!=m_delayedMessages.end(); ++i )
+	for( unsigned int i=1; i<m_delayedMessages.size(); ++i )
 	{
-		float time = (*i)->GetDeliveryTime();
-		if( time < lastDeliveryTime )
+		if( IsEarlier( m_delayedMessages[i], m_delayedMessages[(i - 1) / DELAYED_HEAP_ARITY] ) )
 		{
 			ASSERTMSG( 0, "MsgRoute::VerifyDelayedMessageOrder - Message list not in order" );
 			return false;
 		}
-		lastDeliveryTime = (*i)->GetDeliveryTime();
+	}
+
+	if( m_duplicateCount + m_tombstoneCount != m_delayedMessages.size() + m_heldMessages.size() )
+	{
+		ASSERTMSG( 0, "MsgRoute::VerifyDelayedMessageOrder - Duplicate index out of sync" );
+		return false;
 	}
 
 	return true;
@@ -171,27 +182,47 @@ bool MsgRoute::VerifyDelayedMessageOrder( void )
  *---------------------------------------------------------------------------*/
 
 void MsgRoute::SendMsgBroadcast( MSG_Object & msg, unsigned int type )
-{
-	dbCompositionList list;
-	g_database.ComposeList( list, type );
-
-	dbCompositionList::iterator i;
-	for( i=list.begin(); i!=list.end(); ++i )
-	{
-		if( msg.GetSender() != (*i)->GetID() )
+{	//Walk the database list of each type bit (no list is composed)
+	unsigned int remaining = type;
+	do
+	{	//Lowest remaining type bit (all objects for OBJECT_Ignore_Type)
+		unsigned int typeBit = remaining & (~remaining + 1);
+		remaining &= ~typeBit;
+
+		//Walk by index, since handlers may store objects (which don't get the message)
+		const dbCompositionList & list = g_database.GetTypeList( typeBit );
+		unsigned int count = list.size();
+		for( unsigned int i=0; i<count; ++i )
 		{
-			if((*i)->GetStateMachineManager())
+			GameObject * object = list[i];
+			if( (object->GetType() & type & (typeBit - 1)) != 0 )
+			{	//Already sent for a lower bit
+				continue;
+			}
+
+			if( msg.GetSender() != object->GetID() )
 			{
-				(*i)->GetStateMachineManager()->SendMsg( msg );
+				if(object->GetStateMachineManager())
+				{
+					object->GetStateMachineManager()->SendMsg( msg );
+				}
 			}
 		}
-	}
+	} while( remaining != 0 );
 }
 
 /*---------------------------------------------------------------------------*
   Name:         DeliverDelayedMessages
 
-  Description:  Sends delayed messages if the time is right.
+  Description:  Sends delayed messages if the time is right, within the load
+                balancing time limit. Time over the limit is taken out of the
+				next frame's limit (at most one frame's worth), and at least
+				one due message is delivered every frame.
+
+				Messages are delivered in order, except that a receiver that
+				has gotten its fairness quota this frame is held back while
+				other receivers have due messages. Held messages go next if
+				time remains, and otherwise keep their place for next frame.
 
   Arguments:    None.
 
@@ -199,31 +230,202 @@ void MsgRoute::SendMsgBroadcast( MSG_Object & msg, unsigned int type )
  *---------------------------------------------------------------------------*/
 void MsgRoute::DeliverDelayedMessages( void )
 {
-	double timeStart = g_time.GetHighestResolutionTime();
+	double timeStart = g_time.GetHighResolutionSeconds();
+	double budget = m_loadBalancingTimeLimit - m_budgetCarry;
+	float curTime = g_time.GetCurTime();
+	bool delivered = false;
+	bool overBudget = false;
+
+	m_deliveryFrame++;
 
-	MessageContainer::iterator i = m_delayedMessages.begin();
-	while( i != m_delayedMessages.end() )
+	//Due messages in order, holding back receivers over their quota
+	while( !m_delayedMessages.empty() )
 	{
-		if( (*i)->GetDeliveryTime() <= g_time.GetCurTime() )
-		{	//Deliver and delete msg
-			MSG_Object * msg = *i;
-			RouteMsg( *msg );
-			delete( msg );
-			i = m_delayedMessages.erase( i );
+		DelayedMessage entry = m_delayedMessages.front();
+		if( entry.msg->IsCancelled() )
+		{	//Discard tombstone
+			FreeMsg( entry.msg );
+			PopDelayedMessage();
+			m_tombstoneCount--;
+			continue;
 		}
-		else
-		{	//All messages beyond this one are not ready to fire, since the list is sorted
-			return;
+
+		if( entry.deliveryTime > curTime )
+		{	//All other messages are not ready to fire, since the heap top is the earliest
+			break;
 		}
 
 		//Decide whether to stop sending for this frame
-		double curTime = g_time.GetHighestResolutionTime();
-		if( curTime - timeStart > m_loadBalancingTimeLimit )
+		if( delivered && g_time.GetHighResolutionSeconds() - timeStart > budget )
 		{
-			return;
+			overBudget = true;
+			break;
+		}
+
+		PopDelayedMessage();
+
+		ReceiverMessages & receiver = m_receiverIndex[entry.msg->GetReceiver()];
+		if( receiver.frame != m_deliveryFrame )
+		{
+			receiver.frame = m_deliveryFrame;
+			receiver.frameDeliveries = 0;
+		}
+
+		if( m_fairnessQuota > 0 && receiver.frameDeliveries >= m_fairnessQuota )
+		{	//Let other receivers go first
+			m_heldMessages.push_back( entry );
+			continue;
+		}
+
+		receiver.frameDeliveries++;
+		DeliverDelayedMessage( entry, curTime );
+		delivered = true;
+	}
+
+	//Held messages in order, while time remains (routing may cancel them)
+	unsigned int held = 0;
+	for( ; held<m_heldMessages.size(); ++held )
+	{
+		const DelayedMessage & entry = m_heldMessages[held];
+		if( entry.msg->IsCancelled() )
+		{
+			FreeMsg( entry.msg );
+			m_tombstoneCount--;
+			continue;
+		}
+
+		if( overBudget || (delivered && g_time.GetHighResolutionSeconds() - timeStart > budget) )
+		{
+			overBudget = true;
+			break;
 		}
 
+		DeliverDelayedMessage( entry, curTime );
+		delivered = true;
+	}
+
+	//Return the rest to the heap with their send order
+	for( ; held<m_heldMessages.size(); ++held )
+	{
+		InsertDelayedMessage( m_heldMessages[held] );
+	}
+	m_heldMessages.clear();
+
+	if( overBudget )
+	{
+		m_deliveryStats.framesOverBudget++;
+		m_deliveryStats.deferred += CountDueMessages( curTime );
+	}
+
+	//Carry the time over the limit into the next frame
+	double spent = g_time.GetHighResolutionSeconds() - timeStart;
+	m_budgetCarry = spent - budget;
+	if( m_budgetCarry < 0.0 )
+	{
+		m_budgetCarry = 0.0;
+	}
+	else if( m_budgetCarry > m_loadBalancingTimeLimit )
+	{
+		m_budgetCarry = m_loadBalancingTimeLimit;
 	}
+
+	m_lastDeliveryTime = curTime;
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         DeliverDelayedMessage
+
+  Description:  Delivers and frees a due message taken out of the heap.
+
+  Arguments:    entry   : the message heap entry
+                curTime : the game time of this frame's delivery
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::DeliverDelayedMessage( const DelayedMessage & entry, float curTime )
+{
+	MSG_Object * msg = entry.msg;
+
+	m_deliveryStats.delivered++;
+	if( entry.deliveryTime <= m_lastDeliveryTime )
+	{	//Was already due last frame
+		float lateness = curTime - entry.deliveryTime;
+		m_deliveryStats.lateDelivered++;
+		m_deliveryStats.totalLateness += lateness;
+		if( lateness > m_deliveryStats.maxLateness )
+		{
+			m_deliveryStats.maxLateness = lateness;
+		}
+	}
+
+	//Take the msg out of the indices first, since routing it may
+	//send, remove or purge delayed messages. Then deliver and free msg.
+	RemoveFromDuplicateIndex( msg );
+	RemoveFromReceiverIndex( msg );
+	RouteMsg( *msg );
+	FreeMsg( msg );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         CountDueMessages
+
+  Description:  Counts the pending messages due by a time. Due messages form
+                a subtree at the top of the heap, so only they are visited.
+
+  Arguments:    curTime : the time
+
+  Returns:      The number of messages.
+ *---------------------------------------------------------------------------*/
+unsigned int MsgRoute::CountDueMessages( float curTime )
+{
+	unsigned int count = 0;
+
+	m_dueScratch.clear();
+	if( !m_delayedMessages.empty() )
+	{
+		m_dueScratch.push_back( 0 );
+	}
+
+	while( !m_dueScratch.empty() )
+	{
+		unsigned int index = m_dueScratch.back();
+		m_dueScratch.pop_back();
+		if( m_delayedMessages[index].deliveryTime > curTime )
+		{
+			continue;
+		}
+
+		if( !m_delayedMessages[index].msg->IsCancelled() )
+		{
+			count++;
+		}
+
+		for( unsigned int i=index*DELAYED_HEAP_ARITY+1; i<=index*DELAYED_HEAP_ARITY+DELAYED_HEAP_ARITY && i<m_delayedMessages.size(); ++i )
+		{
+			m_dueScratch.push_back( i );
+		}
+	}
+
+	return( count );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         ResetDeliveryStats
+
+  Description:  Zeroes the delayed message delivery counters.
+
+  Arguments:    None.
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::ResetDeliveryStats( void )
+{
+	m_deliveryStats.delivered = 0;
+	m_deliveryStats.deferred = 0;
+	m_deliveryStats.lateDelivered = 0;
+	m_deliveryStats.totalLateness = 0.0f;
+	m_deliveryStats.maxLateness = 0.0f;
+	m_deliveryStats.framesOverBudget = 0;
 }
 
 /*---------------------------------------------------------------------------*
@@ -270,6 +472,59 @@ void MsgRoute::RouteMsg( MSG_Object & msg )
 	}
 }
 
+/*---------------------------------------------------------------------------*
+  Name:         AllocateMsg
+
+  Description:  Takes a delayed message from the pool, adding a slab when the
+                pool is empty. Once the pool has grown to the most messages
+				pending at once, sending delayed messages (including the
+				periodic timer resends) no longer allocates memory.
+
+  Arguments:    None.
+
+  Returns:      The message (to be set by the caller).
+ *---------------------------------------------------------------------------*/
+MSG_Object * MsgRoute::AllocateMsg( void )
+{
+	if( m_poolFree.empty() )
+	{	//Add a slab (free list capacity grows with it, so frees never allocate)
+		MSG_Object * slab = new MSG_Object[MSG_POOL_SLAB_SIZE];
+		m_poolSlabs.push_back( slab );
+		m_poolFree.reserve( m_poolSlabs.size() * MSG_POOL_SLAB_SIZE );
+		for( int i=MSG_POOL_SLAB_SIZE-1; i>=0; --i )
+		{
+			m_poolFree.push_back( &slab[i] );
+		}
+	}
+
+	MSG_Object * msg = m_poolFree.back();
+	m_poolFree.pop_back();
+
+	m_poolInUse++;
+	if( m_poolInUse > m_poolHighWater )
+	{
+		m_poolHighWater = m_poolInUse;
+	}
+
+	return( msg );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         FreeMsg
+
+  Description:  Returns a delayed message to the pool.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::FreeMsg( MSG_Object * msg )
+{
+	ASSERTMSG( m_poolInUse > 0, "MsgRoute::FreeMsg - Pool already empty" );
+	m_poolFree.push_back( msg );
+	m_poolInUse--;
+}
+
 /*---------------------------------------------------------------------------*
   Name:         RemoveMsg
 
@@ -285,25 +540,34 @@ void MsgRoute::RouteMsg( MSG_Object & msg )
   Returns:      None.
  *---------------------------------------------------------------------------*/
 void MsgRoute::RemoveMsg( MSG_Name name, objectID receiver, objectID sender, bool timer )
-{
-	MessageContainer::iterator i = m_delayedMessages.begin();
-	while( i != m_delayedMessages.end() )
+{	//Only the receiver's messages are checked
+	ReceiverIndex::iterator messages = m_receiverIndex.find( receiver );
+	if( messages == m_receiverIndex.end() )
+	{
+		return;
+	}
+
+	MessageBucket & bucket = messages->second.messages;
+	unsigned int i = 0;
+	while( i < bucket.size() )
 	{
-		MSG_Object * msg = *i;
+		MSG_Object * msg = bucket[i];
 		if( msg->GetName() == name &&
-			msg->GetReceiver() == receiver &&
 			msg->GetSender() == sender &&
 			msg->IsTimer() == timer &&
 			!msg->IsDelivered() )
-		{
-			delete( msg );
-			i = m_delayedMessages.erase( i );
+		{	//Swap with the last entry
+			bucket[i] = bucket.back();
+			bucket.pop_back();
+			CancelDelayedMessage( msg );
 		}
 		else
 		{
 			++i;
 		}
 	}
+
+	CompactDelayedMessages();
 }
 
 /*---------------------------------------------------------------------------*
@@ -320,26 +584,426 @@ void MsgRoute::RemoveMsg( MSG_Name name, objectID receiver, objectID sender, boo
   Returns:      None.
  *---------------------------------------------------------------------------*/
 void MsgRoute::PurgeScopedMsg( objectID receiver, StateMachineQueue queue )
-{
-	MessageContainer::iterator i = m_delayedMessages.begin();
-	while( i != m_delayedMessages.end() )
+{	//Only the receiver's messages are checked
+	ReceiverIndex::iterator messages = m_receiverIndex.find( receiver );
+	if( messages == m_receiverIndex.end() )
 	{
-		MSG_Object * msg = *i;
-		if( msg->GetReceiver() == receiver &&
-			msg->GetQueue() == queue &&
+		return;
+	}
+
+	MessageBucket & bucket = messages->second.messages;
+	unsigned int i = 0;
+	while( i < bucket.size() )
+	{
+		MSG_Object * msg = bucket[i];
+		if( msg->GetQueue() == queue &&
 			msg->GetScopeRule() != SCOPE_TO_STATE_MACHINE &&
 			!msg->IsDelivered() )
-		{
-			delete( msg );
-			i = m_delayedMessages.erase( i );
+		{	//Swap with the last entry
+			bucket[i] = bucket.back();
+			bucket.pop_back();
+			CancelDelayedMessage( msg );
 		}
 		else
 		{
 			++i;
 		}
 	}
+
+	CompactDelayedMessages();
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         IsEarlier
+
+  Description:  Heap order: delivery time, then send order, so that messages
+                with equal delivery times are delivered in the order sent.
+				The send order comparison tolerates counter wraparound.
+
+  Arguments:    a : a heap entry
+                b : another heap entry
+
+  Returns:      True if a is delivered before b.
+ *---------------------------------------------------------------------------*/
+bool MsgRoute::IsEarlier( const DelayedMessage & a, const DelayedMessage & b )
+{
+	if( a.deliveryTime != b.deliveryTime )
+	{
+		return( a.deliveryTime < b.deliveryTime );
+	}
+	return( (int)(a.sequence - b.sequence) < 0 );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         PushDelayedMessage
+
+  Description:  Adds a message to the delayed message heap - time complexity
+                O(log n).
+
+  Arguments:    msg : the message (owned by the heap until delivered or removed)
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::PushDelayedMessage( MSG_Object * msg )
+{
+	DelayedMessage entry;
+	entry.deliveryTime = msg->GetDeliveryTime();
+	entry.sequence = m_nextSequence++;
+	entry.msg = msg;
+
+	InsertDelayedMessage( entry );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         InsertDelayedMessage
+
+  Description:  Adds an entry to the delayed message heap, keeping its send
+                order - time complexity O(log n).
+
+  Arguments:    entry : the heap entry
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::InsertDelayedMessage( const DelayedMessage & entry )
+{
+	m_delayedMessages.push_back( entry );
+	SiftUp( m_delayedMessages.size() - 1 );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         PopDelayedMessage
+
+  Description:  Removes the earliest message from the delayed message heap
+                (the message is not deleted) - time complexity O(log n).
+
+  Arguments:    None.
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::PopDelayedMessage( void )
+{
+	m_delayedMessages.front() = m_delayedMessages.back();
+	m_delayedMessages.pop_back();
+
+	if( !m_delayedMessages.empty() )
+	{
+		SiftDown( 0 );
+	}
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         SiftUp
+
+  Description:  Moves a heap entry towards the top until its parent is earlier.
+
+  Arguments:    index : the entry index
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::SiftUp( unsigned int index )
+{
+	DelayedMessage entry = m_delayedMessages[index];
+
+	while( index > 0 )
+	{
+		unsigned int parent = (index - 1) / DELAYED_HEAP_ARITY;
+		if( !IsEarlier( entry, m_delayedMessages[parent] ) )
+		{
+			break;
+		}
+		m_delayedMessages[index] = m_delayedMessages[parent];
+		index = parent;
+	}
+
+	m_delayedMessages[index] = entry;
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         SiftDown
+
+  Description:  Moves a heap entry towards the bottom until none of its
+                children is earlier. The children of a node are adjacent,
+				so each level compares entries within a cache line or two.
+
+  Arguments:    index : the entry index
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::SiftDown( unsigned int index )
+{
+	DelayedMessage entry = m_delayedMessages[index];
+	unsigned int size = m_delayedMessages.size();
+
+	for(;;)
+	{
+		unsigned int first = index * DELAYED_HEAP_ARITY + 1;
+		if( first >= size )
+		{
+			break;
+		}
+
+		//Earliest child
+		unsigned int last = first + DELAYED_HEAP_ARITY < size ? first + DELAYED_HEAP_ARITY : size;
+		unsigned int child = first;
+		for( unsigned int i=first+1; i<last; ++i )
+		{
+			if( IsEarlier( m_delayedMessages[i], m_delayedMessages[child] ) )
+			{
+				child = i;
+			}
+		}
+
+		if( !IsEarlier( m_delayedMessages[child], entry ) )
+		{
+			break;
+		}
+		m_delayedMessages[index] = m_delayedMessages[child];
+		index = child;
+	}
+
+	m_delayedMessages[index] = entry;
 }
 
+/*---------------------------------------------------------------------------*
+  Name:         RebuildHeap
+
+  Description:  Restores the heap order of every entry (after entries were
+                removed from the middle) - time complexity O(n).
 
+  Arguments:    None.
 
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::RebuildHeap( void )
+{
+	if( m_delayedMessages.size() < 2 )
+	{
+		return;
+	}
 
+	for( unsigned int i=(m_delayedMessages.size() - 2) / DELAYED_HEAP_ARITY + 1; i>0; --i )
+	{
+		SiftDown( i - 1 );
+	}
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         CancelDelayedMessage
+
+  Description:  Removes a pending message from the duplicate index and marks
+                it cancelled. The message stays in the heap as a tombstone
+				(finding its heap entry would take a search) and is freed
+				when it reaches the top or when the heap is compacted. The
+				caller removes it from the receiver index.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::CancelDelayedMessage( MSG_Object * msg )
+{
+	RemoveFromDuplicateIndex( msg );
+	msg->SetCancelled( true );
+	m_tombstoneCount++;
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         CompactDelayedMessages
+
+  Description:  Frees the tombstones once they are at least half of the
+                heap, so that cancelled timers do not pile up - time
+				complexity O(n), amortized over the cancellations.
+
+  Arguments:    None.
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::CompactDelayedMessages( void )
+{
+	if( m_tombstoneCount < TOMBSTONE_MIN_COMPACT || m_tombstoneCount * 2 < m_delayedMessages.size() )
+	{
+		return;
+	}
+
+	unsigned int count = 0;
+	for( unsigned int i=0; i<m_delayedMessages.size(); ++i )
+	{
+		if( m_delayedMessages[i].msg->IsCancelled() )
+		{
+			FreeMsg( m_delayedMessages[i].msg );
+			m_tombstoneCount--;
+		}
+		else
+		{
+			m_delayedMessages[count++] = m_delayedMessages[i];
+		}
+	}
+
+	m_delayedMessages.resize( count );
+	RebuildHeap();
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         HashMessage
+
+  Description:  Hashes the fields compared by duplicate detection (except
+                the data, which is compared within a bucket).
+
+  Arguments:    The message fields.
+
+  Returns:      The hash value.
+ *---------------------------------------------------------------------------*/
+unsigned int MsgRoute::HashMessage( MSG_Name name, objectID receiver, objectID sender,
+                                    Scope_Rule rule, unsigned int scope, unsigned int queue, bool timer )
+{	//FNV-1a style mixing of each field
+	unsigned int hash = 2166136261u;
+	hash = (hash ^ (unsigned int)name) * 16777619u;
+	hash = (hash ^ receiver) * 16777619u;
+	hash = (hash ^ sender) * 16777619u;
+	hash = (hash ^ scope) * 16777619u;
+	hash = (hash ^ (((unsigned int)rule << 4) | (queue << 1) | (timer ? 1 : 0))) * 16777619u;
+	return( hash ^ (hash >> 15) );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         GetDuplicateBucket
+
+  Description:  Returns the duplicate index bucket of a message.
+
+  Arguments:    msg : the message
+
+  Returns:      The bucket.
+ *---------------------------------------------------------------------------*/
+MessageBucket & MsgRoute::GetDuplicateBucket( MSG_Object & msg )
+{
+	unsigned int hash = HashMessage( msg.GetName(), msg.GetReceiver(), msg.GetSender(),
+	                                 msg.GetScopeRule(), msg.GetScope(), msg.GetQueue(), msg.IsTimer() );
+	return( m_duplicateIndex[hash & (m_duplicateIndex.size() - 1)] );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         AddToDuplicateIndex
+
+  Description:  Adds a delayed message to the duplicate index. The buckets
+                double when there are more messages than buckets.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::AddToDuplicateIndex( MSG_Object * msg )
+{
+	if( m_duplicateCount >= m_duplicateIndex.size() )
+	{	//Rehash into twice the buckets
+		std::vector<MessageBucket> buckets( m_duplicateIndex.size() * 2 );
+		m_duplicateIndex.swap( buckets );
+		for( std::vector<MessageBucket>::iterator bucket=buckets.begin(); bucket!=buckets.end(); ++bucket )
+		{
+			for( MessageBucket::iterator i=bucket->begin(); i!=bucket->end(); ++i )
+			{
+				GetDuplicateBucket( **i ).push_back( *i );
+			}
+		}
+	}
+
+	GetDuplicateBucket( *msg ).push_back( msg );
+	m_duplicateCount++;
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         RemoveFromDuplicateIndex
+
+  Description:  Removes a delayed message from the duplicate index.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::RemoveFromDuplicateIndex( MSG_Object * msg )
+{
+	MessageBucket & bucket = GetDuplicateBucket( *msg );
+	for( MessageBucket::iterator i=bucket.begin(); i!=bucket.end(); ++i )
+	{
+		if( *i == msg )
+		{
+			*i = bucket.back();
+			bucket.pop_back();
+			m_duplicateCount--;
+			return;
+		}
+	}
+
+	ASSERTMSG( 0, "MsgRoute::RemoveFromDuplicateIndex - Message not in index" );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         AddToReceiverIndex
+
+  Description:  Adds a pending delayed message to its receiver's messages.
+                Receivers are kept once their messages are gone (a timer's
+				receiver is usually about to get its next one), and pruned
+				when they outnumber twice the pending messages.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::AddToReceiverIndex( MSG_Object * msg )
+{
+	ReceiverIndex::iterator messages = m_receiverIndex.find( msg->GetReceiver() );
+	if( messages == m_receiverIndex.end() )
+	{
+		if( m_receiverIndex.size() >= RECEIVER_INDEX_MIN_PRUNE &&
+			m_receiverIndex.size() > m_duplicateCount * 2 )
+		{	//Prune receivers without messages
+			ReceiverIndex::iterator i = m_receiverIndex.begin();
+			while( i != m_receiverIndex.end() )
+			{
+				if( i->second.messages.empty() && i->second.frame != m_deliveryFrame )
+				{
+					m_receiverIndex.erase( i++ );
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+		ReceiverMessages receiver;
+		receiver.frame = 0;
+		receiver.frameDeliveries = 0;
+		messages = m_receiverIndex.insert( ReceiverIndex::value_type( msg->GetReceiver(), receiver ) ).first;
+	}
+
+	messages->second.messages.push_back( msg );
+}
+
+/*---------------------------------------------------------------------------*
+  Name:         RemoveFromReceiverIndex
+
+  Description:  Removes a delayed message from its receiver's messages.
+
+  Arguments:    msg : the message
+
+  Returns:      None.
+ *---------------------------------------------------------------------------*/
+void MsgRoute::RemoveFromReceiverIndex( MSG_Object * msg )
+{
+	ReceiverIndex::iterator messages = m_receiverIndex.find( msg->GetReceiver() );
+	if( messages != m_receiverIndex.end() )
+	{
+		MessageBucket & bucket = messages->second.messages;
+		for( MessageBucket::iterator i=bucket.begin(); i!=bucket.end(); ++i )
+		{
+			if( *i == msg )
+			{
+				*i = bucket.back();
+				bucket.pop_back();
+				return;
+			}
+		}
+	}
+
+	ASSERTMSG( 0, "MsgRoute::RemoveFromReceiverIndex - Message not in index" );
+}
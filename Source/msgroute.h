@@ -13,13 +13,48 @@
 #include "msg.h"
 #include "time.h"
 #include "singleton.h"
-#include <list>
+#include <vector>
+#include <map>
 
 //Forward declaration
 enum StateMachineQueue;
 
 
-typedef std::list<MSG_Object*> MessageContainer;
+//Delayed message heap entry. The delivery time and send order are copied
+//out of the message so that heap comparisons stay within the array.
+struct DelayedMessage
+{
+	float deliveryTime;			//Time at which to send the message
+	unsigned int sequence;		//Send order (delivery order for equal times)
+	MSG_Object * msg;
+};
+
+typedef std::vector<DelayedMessage> MessageContainer;
+typedef std::vector<MSG_Object*> MessageBucket;
+
+//Pending delayed messages of a receiver, and its deliveries this frame
+struct ReceiverMessages
+{
+	MessageBucket messages;
+	unsigned int frame;				//Delivery frame of the count below
+	unsigned int frameDeliveries;	//Messages delivered to the receiver in that frame
+};
+
+typedef std::map<objectID, ReceiverMessages> ReceiverIndex;
+
+//Delayed message delivery counters (since the last reset)
+struct DelayedDeliveryStats
+{
+	unsigned int delivered;			//Delayed messages delivered
+	unsigned int deferred;			//Due messages held for a later frame (counted each frame held)
+	unsigned int lateDelivered;		//Messages delivered after being held
+	float totalLateness;			//Seconds past due of the held messages, summed
+	float maxLateness;				//Seconds past due of the latest held message
+	unsigned int framesOverBudget;	//Frames that stopped delivering due messages at the time limit
+};
+
+//Delayed messages per pool slab
+#define MSG_POOL_SLAB_SIZE 256
 
 class MsgRoute : public Singleton <MsgRoute>
 {
@@ -40,6 +75,9 @@ public:
 
 	//Delayed message load balancing
 	inline void SetLoadBalancingConstraint(float maxTimePerFrameInSeconds)	{ m_loadBalancingTimeLimit = maxTimePerFrameInSeconds; }
+	inline void SetFairnessQuota(unsigned int messagesPerReceiver)		{ m_fairnessQuota = messagesPerReceiver; }
+	inline const DelayedDeliveryStats & GetDeliveryStats( void )			{ return( m_deliveryStats ); }
+	void ResetDeliveryStats( void );
 	
 	//Removing delayed messages
 	void RemoveMsg( MSG_Name name, objectID receiver, objectID sender, bool timer );
@@ -48,11 +86,60 @@ public:
 	//For testing (unit tests)
 	bool VerifyDelayedMessageOrder( void );
 
+	//Delayed message pool stats
+	inline unsigned int GetPooledMsgCount( void )			{ return( m_poolInUse ); }
+	inline unsigned int GetPooledMsgHighWater( void )		{ return( m_poolHighWater ); }
+	inline unsigned int GetPooledMsgCapacity( void )		{ return( m_poolSlabs.size() * MSG_POOL_SLAB_SIZE ); }
+
 private:
 
-	MessageContainer m_delayedMessages;
-	float m_loadBalancingTimeLimit;
+	MessageContainer m_delayedMessages;				//4-ary min heap on (delivery time, send order)
+	std::vector<MessageBucket> m_duplicateIndex;	//Delayed messages hashed by their fields (power of 2 buckets)
+	unsigned int m_duplicateCount;					//Messages in the duplicate index
+	unsigned int m_nextSequence;					//Send order of the next delayed message
+	ReceiverIndex m_receiverIndex;					//Pending delayed messages by receiver
+	unsigned int m_tombstoneCount;					//Cancelled messages not yet freed
+	std::vector<MSG_Object*> m_poolSlabs;			//Delayed message storage (MSG_POOL_SLAB_SIZE each)
+	std::vector<MSG_Object*> m_poolFree;			//Free delayed messages
+	unsigned int m_poolInUse;						//Delayed messages allocated (pending or tombstones)
+	unsigned int m_poolHighWater;					//Most delayed messages allocated at once
+	float m_loadBalancingTimeLimit;					//Seconds of delivery per frame
+	double m_budgetCarry;							//Seconds the last frame ran over its budget
+	unsigned int m_fairnessQuota;					//Messages per receiver per frame before others go first (0 for none)
+	unsigned int m_deliveryFrame;					//Calls to DeliverDelayedMessages
+	float m_lastDeliveryTime;						//Game time of the last call
+	MessageContainer m_heldMessages;				//Due messages held back this frame (receivers over quota)
+	std::vector<unsigned int> m_dueScratch;			//Heap traversal when counting due messages
+	DelayedDeliveryStats m_deliveryStats;
 
 	void RouteMsg( MSG_Object & msg );	
+	void DeliverDelayedMessage( const DelayedMessage & entry, float curTime );
+	unsigned int CountDueMessages( float curTime );
+
+	//Delayed message pool
+	MSG_Object * AllocateMsg( void );
+	void FreeMsg( MSG_Object * msg );
+
+	//Delayed message heap
+	static bool IsEarlier( const DelayedMessage & a, const DelayedMessage & b );
+	void PushDelayedMessage( MSG_Object * msg );
+	void InsertDelayedMessage( const DelayedMessage & entry );
+	void PopDelayedMessage( void );
+	void SiftUp( unsigned int index );
+	void SiftDown( unsigned int index );
+	void RebuildHeap( void );
+	void CancelDelayedMessage( MSG_Object * msg );
+	void CompactDelayedMessages( void );
+
+	//Duplicate index
+	static unsigned int HashMessage( MSG_Name name, objectID receiver, objectID sender,
+	                                 Scope_Rule rule, unsigned int scope, unsigned int queue, bool timer );
+	MessageBucket & GetDuplicateBucket( MSG_Object & msg );
+	void AddToDuplicateIndex( MSG_Object * msg );
+	void RemoveFromDuplicateIndex( MSG_Object * msg );
+
+	//Receiver index
+	void AddToReceiverIndex( MSG_Object * msg );
+	void RemoveFromReceiverIndex( MSG_Object * msg );
 
 };
@@ -18,6 +18,10 @@ Time::Time( void )
 	m_currentTime = 0.0f;
 	m_timeLastTick = 0.001f;
 	m_startTime = timeGetTime();
+
+	LARGE_INTEGER qwFrequency;
+	QueryPerformanceFrequency( &qwFrequency );
+	m_secondsPerTick = 1.0 / (double)qwFrequency.QuadPart;
 }
 
 /*---------------------------------------------------------------------------*
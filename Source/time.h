@@ -26,6 +26,8 @@ public:
 	inline float GetCurTime( void )				{ return( m_currentTime ); }
 	inline double GetAbsoluteTime( void )		{ return( m_timer.GetAbsoluteTime() ); }
 	inline double GetHighestResolutionTime( void )	{ LARGE_INTEGER qwTime; QueryPerformanceCounter( &qwTime ); return((double)qwTime.QuadPart); }
+	inline double GetHighResolutionSeconds( void )	{ return( GetHighestResolutionTime() * m_secondsPerTick ); }
+	inline double GetSecondsPerTick( void )		{ return( m_secondsPerTick ); }
 
 
 private:
@@ -33,6 +35,7 @@ private:
 	unsigned int m_startTime;
 	float m_currentTime;
 	float m_timeLastTick;
+	double m_secondsPerTick;
 	CDXUTTimer m_timer;
 
 };
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Game Development Project
+* DXUT.h (headless tools)
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Stand-in for the DXUT/Direct3D headers so the world and path search sources
+* build headless. Only the types and helpers used by those sources are
+* provided.
+*
+*******************************************************************************/
+
+#pragma once
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+// win32 types
+typedef long HRESULT;
+typedef wchar_t WCHAR;
+typedef const wchar_t* LPCWSTR;
+
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+
+#define SAFE_DELETE(p)          { if(p) { delete (p); (p) = NULL; } }
+#define SAFE_DELETE_ARRAY(p)    { if(p) { delete[] (p); (p) = NULL; } }
+
+// aligned allocation (crt)
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+    void* p = NULL;
+    return posix_memalign(&p, alignment, size) == 0 ? p : NULL;
+}
+
+inline void _aligned_free(void* p)
+{
+    free(p);
+}
+
+/**
+* 2D vector (d3dx)
+*/
+struct D3DXVECTOR2
+{
+    float x, y;
+
+    D3DXVECTOR2() {}
+    D3DXVECTOR2(float fx, float fy) : x(fx), y(fy) {}
+
+    D3DXVECTOR2 operator+(const D3DXVECTOR2& v) const { return D3DXVECTOR2(x + v.x, y + v.y); }
+    D3DXVECTOR2 operator-(const D3DXVECTOR2& v) const { return D3DXVECTOR2(x - v.x, y - v.y); }
+    D3DXVECTOR2 operator*(float f) const { return D3DXVECTOR2(x * f, y * f); }
+    D3DXVECTOR2 operator/(float f) const { return D3DXVECTOR2(x / f, y / f); }
+    D3DXVECTOR2& operator+=(const D3DXVECTOR2& v) { x += v.x; y += v.y; return *this; }
+    D3DXVECTOR2& operator-=(const D3DXVECTOR2& v) { x -= v.x; y -= v.y; return *this; }
+    bool operator==(const D3DXVECTOR2& v) const { return x == v.x && y == v.y; }
+    bool operator!=(const D3DXVECTOR2& v) const { return x != v.x || y != v.y; }
+};
+
+inline float D3DXVec2Length(const D3DXVECTOR2* pV)
+{
+    return sqrtf(pV->x * pV->x + pV->y * pV->y);
+}
+
+inline D3DXVECTOR2* D3DXVec2CatmullRom(D3DXVECTOR2* pOut, const D3DXVECTOR2* pV0, const D3DXVECTOR2* pV1, const D3DXVECTOR2* pV2, const D3DXVECTOR2* pV3, float s)
+{
+    float s2 = s * s;
+    float s3 = s2 * s;
+
+    pOut->x = 0.5f * (2.0f * pV1->x + (pV2->x - pV0->x) * s + (2.0f * pV0->x - 5.0f * pV1->x + 4.0f * pV2->x - pV3->x) * s2 + (3.0f * pV1->x - pV0->x - 3.0f * pV2->x + pV3->x) * s3);
+    pOut->y = 0.5f * (2.0f * pV1->y + (pV2->y - pV0->y) * s + (2.0f * pV0->y - 5.0f * pV1->y + 4.0f * pV2->y - pV3->y) * s2 + (3.0f * pV1->y - pV0->y - 3.0f * pV2->y + pV3->y) * s3);
+    return pOut;
+}
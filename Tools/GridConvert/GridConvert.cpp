@@ -0,0 +1,92 @@
+/*******************************************************************************
+* Game Development Project
+* GridConvert.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Converts text (.grd) world files to binary grid files. The binary file is
+* loaded back and compared cell by cell before the tool reports success.
+*
+* Usage: gridconvert input.grd output.grb
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "WorldFile.h"
+#include <time.h>
+
+/**
+* Seconds from a monotonic clock
+*/
+static double GetSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+* Entry point
+*/
+int main(int argc, char** argv)
+{
+    if( argc != 3 )
+    {
+        fprintf(stderr, "usage: gridconvert input.grd output.grb\n");
+        return 2;
+    }
+
+    WCHAR wsInput[ MAX_PATH ];
+    WCHAR wsOutput[ MAX_PATH ];
+    mbstowcs(wsInput, argv[1], MAX_PATH);
+    mbstowcs(wsOutput, argv[2], MAX_PATH);
+
+    // load text
+    WorldFile text;
+    double dStart = GetSeconds();
+    if( !text.Load(wsInput) )
+    {
+        fprintf(stderr, "gridconvert: cannot load %s\n", argv[1]);
+        return 1;
+    }
+    double dTextTime = GetSeconds() - dStart;
+
+    if( !text.SaveBinary(wsOutput) )
+    {
+        fprintf(stderr, "gridconvert: cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    // load binary and verify
+    WorldFile binary;
+    dStart = GetSeconds();
+    if( !binary.Load(wsOutput) )
+    {
+        fprintf(stderr, "gridconvert: cannot load %s\n", argv[2]);
+        return 1;
+    }
+    double dBinaryTime = GetSeconds() - dStart;
+
+    if( binary.GetWidth() != text.GetWidth() || binary.GetHeight() != text.GetHeight() )
+    {
+        fprintf(stderr, "gridconvert: size mismatch in %s\n", argv[2]);
+        return 1;
+    }
+
+    for(int row = 0; row < text.GetHeight(); ++row)
+    {
+        for(int col = 0; col < text.GetWidth(); ++col)
+        {
+            if( binary(row, col) != text(row, col) )
+            {
+                fprintf(stderr, "gridconvert: cell %d,%d differs in %s\n", row, col, argv[2]);
+                return 1;
+            }
+        }
+    }
+
+    printf("%s: %dx%d cells, text load %.2f ms, binary load %.2f ms\n",
+        argv[2], text.GetWidth(), text.GetHeight(), dTextTime * 1e3, dBinaryTime * 1e3);
+    return 0;
+}
@@ -0,0 +1,451 @@
+/*******************************************************************************
+* Game Development Project
+* PathBench.cpp
+*
+* Eric Schwabe
+* 2026-10-17
+*
+* Headless path search benchmark. Loads text or binary worlds, generates reproducible
+* random and adversarial start/goal sets, runs the game's search pipeline
+* under each option set and writes one JSON object per line:
+*
+*   {"type":"run", ...}         benchmark settings
+*   {"type":"world", ...}       world size and query set sizes
+*   {"type":"result", ...}      statistics of one world, query set and option set
+*
+* Usage: pathbench [-seed N] [-queries N] [-nojps] [-nolandmarks] world ...
+*
+*******************************************************************************/
+
+#include "DXUT.h"
+#include "WorldFile.h"
+#include "PathSearch.h"
+#include "PathLandmarks.h"
+#include "FlowField.h"
+#include "PathWaypoints.h"
+#include <float.h>
+#include <algorithm>
+#include <vector>
+#include <sys/resource.h>
+#include <time.h>
+
+// game defaults (WorldData)
+static const float kHeuristicWeight = 1.01f;
+static const int kLandmarkCount = 8;
+
+// search expansions per step (the game runs several steps per query)
+static const int kStepExpansions = 1000;
+
+// candidate pairs scored per adversarial query
+static const int kAdversarialCandidates = 8;
+
+/**
+* Start/goal pair with its optimal grid distance (negative if unreachable)
+*/
+struct BenchQuery
+{
+    PathNodeKey nkStart;
+    PathNodeKey nkGoal;
+    float fOptimal;
+};
+
+/**
+* Pipeline option set
+*/
+struct BenchConfig
+{
+    const char* szName;
+    bool bRubberband;
+    bool bSmooth;
+    bool bAnyAngle;
+};
+
+static const BenchConfig kConfigs[] =
+{
+    { "grid",               false,  false,  false },
+    { "rubberband",         true,   false,  false },
+    { "smooth",             false,  true,   false },
+    { "rubberband_smooth",  true,   true,   false },
+    { "any_angle",          false,  false,  true  },
+};
+
+static const int kConfigCount = sizeof(kConfigs) / sizeof(kConfigs[0]);
+
+/**
+* Reproducible random numbers (same sequence on every platform)
+*/
+class BenchRandom
+{
+    public:
+
+        BenchRandom(unsigned int uSeed) : m_uState(uSeed * 2654435761u + 1) {}
+
+        int Next(int iRange)
+        {
+            m_uState = m_uState * 1664525u + 1013904223u;
+            return (int)((m_uState >> 8) % (unsigned int)iRange);
+        }
+
+    private:
+
+        unsigned int m_uState;
+};
+
+/**
+* Seconds from a monotonic clock
+*/
+static double GetSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+* Peak resident memory of the process (kilobytes)
+*/
+static long GetPeakMemory()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+* Picks a random open cell
+*/
+static PathNodeKey GetRandomOpenCell(const WorldFile& worldFile, BenchRandom& random)
+{
+    PathNodeKey key;
+    do
+    {
+        key.iRow = random.Next(worldFile.GetHeight());
+        key.iCol = random.Next(worldFile.GetWidth());
+    }
+    while( worldFile(key.iRow, key.iCol) == WorldFile::OCCUPIED_CELL );
+
+    return key;
+}
+
+/**
+* Octile distance between two cells (the search heuristic)
+*/
+static float GetOctileDistance(const PathNodeKey& nkA, const PathNodeKey& nkB)
+{
+    float fRows = (float)abs(nkA.iRow - nkB.iRow);
+    float fCols = (float)abs(nkA.iCol - nkB.iCol);
+    float fMin = std::min(fRows, fCols);
+    float fMax = std::max(fRows, fCols);
+    return fMin * 1.41421356f + fMax - fMin;
+}
+
+/**
+* Creates a query and computes its optimal distance
+*/
+static BenchQuery CreateQuery(FlowField& field, const PathNodeKey& nkStart, const PathNodeKey& nkGoal)
+{
+    BenchQuery query;
+    query.nkStart = nkStart;
+    query.nkGoal = nkGoal;
+
+    field.SetGoal(nkGoal);
+    float fCost = field.GetCost(nkStart);
+    query.fOptimal = (fCost < FLT_MAX) ? fCost : -1.0f;
+
+    return query;
+}
+
+/**
+* Random start/goal pairs between open cells
+*/
+static void CreateRandomQueries(const WorldFile& worldFile, FlowField& field, BenchRandom& random, int iCount, std::vector<BenchQuery>* queries)
+{
+    for(int i = 0; i < iCount; ++i)
+    {
+        PathNodeKey nkStart = GetRandomOpenCell(worldFile, random);
+        PathNodeKey nkGoal = GetRandomOpenCell(worldFile, random);
+        queries->push_back(CreateQuery(field, nkStart, nkGoal));
+    }
+}
+
+/**
+* Adversarial start/goal pairs: the pairs with the largest detour over the
+* heuristic estimate (the search expands most of the area in between), and
+* unreachable pairs (the search exhausts the reachable area).
+*/
+static void CreateAdversarialQueries(const WorldFile& worldFile, FlowField& field, BenchRandom& random, int iCount, std::vector<BenchQuery>* queries)
+{
+    std::vector<std::pair<float, int> > detours;
+    std::vector<BenchQuery> candidates;
+    std::vector<BenchQuery> unreachable;
+
+    for(int i = 0; i < iCount * kAdversarialCandidates; ++i)
+    {
+        PathNodeKey nkStart = GetRandomOpenCell(worldFile, random);
+        PathNodeKey nkGoal = GetRandomOpenCell(worldFile, random);
+        BenchQuery query = CreateQuery(field, nkStart, nkGoal);
+
+        if( query.fOptimal < 0.0f )
+        {
+            unreachable.push_back(query);
+            continue;
+        }
+
+        // distance the search cannot see coming
+        float fEstimate = GetOctileDistance(nkStart, nkGoal);
+        detours.push_back(std::make_pair(-(query.fOptimal - fEstimate), (int)candidates.size()));
+        candidates.push_back(query);
+    }
+
+    // up to a quarter unreachable
+    int iUnreachable = std::min((int)unreachable.size(), iCount / 4);
+    queries->insert(queries->end(), unreachable.begin(), unreachable.begin() + iUnreachable);
+
+    // largest detours
+    std::sort(detours.begin(), detours.end());
+    for(int i = 0; i < (int)detours.size() && (int)queries->size() < iCount; ++i)
+    {
+        queries->push_back(candidates[detours[i].second]);
+    }
+}
+
+/**
+* Length of a waypoint list
+*/
+static float GetPathLength(const PathWaypointArray& waypointList)
+{
+    float fLength = 0.0f;
+    for(int i = 1; i < (int)waypointList.size(); ++i)
+    {
+        D3DXVECTOR2 vDist = waypointList[i] - waypointList[i - 1];
+        fLength += D3DXVec2Length(&vDist);
+    }
+    return fLength;
+}
+
+/**
+* Value at a fraction of sorted samples
+*/
+static double GetPercentile(const std::vector<double>& sorted, double fraction)
+{
+    if( sorted.empty() )
+        return 0.0;
+
+    int i = (int)(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+/**
+* Runs every query through the search pipeline (WorldData::CompleteRequest)
+* and writes the statistics.
+*/
+static void RunQueries(const char* szWorld, const char* szSet, const BenchConfig& config, PathSearch& search, const PathSearchOptions& baseOptions, const std::vector<BenchQuery>& queries)
+{
+    PathSearchOptions options = baseOptions;
+    options.bRubberband = config.bRubberband;
+    options.bAnyAngle = config.bAnyAngle;
+
+    std::vector<double> times;
+    times.reserve(queries.size());
+
+    long lExpanded = 0;
+    int iMaxExpanded = 0;
+    int iNoPath = 0;
+    int iMismatch = 0;
+    int iOptimalCount = 0;
+    double dOptimality = 0.0;
+    double dMaxOptimality = 0.0;
+
+    PathNodeList nodeList;
+    PathWaypointArray waypointList;
+
+    for(std::vector<BenchQuery>::const_iterator query = queries.begin(); query != queries.end(); ++query)
+    {
+        double dStart = GetSeconds();
+
+        search.Begin(query->nkStart, query->nkGoal, options);
+        while( search.Step(kStepExpansions) == PathSearch::kSearchInProgress );
+
+        waypointList.clear();
+        bool bFound = (search.GetResult() == PathSearch::kSearchComplete);
+        if( bFound )
+        {
+            search.GetPath(&nodeList);
+            for(PathNodeList::const_iterator node = nodeList.begin(); node != nodeList.end(); ++node)
+            {
+                waypointList.push_back(D3DXVECTOR2(node->iCol + 0.5f, node->iRow + 0.5f));
+            }
+
+            // smoothing is skipped for any-angle paths (as in the game)
+            if( config.bSmooth && !config.bAnyAngle )
+                SmoothWaypoints(&waypointList);
+        }
+
+        times.push_back((GetSeconds() - dStart) * 1e6);
+
+        int iExpanded = search.GetExpandedCount();
+        lExpanded += iExpanded;
+        iMaxExpanded = std::max(iMaxExpanded, iExpanded);
+
+        // result must agree with the reference distance
+        if( bFound != (query->fOptimal >= 0.0f) )
+            ++iMismatch;
+
+        if( !bFound )
+        {
+            ++iNoPath;
+            continue;
+        }
+
+        // length over the optimal grid path (any-angle and smoothed paths may be below 1)
+        if( query->fOptimal > 0.0f )
+        {
+            double dRatio = GetPathLength(waypointList) / query->fOptimal;
+            dOptimality += dRatio;
+            dMaxOptimality = std::max(dMaxOptimality, dRatio);
+            ++iOptimalCount;
+        }
+    }
+
+    double dTotal = 0.0;
+    for(std::vector<double>::const_iterator t = times.begin(); t != times.end(); ++t)
+        dTotal += *t;
+
+    std::sort(times.begin(), times.end());
+
+    int iCount = (int)queries.size();
+    printf("{\"type\":\"result\",\"world\":\"%s\",\"set\":\"%s\",\"config\":\"%s\","
+           "\"rubberband\":%s,\"smooth\":%s,\"any_angle\":%s,"
+           "\"queries\":%d,\"no_path\":%d,\"mismatches\":%d,"
+           "\"expanded_mean\":%.1f,\"expanded_max\":%d,"
+           "\"us_mean\":%.2f,\"us_p50\":%.2f,\"us_p95\":%.2f,\"us_max\":%.2f,"
+           "\"optimality_mean\":%.5f,\"optimality_max\":%.5f,\"peak_rss_kb\":%ld}\n",
+        szWorld, szSet, config.szName,
+        config.bRubberband ? "true" : "false", config.bSmooth ? "true" : "false", config.bAnyAngle ? "true" : "false",
+        iCount, iNoPath, iMismatch,
+        iCount ? (double)lExpanded / iCount : 0.0, iMaxExpanded,
+        iCount ? dTotal / iCount : 0.0, GetPercentile(times, 0.5), GetPercentile(times, 0.95), times.empty() ? 0.0 : times.back(),
+        iOptimalCount ? dOptimality / iOptimalCount : 0.0, dMaxOptimality, GetPeakMemory());
+}
+
+/**
+* Benchmarks one world file
+*/
+static bool RunWorld(const char* szWorld, unsigned int uSeed, int iQueries, bool bJumpPoint, bool bLandmarks)
+{
+    WCHAR wsWorld[ MAX_PATH ];
+    mbstowcs(wsWorld, szWorld, MAX_PATH);
+
+    WorldFile worldFile;
+    double dLoadStart = GetSeconds();
+    bool bLoaded = worldFile.Load(wsWorld);
+    double dLoadTime = (GetSeconds() - dLoadStart) * 1e3;
+
+    if( !bLoaded || worldFile.GetWidth() <= 0 || worldFile.GetHeight() <= 0 )
+    {
+        fprintf(stderr, "pathbench: cannot load %s\n", szWorld);
+        return false;
+    }
+
+    // reject worlds without open cells (no queries possible)
+    bool bOpen = false;
+    for(int row = 0; row < worldFile.GetHeight() && !bOpen; ++row)
+        for(int col = 0; col < worldFile.GetWidth() && !bOpen; ++col)
+            bOpen = (worldFile(row, col) != WorldFile::OCCUPIED_CELL);
+
+    if( !bOpen )
+    {
+        fprintf(stderr, "pathbench: no open cells in %s\n", szWorld);
+        return false;
+    }
+
+    // query sets (same seed, same queries)
+    BenchRandom random(uSeed);
+    FlowField field(worldFile);
+
+    std::vector<BenchQuery> randomQueries;
+    std::vector<BenchQuery> adversarialQueries;
+    CreateRandomQueries(worldFile, field, random, iQueries, &randomQueries);
+    CreateAdversarialQueries(worldFile, field, random, iQueries, &adversarialQueries);
+
+    // landmark tables (built once per world, as in the game)
+    PathLandmarks* pLandmarks = NULL;
+    double dLandmarkTime = 0.0;
+    if( bLandmarks )
+    {
+        double dStart = GetSeconds();
+        pLandmarks = new PathLandmarks(worldFile, kLandmarkCount);
+        pLandmarks->Build();
+        dLandmarkTime = (GetSeconds() - dStart) * 1e3;
+    }
+
+    printf("{\"type\":\"world\",\"world\":\"%s\",\"width\":%d,\"height\":%d,"
+           "\"load_ms\":%.2f,\"random_queries\":%d,\"adversarial_queries\":%d,\"landmark_ms\":%.2f}\n",
+        szWorld, worldFile.GetWidth(), worldFile.GetHeight(), dLoadTime,
+        (int)randomQueries.size(), (int)adversarialQueries.size(), dLandmarkTime);
+
+    PathSearchOptions options;
+    options.bHeuristicCalc = true;
+    options.fHeuristicWeight = kHeuristicWeight;
+    options.bJumpPoint = bJumpPoint;
+    options.bRubberband = false;
+    options.bAnyAngle = false;
+    options.pLandmarks = pLandmarks;
+
+    PathSearch search(worldFile);
+    for(int i = 0; i < kConfigCount; ++i)
+    {
+        RunQueries(szWorld, "random", kConfigs[i], search, options, randomQueries);
+        RunQueries(szWorld, "adversarial", kConfigs[i], search, options, adversarialQueries);
+    }
+
+    delete pLandmarks;
+    return true;
+}
+
+/**
+* Entry point
+*/
+int main(int argc, char** argv)
+{
+    unsigned int uSeed = 1;
+    int iQueries = 1000;
+    bool bJumpPoint = true;
+    bool bLandmarks = true;
+    bool bUsage = false;
+    std::vector<const char*> worlds;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if( strcmp(argv[i], "-seed") == 0 && i + 1 < argc )
+            uSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if( strcmp(argv[i], "-queries") == 0 && i + 1 < argc )
+            iQueries = atoi(argv[++i]);
+        else if( strcmp(argv[i], "-nojps") == 0 )
+            bJumpPoint = false;
+        else if( strcmp(argv[i], "-nolandmarks") == 0 )
+            bLandmarks = false;
+        else if( argv[i][0] == '-' )
+            bUsage = true;
+        else
+            worlds.push_back(argv[i]);
+    }
+
+    if( bUsage || worlds.empty() || iQueries <= 0 )
+    {
+        fprintf(stderr, "usage: pathbench [-seed N] [-queries N] [-nojps] [-nolandmarks] world ...\n");
+        return 2;
+    }
+
+    printf("{\"type\":\"run\",\"version\":1,\"seed\":%u,\"queries\":%d,\"jump_point\":%s,\"landmarks\":%s,\"heuristic_weight\":%.2f}\n",
+        uSeed, iQueries, bJumpPoint ? "true" : "false", bLandmarks ? "true" : "false", kHeuristicWeight);
+
+    int iFailed = 0;
+    for(std::vector<const char*>::const_iterator world = worlds.begin(); world != worlds.end(); ++world)
+    {
+        if( !RunWorld(*world, uSeed, iQueries, bJumpPoint, bLandmarks) )
+            ++iFailed;
+    }
+
+    return iFailed ? 1 : 0;
+}